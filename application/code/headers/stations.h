@@ -38,13 +38,13 @@ enum class Mode : const uint8_t{
 /// A cardbuffer has : 
 ///     spaces_occupied = amount of spaces occupied by a checked in card
 ///     checkinStation  = place where the perticulair card has checked in
-///     checkins        = UID's of the checked in chards
+///     checkins        = identities of the checked in cards, without the memory of the card
 ///     available       = array which indicates what index is free for a new card
 template<int n>
 struct cardBuffer{
     int spaces_occupied;
     std::array<Station, n> checkinStation;
-    std::array<card, n> checkins;
+    std::array<cardIdentity, n> checkins;
     std::array<bool, n> available;
 
     int getSize(){
@@ -41,12 +41,10 @@ ovTracker::ovTracker(
     // initialise the checkinInformation struct
     currentStation  = {Station()};
     checkinInformation.checkinStation = {Station()};
-    checkinInformation.checkins = {card()};
+    checkinInformation.checkins.fill(cardIdentity());
 
     // Set all spaces available
-    for(auto i: checkinInformation.available){
-        checkinInformation.available[i] = 1;
-    }
+    checkinInformation.available.fill(true);
     checkinInformation.spaces_occupied = 0;
 }
 
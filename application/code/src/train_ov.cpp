@@ -43,12 +43,15 @@ void train::init()
 }
 
 void train::waitCard(){
+    // only the identity and the balance of the card are used, the memory of the card is not stored
     auto cardinfo = card();
-    if(!nfc.detectCard(cardinfo, cardNumber, nfc::pn532::command::CardType::TypeA_ISO_IEC14443)){hwlib::cout << "."; return;}
-    auto carduid = cardinfo.getUID();
 
-    for(int i = 0; i < 10; i++){
-        if(checkinInformation.checkins[i].getUID() == carduid){
+    // the pn532 polls on its own and gives up after 300 ms, so the mode and station pins are read again
+    nfc::autoPollOptions options;
+    options.pollCount = 2;
+    if(!nfc.autoPoll(cardinfo, options)){hwlib::cout << "."; return;}
+    for(int i = 0; i < checkinInformation.getSize(); i++){
+        if(checkinInformation.checkins[i] == cardinfo.getIdentity()){
             checkOut(i);
             return;
         }
@@ -70,7 +73,7 @@ void train::checkIn( card& cardinfo ){
     for(int i = 0; i < checkinInformation.getSize(); i++){
         if(checkinInformation.available[i]){
             checkinInformation.checkinStation[i] = currentStation;
-            checkinInformation.checkins[i] = cardinfo;
+            checkinInformation.checkins[i] = cardinfo.getIdentity();
             checkinInformation.available[i] = false;
             checkinInformation.spaces_occupied++;
             break;
@@ -82,19 +85,25 @@ void train::checkIn( card& cardinfo ){
 
 void train::checkOut(const int index){
     auto price =  static_cast<uint32_t>(calculate_price(index));
-    nfc.mifareDecrement(checkinInformation.checkins[index], cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2], price);
-    if(nfc.mifareTransfer(checkinInformation.checkins[index], cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2])!= nfc::statusCode::pn532StatusOK){hwlib::cout << "error checking out"; return;};
+    uint32_t balance = 0;
+    auto cardinfo = card(checkinInformation.checkins[index]);
+    auto status = nfc.mifareValueTransaction(cardinfo, cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2], nfc::mifareCommands::Decrementation, price, balance);
+
+    // the price has been paid when the value has been transferred, also when only the answer of the transfer was lost
+    // or the value could not be read back. Else the card stays checked in: it holds its old balance or its balance is unknown
+    if(status == nfc::statusCode::pn532StatusValueNotRead){ balance = getBalance(cardinfo); }
+    else if(status != nfc::statusCode::pn532StatusOK){hwlib::cout << "error checking out"; return;}
 
     // check wether a card has moved stations
     if(checkinInformation.checkinStation[index].id == currentStation.id){ display << "\v\n\n\n" << "Cancelled";}
     else{display << "\v\n\n\n" << checkinInformation.checkinStation[index].naam << " - " << "\n" << currentStation.naam;}
 
     /// will check the saldo of the card
-    display << "\v\n\n\n\n\n" << hwlib::dec << "price: " << static_cast<int>(price) << "\n" << "Checked out" << "\n" <<  "Balance:" <<  static_cast<int>(getBalance(checkinInformation.checkins[index])) << hwlib::flush;
+    display << "\v\n\n\n\n\n" << hwlib::dec << "price: " << static_cast<int>(price) << "\n" << "Checked out" << "\n" <<  "Balance:" <<  static_cast<int>(balance) << hwlib::flush;
    
     // remove card and data from the specific index it was stored 
     checkinInformation.checkinStation[index] = Station();
-    checkinInformation.checkins[index]       = card();
+    checkinInformation.checkins[index]       = cardIdentity();
     checkinInformation.available[index]      = true;
     checkinInformation.spaces_occupied--;
 
@@ -184,14 +193,9 @@ bool train::validateCard(card & cardinfo){
 
 
 uint32_t train::getBalance(card & cardinfo){
-    // Gets remaining balance
-    nfc.mifareAuthenticate(cardinfo, cardNumber, authenticateAorB, sectorLocation, keys.aKeys[2]);
-    nfc.mifareReadPage(cardinfo, cardNumber, valueBlockLocation);
-
-    auto valueBlock = cardinfo.getPage(valueBlockLocation);
-
-    // rearrange the bytes. Bytes are stored in least signigicant byte first
-    uint32_t saldo = (valueBlock[0]) | (valueBlock[1] << 8) | (valueBlock[2] << 16) | (valueBlock[3] << 24);
+    // Gets remaining balance, the value is also stored in the identity of the card
+    uint32_t saldo = 0;
+    nfc.mifareReadValue(cardinfo, cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2], saldo);
     if(saldo > maxCardBalance){ saldo = saldo - 0xFFFFFFFF;};  // if the uint32_t has flipped around because of a negative saldo, it will be restored here
 
     return saldo;
@@ -213,10 +217,10 @@ void train::topUp(uint32_t increment_value){
                                                                                 // only the difference from current balance to max balance is stored
 
 
-    nfc.mifareIncrement(cardinfo, cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2], static_cast<uint32_t>(increment_value));
-    if(nfc.mifareTransfer(cardinfo, cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2])!= nfc::statusCode::pn532StatusOK){hwlib::cout << "error incrementing"; return;};
+    auto status = nfc.mifareValueTransaction(cardinfo, cardNumber, authenticateAorB, valueBlockLocation, sectorLocation, keys.aKeys[2], nfc::mifareCommands::Incrementation, static_cast<uint32_t>(increment_value), balance);
+    if(status == nfc::statusCode::pn532StatusValueNotRead){ balance = getBalance(cardinfo); }
+    else if(status != nfc::statusCode::pn532StatusOK){hwlib::cout << "error incrementing"; return;}
 
-    balance = getBalance(cardinfo);
     display << "\n\n" << "new balance:" << hwlib::dec << balance << hwlib::flush;     // Display new balance on oled and flush the screen
     
 
@@ -58,7 +58,7 @@ int main() {
 
     // construct communication busses
     auto i2cbus = hwlib::i2c_bus_bit_banged_scl_sda(scl, sda);
-    auto spiBus  = hwlib::spi_bus_bit_banged_sclk_mosi_miso(clock, mosi, miso);
+    auto spiBus  = hwlib::spi_bus_bit_banged_sclk_mosi_miso_static<target::pin_out, target::pin_out, target::pin_in>(clock, mosi, miso);
     auto uartbus = hwuart::HardwareUart(baudrate);
     
     /// Construct Busses
@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief     Binary dump format of a Mifare Classic card
+ *
+ * A dump record holds the memory of a card and what is known about it, so dumps can be archived and compared later.
+ * A record has a fixed size for every geometry: the memory of the card, followed by a footer of 72 bytes.
+ *
+ *      offset          size    content
+ *      0               n       the blocks of the card in order, n = 320, 1024 or 4096. Blocks that have not been read are 0
+ *      n + 0           4       'M', 'C', 'D', 'R'
+ *      n + 4           1       version of the format, 1
+ *      n + 5           1       amount of sectors (geometry)
+ *      n + 6           1       length of the UID
+ *      n + 7           1       SAK
+ *      n + 8           2       ATQA, as send by the card
+ *      n + 10          2       reserved, 0
+ *      n + 12          10      UID, the bytes after its length are 0
+ *      n + 22          2       reserved, 0
+ *      n + 24          32      one bit per block that tells whether the block has been read, bit 0 of byte 0 is block 0
+ *      n + 56          8       time the card has been read, seconds since 1970, little endian
+ *      n + 64          8       time the dump has been made, seconds since 1970, little endian
+ *
+ * The blocks come first, in the order of the card, which is the layout of a .mfd file. So the first 1024 bytes of the record
+ * of a 1k card are a .mfd dump. The geometry of a record is found from its size: the footer must be at the end.
+ *
+ * Dumps are archived as a file of records of the same geometry, after a file header of 8 bytes:
+ *
+ *      offset          size    content
+ *      0               4       'M', 'C', 'D', 'F'
+ *      4               1       version of the file format, 1
+ *      5               1       amount of sectors (geometry) of all records
+ *      6               2       reserved, 0
+ *
+ * The geometry of the records is only taken from the header, never from the records, so the contents of a card can not
+ * change how a file is read. A file that ends with a part of a record still holds all records before it, so one
+ * interrupted write does not lose the archive. The records are read in place, without copies: a dumpRecord only points
+ * to the bytes of its record. See cardDumpFile.h for the files on a host.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_CARDDUMP_H
+#define V1_OOPC_18_NATHANHOUWAART_CARDDUMP_H
+
+#include "mifareClassic.h"
+
+/// \brief
+/// Constants of the dump format
+struct dumpFormat{
+    static constexpr uint8_t magic[4]       = {'M', 'C', 'D', 'R'};
+    static constexpr uint8_t version        = 0x01;
+    static constexpr size_t  footerSize     = 72;
+    static constexpr size_t  bitmapSize     = 32;       // bytes, enough for the 256 blocks of a 4k
+
+    static constexpr uint8_t fileMagic[4]   = {'M', 'C', 'D', 'F'};
+    static constexpr uint8_t fileVersion    = 0x01;
+    static constexpr size_t  fileHeaderSize = 8;
+
+    /// \brief
+    /// Returns the size of a record of a card with the given geometry
+    static constexpr size_t recordSize(const cardGeometry& geometry){ return geometry.size() + footerSize; }
+};
+
+static_assert(dumpFormat::recordSize(mifare1kGeometry) == 1096 && dumpFormat::bitmapSize * 8 >= mifare4kGeometry.blocks());
+
+/// \brief
+/// View on a dump record
+/// \details
+/// The record is not copied, the bytes have to stay valid as long as the dumpRecord is used
+class dumpRecord
+{
+private:
+    const uint8_t  *record;
+    cardGeometry    layout;
+
+    const uint8_t* footer() const { return record + layout.size(); }
+
+public:
+    /// \brief
+    /// Constructor of the dumpRecord class
+    /// \details
+    /// @param  record      The first byte of the record
+    /// @param  layout      Geometry of the record, see dumpGeometry()
+    dumpRecord(const uint8_t *record, const cardGeometry &layout): record(record), layout(layout){}
+
+    /// \brief
+    /// Returns whether the footer of the record is valid and has the geometry of the record
+    bool valid() const;
+
+    /// \brief
+    /// Returns the geometry of the record
+    const cardGeometry& geometry() const { return layout; }
+
+    /// \brief
+    /// Returns the blocks of the card in order, the .mfd layout
+    const uint8_t* data() const { return record; }
+
+    /// \brief
+    /// Returns whether a block has been read from the card
+    bool hasBlock(uint16_t page) const;
+
+    /// \brief
+    /// Returns the 16 bytes of a block in the record
+    /// @return const uint8_t*  Pointer into the record, nullptr when the block has not been read
+    const uint8_t* block(uint16_t page) const;
+
+    /// \brief
+    /// Returns the UID, ATQA and SAK of the card, no value is known
+    cardIdentity identity() const;
+
+    /// \brief
+    /// Returns the time the card has been read, in seconds since 1970
+    uint64_t readTime() const;
+
+    /// \brief
+    /// Returns the time the dump has been made, in seconds since 1970
+    uint64_t dumpTime() const;
+};
+
+/// \brief
+/// Writes the record of a card
+/// \details
+/// The pages the card has not read are written as 0 and are not marked in the bitmap.
+/// @param  cardinfo    Card with memory, like mifare1k
+/// @param  readTime    Time the card has been read, in seconds since 1970
+/// @param  dumpTime    Time the dump is made, in seconds since 1970
+/// @param  out         Buffer the record is written in
+/// @param  capacity    Size of the buffer in bytes
+/// @return size_t      Size of the record, 0 when the card has no memory or the buffer is too small
+size_t writeDump(const card &cardinfo, uint64_t readTime, uint64_t dumpTime, uint8_t *out, size_t capacity);
+
+/// \brief
+/// Returns whether the footer of a record is valid and has the given geometry
+/// @param  footer      The first byte of the footer, dumpFormat::footerSize bytes
+bool validFooter(const uint8_t *footer, const cardGeometry &geometry);
+
+/// \brief
+/// Returns the geometry of one record
+/// \details
+/// The size has to be the record size of a geometry, and the record has to end with a valid footer of that geometry
+/// @return cardGeometry    mifareMiniGeometry, mifare1kGeometry, mifare4kGeometry or noMemory when no geometry fits
+const cardGeometry& dumpGeometry(const uint8_t *record, size_t size);
+
+/// \brief
+/// Writes the header of a file of records
+/// @param  geometry    Geometry of the records in the file
+/// @param  out         Buffer of dumpFormat::fileHeaderSize bytes
+void writeFileHeader(const cardGeometry &geometry, uint8_t *out);
+
+/// \brief
+/// Returns the geometry of the records of a file
+/// @param  header      The first byte of the file, dumpFormat::fileHeaderSize bytes
+/// @return cardGeometry    mifareMiniGeometry, mifare1kGeometry, mifare4kGeometry or noMemory when the header is not valid
+const cardGeometry& fileGeometry(const uint8_t *header);
+
+#endif // V1_OOPC_18_NATHANHOUWAART_CARDDUMP_H
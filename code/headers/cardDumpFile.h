@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief     Files of card dumps on a Linux host
+ *
+ * dumpWriter appends the dump records of cards to a file, dumpFile maps a file of records into memory.
+ * The records are not read or copied: a dumpRecord points into the mapping and the kernel only loads the pages
+ * that are touched. So a scan over millions of dumps that looks at a few blocks only reads those pages from disk.
+ *
+ * All records of a file have the geometry of the file header, a writer refuses a card of another geometry.
+ * See cardDump.h for the format of a record.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_CARDDUMPFILE_H
+#define V1_OOPC_18_NATHANHOUWAART_CARDDUMPFILE_H
+
+#include "cardDump.h"
+
+/// \brief
+/// Appends dump records to a file
+class dumpWriter
+{
+private:
+    int             fd = -1;
+    cardGeometry    layout = noMemory;     // geometry of the records in the file, noMemory while the file is empty
+
+public:
+    /// \brief
+    /// Constructor of the dumpWriter class
+    /// \details
+    /// Opens the file, or creates it. An existing file has to start with a file header, see valid().
+    /// A part of a record at the end of the file, left by an interrupted write, is removed
+    /// @param  path    Path of the file
+    dumpWriter(const char *path);
+
+    /// \brief
+    /// Closes the file
+    ~dumpWriter();
+
+    dumpWriter(const dumpWriter&) = delete;
+    dumpWriter& operator=(const dumpWriter&) = delete;
+
+    /// \brief
+    /// Returns whether the file is open and holds only whole records
+    bool valid() const { return fd >= 0; }
+
+    /// \brief
+    /// Appends the dump of a card to the file
+    /// @param  cardinfo    Card with memory, of the same geometry as the records in the file
+    /// @param  readTime    Time the card has been read, in seconds since 1970
+    /// @param  dumpTime    Time the dump is made, in seconds since 1970
+    /// @return bool        Whether the record has been written. When the write fails, the file is cut back to its old size,
+    ///                     or the writer is no longer valid() when that fails too
+    bool append(const card &cardinfo, uint64_t readTime, uint64_t dumpTime);
+};
+
+/// \brief
+/// File of dump records, mapped into memory
+class dumpFile
+{
+private:
+    int             fd = -1;
+    const uint8_t  *base = nullptr;
+    size_t          size = 0;
+    cardGeometry    layout = noMemory;
+
+public:
+    /// \brief
+    /// Constructor of the dumpFile class
+    /// \details
+    /// Maps the file read only. The kernel is told that the file is read in order
+    /// @param  path    Path of the file
+    dumpFile(const char *path);
+
+    /// \brief
+    /// Unmaps and closes the file
+    ~dumpFile();
+
+    dumpFile(const dumpFile&) = delete;
+    dumpFile& operator=(const dumpFile&) = delete;
+
+    /// \brief
+    /// Returns whether the file is mapped and starts with a valid file header
+    bool valid() const { return base != nullptr && layout.sectors != 0; }
+
+    /// \brief
+    /// Returns the geometry of the records
+    const cardGeometry& geometry() const { return layout; }
+
+    /// \brief
+    /// Returns the amount of whole records in the file, a part of a record at the end is not counted
+    size_t count() const { return valid() ? (size - dumpFormat::fileHeaderSize) / dumpFormat::recordSize(layout) : 0; }
+
+    /// \brief
+    /// Returns a record of the file, index has to be smaller than count()
+    dumpRecord operator[](size_t index) const { return dumpRecord(base + dumpFormat::fileHeaderSize + index * dumpFormat::recordSize(layout), layout); }
+};
+
+#endif // V1_OOPC_18_NATHANHOUWAART_CARDDUMPFILE_H
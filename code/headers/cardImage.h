@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief     Card image that reads its blocks from the card on first access
+ *
+ * A mifareClassicCard only holds what has been read into it: getPage() of a block that has not been read gives 0's.
+ * cardImage couples a card to a reader and its keys. When a block is asked for that has not been read yet, the sector
+ * is authenticated (only when it is not authenticated with the key already) and the block is read. After that
+ * the block is taken from the memory of the card, without any command to the reader.
+ *
+ * So a program only pays for the blocks it really uses, and a partial dump is as cheap as the blocks in it.
+ *
+ * Blocks can be changed in the image with setPage(). commit() writes the changed blocks to the card, sector by sector, so
+ * every sector is authenticated once. Every block is read back after the write to verify it. The sector trailer is
+ * written after the data blocks of its sector, because new keys or access bits can make the other blocks unreachable.
+ *
+ * Nothing is printed, errors are returned as statusCode.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_CARDIMAGE_H
+#define V1_OOPC_18_NATHANHOUWAART_CARDIMAGE_H
+
+#include "nfc.h"
+
+namespace nfc{
+
+/// \brief
+/// Read-through image of a Mifare Classic card
+/// \details
+/// The card has to be selected by the reader (detectCard, autoPoll, ...) before its blocks are accessed.
+/// A Mifare error halts the card, it has to be selected again before the next block can be read.
+class cardImage
+{
+public:
+    using block = std::array<uint8_t, cardGeometry::blockSize>;
+
+    /// \brief
+    /// Counters of the image
+    struct statistics{
+        uint_fast32_t hits      = 0;    // accesses to blocks that had been read already
+        uint_fast32_t reads     = 0;    // blocks that have been read from the card
+        uint_fast32_t writes    = 0;    // blocks that have been written to the card and verified
+    };
+
+    statistics stats;
+
+    /// \brief
+    /// Constructor of the cardImage class
+    /// \details
+    /// @param  reader      The reader the card is in the RF field of
+    /// @param  cardinfo    The card the blocks are stored in, a card with memory like mifare1k
+    /// @param  keys        The keys of the sectors of the card
+    /// @param  keyType     Whether the sectors are authenticated with key A or key B
+    cardImage(NFC &reader, card &cardinfo, const cardKeys &keys, const mifareCommands keyType = mifareCommands::authenticateKeyA);
+
+    /// \brief
+    /// Makes sure a block has been read from the card
+    /// @param  page        Block of the card
+    /// @return statusCode  pn532StatusOK when the block is in the image, pn532StatusInvalidParameter for a block outside the geometry,
+    ///                     else the error of the authentication or the read
+    statusCode load(const uint16_t page);
+
+    /// \brief
+    /// Makes sure all blocks of a sector have been read, with one authentication
+    /// @return statusCode  Status of the first block that could not be read
+    statusCode loadSector(const uint8_t sector);
+
+    /// \brief
+    /// Returns the content of a block, it is read from the card the first time
+    /// @param  page        Block of the card
+    /// @param  data        The 16 bytes of the block, 0's when the block could not be read
+    /// @return statusCode  Status of load()
+    statusCode getPage(const uint16_t page, block &data);
+
+    /// \brief
+    /// Changes a block in the image, the card is only written by commit()
+    /// \details
+    /// A block that has been read and gets the same content again is not marked as changed
+    /// @param  page        Block of the card
+    /// @param  data        The 16 new bytes of the block
+    /// @return statusCode  pn532StatusOK, pn532StatusInvalidParameter for block 0 (the manufacturer block can not be written)
+    ///                     or a block outside the geometry
+    statusCode setPage(const uint16_t page, const block &data);
+
+    /// \brief
+    /// Writes all changed blocks to the card and reads them back
+    /// \details
+    /// The sectors are written in order, every sector is authenticated once. Of a sector trailer only the access bits are
+    /// verified, the keys can not be read back. After a new trailer, the keys of the image have to be changed by the caller.
+    /// @return statusCode  pn532StatusOK when all blocks have been written, else the status of the first block that failed.
+    ///                     pn532StatusVerifyError when a block reads back different, it stays changed in the image
+    statusCode commit();
+
+    /// \brief
+    /// Writes the changed blocks of one sector to the card and reads them back
+    /// @return statusCode  Status of the first block that failed
+    statusCode commitSector(const uint8_t sector);
+
+    /// \brief
+    /// Returns the card the blocks are stored in
+    card& getCard(){ return cardinfo; }
+
+    /// \brief
+    /// Forgets all blocks, the next accesses read them from the card again
+    void clear(){ cardinfo.clearPages(); }
+
+private:
+    NFC                    &reader;
+    card                   &cardinfo;
+    const cardKeys         &keys;
+    const mifareCommands    keyType;
+
+    /// \brief
+    /// Returns the key of keyType of a sector
+    const uint8_t* sectorKey(const uint8_t sector) const;
+
+    /// \brief
+    /// Writes one changed block and verifies it
+    statusCode writePage(const uint16_t page);
+};
+
+} // namespace nfc
+
+#endif // V1_OOPC_18_NATHANHOUWAART_CARDIMAGE_H
@@ -42,6 +42,12 @@ enum baudRate : const uint8_t{
     _1m2kBaud  = 0x08
 };
 
+/// Returns the baudrate in bits per second of a baudRate
+constexpr uint32_t baudRateValue(const baudRate br){
+    constexpr uint32_t rates[] = {9'600, 19'200, 38'400, 57'600, 115'200, 230'400, 460'800, 921'600, 1'288'000};
+    return (br < sizeof(rates) / sizeof(rates[0])) ? rates[br] : 0;
+}
+
 
 /// Specific statuscodes the nfc chips can return
 enum statusCode : const uint8_t{
@@ -68,54 +74,34 @@ enum statusCode : const uint8_t{
     pn532StatusReleased                 = 0x27,
     pn532StatusOverCurrent              = 0x2D,
     pn532StatusMissingDEP               = 0x2E,
-    pn532statusSAMerror                 = 0x2F
+    pn532statusSAMerror                 = 0x2F,
+    pn532StatusBusy                     = 0x30,     // host side: an asynchronous command is still in progress
+    pn532StatusCancelled                = 0x31,     // host side: the command has been aborted with cancel()
+    pn532StatusNotRead                  = 0x32,     // host side: the sector has not been read (not requested or aborted)
+    pn532StatusInvalidValueBlock        = 0x33,     // host side: the block does not hold a valid value block
+    pn532StatusBaudrateFallback         = 0x34,     // host side: the new serial baudrate did not work, the old one is used again
+    pn532StatusChecksumError            = 0x35,     // host side: the response kept arriving with a wrong LCS or DCS, also after a NACK
+    pn532StatusVerifyError              = 0x36,     // host side: a block that has been read back differs from what has been written
+    pn532StatusValueRestored            = 0x37,     // host side: the transfer failed, the valueblock still holds its old value
+    pn532StatusRestoreFailed            = 0x38,     // host side: the transfer failed and could not be undone, the valueblock is unknown
+    pn532StatusValueNotRead             = 0x39,     // host side: the value has been transferred, but could not be read back
+    pn532StatusOtherCard                = 0x3A      // host side: the card that has been selected again is not the expected card
 };
 
-/// A struct containing all 32 keys of a mifare classic 1k. Can be altered based on own card setting
-struct cardKeys{ 
-        uint8_t page1A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page1B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page2A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page2B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page3A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page3B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page4A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page4B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page5A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page5B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page6A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page6B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page7A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page7B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page8A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page8B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page9A[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page9B[6]  = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page10A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page10B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page11A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page11B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page12A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page12B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page13A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page13B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page14A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page14B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page15A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page15B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page16A[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-        uint8_t page16B[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
-
-        std::array<uint8_t*, 16> aKeys = {
-                page1A, page2A, page3A, page4A, page5A,
-                page6A, page7A, page8A, page9A,page10A,
-                page11A, page12A, page13A, page14A, page15A, 
-                page16A};
-        std::array<uint8_t*, 16> bKeys = {
-                page1B, page2B, page3B, page4B, page5B, 
-                page6B, page7B, page8B, page9B, page10B, 
-                page11B, page12B, page13B, page14B, page15B, 
-                page16B};
+/// A struct containing the A and B keys of every sector. Can be altered based on own card setting
+/// \details
+/// There are keys for the 40 sectors of a Mifare Classic 4k, a 1k only uses the first 16 and a Mini the first 5.
+/// aKeys[n] and bKeys[n] are the keys of sector n. All keys start as the transport key 0xFF.
+struct cardKeys{
+        static const uint8_t sectors = 40;
+
+        uint8_t aKeys[sectors][6];
+        uint8_t bKeys[sectors][6];
+
+        cardKeys(){
+            for(auto& key : aKeys){ for(auto& byte : key){ byte = 0xFF; } }
+            for(auto& key : bKeys){ for(auto& byte : key){ byte = 0xFF; } }
+        }
 };
 
 namespace pn532{
@@ -123,8 +109,11 @@ namespace pn532{
     namespace general{
         const uint8_t Pn532Address          = 0x48 >> 1;
         const uint8_t bufferSize            = 64;
-        static constexpr uint8_t Ack_buffer_template_i2c[7] = { 0x01, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};  // When using i2c, the received ack frame will be one byte longer
-        static constexpr uint8_t Ack_buffer_template_spi[6] = { 0x00, 0x00, 0xFF,0x00, 0xFF, 0x00};
+        const uint16_t maxFrameLength       = 265;                  // LEN of an extended information frame: TFI + 264 data bytes. User manual p.29
+        const uint16_t frameBufferSize      = maxFrameLength + 4;   // LEN, LCS, TFI + data, DCS and postamble
+        const uint16_t commandBufferSize    = maxFrameLength + 8;   // start code, 0xFF 0xFF, LENM, LENL, LCS, TFI + data and DCS
+        static constexpr uint8_t Ack_buffer_template[6] = { 0x00, 0x00, 0xFF,0x00, 0xFF, 0x00};
+        static constexpr uint8_t Nack_buffer_template[6] = { 0x00, 0x00, 0xFF,0xFF, 0x00, 0x00};  // asks the pn532 to send its last response again
         const uint8_t Preamble1             = 0x00;
         const uint8_t Preamble2             = 0xFF;
         const uint8_t HostToPn532           = 0xD4;
@@ -134,6 +123,7 @@ namespace pn532{
         const uint16_t Mifare1kSize         = 1024;
         const uint8_t Mifare1kPageSize      = 16;
         const uint8_t Mifare1kUIDsize       = 4;
+        const uint8_t MifareMaxUIDsize      = 10;   // triple size UID
         
     }
     
@@ -166,6 +156,17 @@ namespace pn532{
         };
         const uint8_t setSerialBaudrate     = 0x10;
         const uint8_t SAMConfiguration      = 0x14;
+        const uint8_t PowerDown             = 0x16;
+
+        /// Sources that can wake the pn532 from power down, combine them with |. User manual p.98
+        namespace wakeUpSource {
+            const uint8_t INT0                  = 0x01;
+            const uint8_t INT1                  = 0x02;
+            const uint8_t RFLevelDetector       = 0x08;
+            const uint8_t HSU                   = 0x10;
+            const uint8_t SPI                   = 0x20;
+            const uint8_t I2C                   = 0x80;
+        }
         
         /// Different SAM mode configurations. User manual p.89 - p.97
         namespace SAMmode {
@@ -195,6 +196,27 @@ namespace pn532{
         };
 
         const uint8_t InDataExchange        = 0x40;
+        const uint8_t InDeselect            = 0x44;
+        const uint8_t InRelease             = 0x52;
+        const uint8_t InSelect              = 0x54;
+        const uint8_t InAutoPoll            = 0x60;
+
+        /// Target types and settings of InAutoPoll. User manual p.144 - p.146
+        namespace autoPoll {
+            const uint8_t pollForever           = 0xFF;     // PollNr: poll until a target has been found
+            const uint8_t maxTypes              = 15;
+
+            const uint8_t GenericPassive106kbps = 0x00;     // ISO/IEC14443-4A, Mifare and DEP
+            const uint8_t GenericPassive212kbps = 0x01;
+            const uint8_t GenericPassive424kbps = 0x02;
+            const uint8_t Passive106kbpsTypeB   = 0x03;
+            const uint8_t InnovisionJewel       = 0x04;
+            const uint8_t Mifare                = 0x10;
+            const uint8_t FeliCa212kbps         = 0x11;
+            const uint8_t FeliCa424kbps         = 0x12;
+            const uint8_t Passive106kbpsTypeA4  = 0x20;
+            const uint8_t Passive106kbpsTypeB4  = 0x23;
+        }
     } // namespace command
 
 } // namespace pn532
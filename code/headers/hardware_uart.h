@@ -18,93 +18,238 @@
 #include "hwlib.hpp"
 #include "../../hwlib/library/hwlib.hpp"
 
+#include <atomic>
+
 namespace hwuart
 {
 
 
+/// \brief
+/// Contiguous part of a ringbuffer
+/// \details
+/// A bulk push or pop is done on at most two spans, one before and one after the wrap around
+struct span{
+    uint8_t    *data;
+    size_t      length;
+};
+
 /// \brief
 /// This is a ringbuffer class that is supposed to store the received data from the UART bus
 /// \details
-/// This buffer is templated and can be decided at compile time. It is reccomended to make the buffer no larger than 255 bytes for speed purposes
+/// The buffer is a lock-free single-producer / single-consumer fifo: one side (for example the rx interrupt)
+/// may push while the other side (the main loop) pops, without disabling interrupts. Only the producer writes
+/// head and only the consumer writes tail; both count freely and are masked with n - 1, so n must be a power of two.
+///
+/// When the buffer is full, new bytes are dropped (the bytes already in the buffer are kept). The dropped bytes
+/// and the amount of times the buffer ran full (overruns) are counted.
 template<size_t n>
 class buffer{
 private:
-    unsigned int begin;
-    unsigned int end;
-    unsigned int count;
+    static_assert(n >= 2 && (n & (n - 1)) == 0, "the size of the buffer must be a power of two");
+    static const size_t mask = n - 1;
+
+    std::atomic<size_t> head{0};            // written by the producer
+    std::atomic<size_t> tail{0};            // written by the consumer
+
+    // producer side counters
+    uint_fast32_t drops = 0;
+    uint_fast32_t overrunCount = 0;
+    bool          dropping = false;
 
     uint8_t fifo[n];
 
+    void drop(const size_t amount){
+        if(amount == 0){ dropping = false; return; }
+        if(!dropping){ overrunCount++; }
+        dropping = true;
+        drops += amount;
+    }
+
 public:
     /// \brief
     /// Default construcctor for the buffer. The buffer will initially be empty when created.
-    buffer(){
-        begin= 0;
-        end = 0;
-        count = 0;
-    }
+    buffer() = default;
 
     /// \brief
     /// Returns the begin index of the buffer
     int returnBegin()
     {
-        return begin;
+        return tail.load(std::memory_order_relaxed) & mask;
     }
 
     /// \brief
     /// Returns the end index of the buffer
     int returnEnd()
     {
-        return end;
+        return head.load(std::memory_order_relaxed) & mask;
     }
 
     /// \brief
-    /// Returns the size of the buffer
+    /// Returns the amount of bytes in the buffer
     int returnSize(){
-        return count;
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
     }
 
+    /// \brief
+    /// Returns the amount of bytes that have been dropped because the buffer was full
+    uint_fast32_t dropped() const { return drops; }
+
+    /// \brief
+    /// Returns how many times the buffer has run full
+    uint_fast32_t overruns() const { return overrunCount; }
+
+    // ---- producer ---- //
+
     /// \brief
     /// Pushes back a character at the back of the buffer
     /// \details
-    /// If the buffer has reached the end index of the buffer,
-    /// it will wrap around and start at index 0 again. This
-    /// will possibly overwrite the characters already there
-    void push_back(const uint8_t c){
-        if(end <= n){
-            // stay within buffer boundaries
-            fifo[end] = c;
-            end++;
-            count++;
+    /// When the buffer is full the character is dropped
+    /// @return bool    False when the character has been dropped
+    bool push_back(const uint8_t c){
+        const size_t h = head.load(std::memory_order_relaxed);
+        if(h - tail.load(std::memory_order_acquire) == n){
+            drop(1);
+            return false;
         }
-        if(end >= n){
-            end = 0;
+        fifo[h & mask] = c;
+        head.store(h + 1, std::memory_order_release);
+        dropping = false;
+        return true;
+    }
+
+    /// \brief
+    /// Returns the free space after head that can be written at once
+    /// \details
+    /// Write the bytes in the span and call commit() to hand them over to the consumer
+    span writable(){
+        const size_t h = head.load(std::memory_order_relaxed);
+        const size_t space = n - (h - tail.load(std::memory_order_acquire));
+        const size_t contiguous = n - (h & mask);
+        return span{&fifo[h & mask], space < contiguous ? space : contiguous};
+    }
+
+    /// \brief
+    /// Hands the first amount bytes of the last writable() span over to the consumer
+    void commit(const size_t amount){
+        head.store(head.load(std::memory_order_relaxed) + amount, std::memory_order_release);
+    }
+
+    /// \brief
+    /// Pushes up to nBytes at once
+    /// \details
+    /// The bytes that do not fit are dropped
+    /// @return size_t  Amount of bytes that have been pushed
+    size_t push(const uint8_t *data, const size_t nBytes){
+        size_t pushed = 0;
+        for(uint8_t part = 0; part < 2 && pushed < nBytes; part++){
+            const auto free = writable();
+            const size_t amount = (nBytes - pushed < free.length) ? nBytes - pushed : free.length;
+            for(size_t i = 0; i < amount; i++){ free.data[i] = data[pushed + i]; }
+            commit(amount);
+            pushed += amount;
         }
+        drop(nBytes - pushed);
+        return pushed;
     }
 
+    // ---- consumer ---- //
+
     /// \brief
     /// Gets the first element of the buffer and removes it.
     /// \details
-    /// If the buffer has reached the end index of the buffer,
-    /// it will wrap around and start at index 0 again and start
-    /// popping characters form there
+    /// Returns 0 when the buffer is empty
     uint8_t pop(){
-        if ( count <= 0) return 0;
-        else{
-            uint8_t retVal = fifo[begin];
-            begin++;
-            count--;
-            if(begin > n){
-                begin = 0;
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if(head.load(std::memory_order_acquire) == t){ return 0; }
+        const uint8_t retVal = fifo[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return retVal;
+    }
+
+    /// \brief
+    /// Returns the byte at the given offset from the begin, without removing it
+    /// \details
+    /// The offset must be smaller than returnSize()
+    uint8_t peek(const size_t offset) const {
+        return fifo[(tail.load(std::memory_order_relaxed) + offset) & mask];
+    }
+
+    /// \brief
+    /// Returns the bytes after tail that can be read at once
+    /// \details
+    /// Read the bytes in the span and call consume() to free them for the producer
+    span readable(){
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t used = head.load(std::memory_order_acquire) - t;
+        const size_t contiguous = n - (t & mask);
+        return span{&fifo[t & mask], used < contiguous ? used : contiguous};
+    }
+
+    /// \brief
+    /// Removes amount bytes from the begin of the buffer
+    void consume(const size_t amount){
+        tail.store(tail.load(std::memory_order_relaxed) + amount, std::memory_order_release);
+    }
+
+    /// \brief
+    /// Pops up to nBytes at once
+    /// @return size_t  Amount of bytes that have been popped
+    size_t pop(uint8_t *data, const size_t nBytes){
+        size_t popped = 0;
+        for(uint8_t part = 0; part < 2 && popped < nBytes; part++){
+            const auto used = readable();
+            const size_t amount = (nBytes - popped < used.length) ? nBytes - popped : used.length;
+            for(size_t i = 0; i < amount; i++){ data[popped + i] = used.data[i]; }
+            consume(amount);
+            popped += amount;
+        }
+        return popped;
+    }
+
+    /// \brief
+    /// Pops exactly one pn532 frame
+    /// \details
+    /// Bytes before the start code (0x00 0xFF), like the preamble, the postamble of the previous frame
+    /// or noise, are removed. The frame is copied from its start code up to and including its DCS
+    /// (ACK and NACK frames up to their LCS). When no complete frame is in the buffer yet, the
+    /// bytes are left in the buffer and 0 is returned. A frame with a wrong length checksum
+    /// or a frame that does not fit in maxLength is removed and skipped.
+    /// @param  frame       Buffer for the frame
+    /// @param  maxLength   Size of the frame buffer
+    /// @return size_t      Length of the frame, 0 when there is no complete frame
+    size_t popFrame(uint8_t *frame, const size_t maxLength){
+        while(true){
+            // find the start code
+            size_t used = returnSize();
+            while(used >= 2 && !(peek(0) == 0x00 && peek(1) == 0xFF)){ consume(1); used--; }
+            if(used < 4){ return 0; }
+
+            const uint8_t len = peek(2);
+            const uint8_t lcs = peek(3);
+            size_t length = 4;
+            if((len == 0x00 && lcs == 0xFF) || (len == 0xFF && lcs == 0x00)){
+                length = 4;
+            }else if(len == 0xFF && lcs == 0xFF){
+                // extended frame: LENM, LENL and LCS follow
+                if(used < 7){ return 0; }
+                if(static_cast<uint8_t>(peek(4) + peek(5) + peek(6)) != 0x00){ consume(2); continue; }
+                length = 7 + ((peek(4) << 8) | peek(5)) + 1;
+            }else{
+                if(static_cast<uint8_t>(len + lcs) != 0x00){ consume(2); continue; }
+                length = 4 + len + 1;
             }
-            return retVal;
+
+            if(length > maxLength || length > n){ consume(2); continue; }
+            if(used < length){ return 0; }
+            return pop(frame, length);
         }
     }
 
     /// reset the buffer
+    /// \details
+    /// Must be called by the consumer
     void clear(){
-        begin = end;
-        count = 0;
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
     }
 };
 
@@ -147,18 +292,79 @@ public:
     /// \brief
     /// Get a character from the ringbuffer    
     virtual uint8_t getC() = 0;
+
+    /// \brief
+    /// Changes the baudrate of the UART bus
+    /// \details
+    /// Bytes that are still being send are send at the old baudrate first.
+    /// The default implementation does not support changing the baudrate
+    /// @param  baudrate    The new baudrate in bits per second
+    /// @return bool        False when the baudrate cannot be changed
+    virtual bool setBaudrate(const uint32_t /*baudrate*/){ return false; }
+
+    /// \brief
+    /// Returns the baudrate of the UART bus in bits per second, 0 when it is not known
+    virtual uint32_t getBaudrate() const { return 0; }
+
+    /// \brief
+    /// Sends nBytes over the UART bus
+    /// \details
+    /// The default implementation sends the bytes one by one with sendByte.
+    /// Implementations that can write a whole block at once override this function
+    virtual void sendBytes(const uint8_t *data, const size_t nBytes){
+        for(size_t i = 0; i < nBytes; i++){
+            sendByte(data[i]);
+        }
+    }
+
+    /// \brief
+    /// Waits until a byte can be read, or until the timeout has passed
+    /// \details
+    /// The default implementation spins on rxReady(). Implementations that can
+    /// sleep until a byte arrives override this function
+    /// @param  timeout     Time in us to wait at most, 0 checks only once
+    /// @return bool        True when a byte can be read
+    virtual bool waitReadable(const uint_fast32_t timeout){
+        const auto deadline = hwlib::now_us() + timeout;
+        do{
+            if(avialable() > 0 || rxReady()){ return true; }
+        }while(hwlib::now_us() < deadline);
+        return false;
+    }
+
+    /// \brief
+    /// Receives up to nBytes from the UART bus
+    /// \details
+    /// Bytes that are stored in the ringbuffer are returned first. Returns as soon as nBytes
+    /// have been received, or when no byte has arrived within the timeout.
+    /// @param  data        Buffer of at least nBytes
+    /// @param  nBytes      Amount of bytes that need to be received
+    /// @param  timeout     Time in us to wait at most for the next byte
+    /// @return size_t      Amount of bytes that have been received
+    virtual size_t receiveBytes(uint8_t *data, const size_t nBytes, const uint_fast32_t timeout){
+        size_t n = 0;
+        while(n < nBytes && waitReadable(timeout)){
+            data[n++] = (avialable() > 0) ? getC() : receiveByte();
+        }
+        return n;
+    }
 };
 
+#ifdef HWLIB_ARDUINO_DUE_H
+
 /// \brief
 /// Implementation of the abstract UART class
 /// \details
 /// This will only implement TX3 & RX3
+/// @note   This implementation uses the USART0 registers of the arduino due and is therefore
+///         only available when building for that target
 class HardwareUart : public uart_abstract{
 private:
 
     Usart* hw_uart0 = USART0;
     unsigned int baudrate;
-    buffer<255> rxBuffer;
+    static const uint32_t masterClock = 84'000'000;
+    buffer<256> rxBuffer;
     int timeout = 1000;
    
 public:
@@ -192,8 +398,8 @@ public:
         // Reset and disable receiver and transmitter.
         hw_uart0->US_CR = UART_CR_RSTRX | UART_CR_RSTRX | UART_CR_RSTRX | UART_CR_RSTRX;
 
-        //Set initial baudrate to int baudrate
-        hw_uart0->US_BRGR = 45;
+        // Set the baudrate: baudrate = MCK / (16 * CD), rounded to the nearest CD
+        hw_uart0->US_BRGR = (masterClock + 8 * baudrate) / (16 * baudrate);
 
         // No parity, normal channel mode.
         hw_uart0->US_MR = UART_MR_PAR_NO | UART_MR_CHMODE_NORMAL | US_MR_CHRL_8_BIT;
@@ -205,6 +411,21 @@ public:
         hw_uart0->US_CR = UART_CR_RXEN | UART_CR_TXEN;
     }
 
+    /// \brief
+    /// Changes the baudrate, after the transmitter has send its last byte
+    bool setBaudrate(const uint32_t newBaudrate) override {
+        while( ( hw_uart0->US_CSR & US_CSR_TXEMPTY ) == 0 ){}
+        baudrate = newBaudrate;
+        hw_uart0->US_BRGR = (masterClock + 8 * baudrate) / (16 * baudrate);
+        return true;
+    }
+
+    /// \brief
+    /// Returns the baudrate in bits per second
+    uint32_t getBaudrate() const override {
+        return baudrate;
+    }
+
     /// \brief
     /// Checks how many bytes are stored in the buffer
     int avialable() override {
@@ -264,6 +485,8 @@ public:
     }
 };
 
+#endif // HWLIB_ARDUINO_DUE_H
+
 } // namespace hwuart
 
 #endif
\ No newline at end of file
@@ -30,14 +30,34 @@ public:
     /// \details
     /// @param      commandBuffer   Pointer to the start of the commandbuffer that needs to be send
     /// @param      nBytes          Amount of bytes that need to send 
-    virtual void sendData(uint8_t *commandBuffer, uint8_t nBytes) = 0;
+    virtual void sendData(const uint8_t *commandBuffer, size_t nBytes) = 0;
+
+    /// \brief
+    /// Function to send a list of segments over the given protocol as one transfer
+    /// \details
+    /// The default implementation copies the segments into one buffer and calls sendData. Segments that do not fit
+    /// in the buffer (commandBufferSize bytes) are not send at all.
+    /// Protocols that can stream the segments one after another override this function.
+    /// @param      segments        Pointer to the first segment that needs to be send
+    /// @param      count           Amount of segments
+    virtual void sendData(const segment *segments, size_t count);
 
     /// \brief
     /// Abstract function to receive data over the given protocol
     /// \details
     /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
     /// @param      nBytes          Amount of bytes that need to be received over the given protocol
-    virtual void receiveData(uint8_t *receiveBuffer, uint8_t nBytes) = 0;
+    virtual void receiveData(uint8_t *receiveBuffer, size_t nBytes) = 0;
+
+    /// \brief
+    /// Function to receive more data within the read that has been started by receiveData
+    /// \details
+    /// This makes it possible to read a frame in two phases: first the header and then exactly the amount of bytes
+    /// the header announces. The read is closed by endTransaction().
+    /// The default implementation calls receiveData, which is correct for protocols that stream their bytes
+    /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
+    /// @param      nBytes          Amount of bytes that need to be received over the given protocol
+    virtual void receiveMore(uint8_t *receiveBuffer, size_t nBytes){ receiveData(receiveBuffer, nBytes); }
 
     /// \brief
     /// Function to end a specific protocol transaction
@@ -46,6 +66,102 @@ public:
     /// The deconstructor there will cause some chips to not receive data properly
     /// Therefore this function is not mandatory to implement
     virtual void endTransaction(){};
+
+    /// \brief
+    /// Function to ask the chip over the bus itself whether it has a frame ready for the host
+    /// \details
+    /// This is used by the statusReady strategy as an alternative for polling the irq pin.
+    /// Protocols that cannot query the chip's status will always report ready
+    /// @return true    The chip has a frame ready to be read
+    /// @return false   The chip is still busy
+    virtual bool isReady(){ return true; }
+
+    /// \brief
+    /// Function to change the baudrate of a serial protocol
+    /// \details
+    /// Only the host side is changed, the chip has to be told first (SetSerialBaudRate).
+    /// Protocols without a baudrate (spi, i2c) return false
+    /// @param      baudrate        The new baudrate in bits per second
+    virtual bool setBaudrate(const uint32_t /*baudrate*/){ return false; }
+
+    /// \brief
+    /// Function that returns the baudrate of a serial protocol in bits per second, 0 for other protocols
+    virtual uint32_t getBaudrate() const { return 0; }
+};
+
+/// \brief
+/// Abstract strategy to find out whether the chip has a frame ready for the host
+/// \details
+/// The pn532 can signal that it is ready in several ways. It can pull its irq pin low,
+/// report a status byte over spi or set the ready bit of the status byte over i2c.
+/// The strategy is polled by the chip class until it reports ready or until the deadline has passed.
+class readyStrategy
+{
+protected:
+    const uint_fast32_t pollInterval;
+
+public:
+    /// \brief
+    /// Constructor of the readyStrategy class
+    /// \details
+    /// @param  pollInterval    Time in microseconds to wait between two unsuccesfull polls. 0 means a tight poll
+    readyStrategy(const uint_fast32_t pollInterval = 0);
+
+    /// \brief
+    /// Abstract function that checks once whether the chip is ready
+    virtual bool isReady() = 0;
+
+    /// \brief
+    /// Checks whether the chip is ready and waits for the poll interval if it is not
+    /// @return true    The chip has a frame ready to be read
+    /// @return false   The chip is still busy
+    bool poll();
+};
+
+/// \brief
+/// Ready strategy that samples the irq pin of the chip
+/// \details
+/// The pn532 pulls its irq pin low as soon as a frame is ready. This is the fastest strategy
+/// because it does not use the bus at all.
+class irqReady : public readyStrategy
+{
+private:
+    hwlib::pin_in &irq;
+
+public:
+    /// \brief
+    /// Constructor of the irqReady class
+    /// \details
+    /// @param  irq             The irq pin of the chip
+    /// @param  pollInterval    Time in microseconds to wait between two unsuccesfull polls
+    irqReady(hwlib::pin_in &irq, const uint_fast32_t pollInterval = 0);
+
+    /// \brief
+    /// Returns true when the irq pin is low
+    bool isReady() override;
+};
+
+/// \brief
+/// Ready strategy that asks the chip for its status over the bus
+/// \details
+/// For spi this is the status read (0x02) command, for i2c it is the ready bit in the status byte
+/// that precedes every read. Use this strategy when the irq pin is not connected.
+class statusReady : public readyStrategy
+{
+private:
+    protocol &bus;
+
+public:
+    /// \brief
+    /// Constructor of the statusReady class
+    /// \details
+    /// @param  bus             The protocol the chip is connected to
+    /// @param  pollInterval    Time in microseconds to wait between two status reads, so the bus is not flooded
+    statusReady(protocol &bus, const uint_fast32_t pollInterval = 50);
+
+    /// \brief
+    /// Returns true when the chip reports that a frame is ready
+    bool isReady() override;
 };
 
 
@@ -60,6 +176,9 @@ protected:
     hwlib::i2c_bus &bus;
     hwlib::pin_in &irq;
 
+    // true while a read transaction is kept open for receiveMore
+    bool reading = false;
+
 public:
 
     /// \brief
@@ -85,14 +204,42 @@ public:
     /// \details
     /// @param      commandBuffer   Pointer to the start of the commandbuffer that needs to be send
     /// @param      nBytes          Amount of bytes that need to be send over i2c
-    void sendData(uint8_t *commandBuffer, uint8_t nBytes);
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function sends all segments in one i2c write transaction
+    /// \details
+    /// @param      segments        Pointer to the first segment that needs to be send
+    /// @param      count           Amount of segments
+    void sendData(const segment *segments, size_t count) override;
 
     /// \brief
     /// This function receives data from the initialised adress over the i2c protocol
     /// \details
+    /// The status byte the chip sends at the start of every i2c read is not stored, so the receiveBuffer
+    /// starts with the frame itself. The read stays open until endTransaction() is called.
     /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
     /// @param      nBytes          Amount of bytes that need to be received over i2c
-    void receiveData(uint8_t *receiveBuffer, uint8_t nBytes);
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function receives the next nBytes of the read that has been started by receiveData
+    /// \details
+    /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
+    /// @param      nBytes          Amount of bytes that need to be received over i2c
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function closes the read that has been started by receiveData
+    /// \details
+    /// The last byte is not acknowledged and a stop condition is send
+    void endTransaction() override;
+
+    /// \brief
+    /// This function reads the status byte the chip sends at the start of every i2c read
+    /// \details
+    /// Bit 0 of the status byte is set when the chip has a frame ready
+    bool isReady() override;
 };
 
 
@@ -104,6 +251,11 @@ protected:
     hwlib::pin_in &irq;
     hwlib::pin_out &sel;  
 
+    // the first byte of every spi transaction tells the pn532 what the host does
+    static const uint8_t dataWrite  = 0x01;
+    static const uint8_t statusRead = 0x02;
+    static const uint8_t dataRead   = 0x03;
+
 public:
     
     /// \brief
@@ -127,34 +279,84 @@ public:
     /// \brief
     /// This function sends nBytes to the chip connected to the sel pin over the spi protocol
     /// \details
+    /// The buffer is send as a single segment, see below
     /// @param      commandBuffer   Pointer to the start of the commandbuffer that needs to be send
     /// @param      nBytes          Amount of bytes that need to send over spi
-    void sendData(uint8_t *commandBuffer, uint8_t nBytes) override;
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function sends all segments after one data write (0x01) while the sel pin stays low
+    /// \details
+    /// The data write and the segments are one spi transaction. The sel pin stays low until endTransaction() is called
+    /// @param      segments        Pointer to the first segment that needs to be send
+    /// @param      count           Amount of segments
+    void sendData(const segment *segments, size_t count) override;
 
     /// \brief
     /// This function receives nBytes from the chip connected to the sel pin over the spi protocol
     /// \details
+    /// The sel pin stays low until endTransaction() is called, so the read can be continued with receiveMore
+    /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
+    /// @param      nBytes          Amount of bytes that need to be received over spi
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function receives the next nBytes of the data read that has been started by receiveData
+    /// \details
+    /// The read continues in the same transaction, the sel pin is not written
     /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
     /// @param      nBytes          Amount of bytes that need to be received over spi
-    void receiveData(uint8_t *receiveBuffer, uint8_t nBytes) override;
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override;
 
     /// \brief
     /// This fucntion will end the transaction of the sel chip
     /// \details
-    /// It will acheive this by rising the sel pin again after all data has been send
+    /// It will acheive this by rising the sel pin again after all data has been send.
+    /// No new transaction is started for this, so sel does not go low first
     void endTransaction() override;
+
+    /// \brief
+    /// This function sends a status read (0x02) to the chip and checks the returned status byte
+    /// \details
+    /// Bit 0 of the status byte is set when the chip has a frame ready
+    bool isReady() override;
+};
+
+/// \brief
+/// Ready strategy that waits for the first byte of a frame on an uart bus
+/// \details
+/// Over HSU the pn532 has no status read, it simply starts sending the frame. Instead of spinning on
+/// rxReady(), this strategy lets the uart wait for a byte (hwuart::uart_abstract::waitReadable), so an
+/// uart that can sleep until a byte arrives does not use the cpu while the chip is busy.
+class uartReady : public readyStrategy
+{
+private:
+    hwuart::uart_abstract &bus;
+    const uint_fast32_t timeout;
+
+public:
+    /// \brief
+    /// Constructor of the uartReady class
+    /// \details
+    /// @param  bus             The uart the chip is connected to
+    /// @param  timeout         Time in microseconds one check waits at most for a byte
+    uartReady(hwuart::uart_abstract &bus, const uint_fast32_t timeout = 1000);
+
+    /// \brief
+    /// Returns true when a byte has arrived within the timeout
+    bool isReady() override;
 };
 
 /// \brief
-/// Hardware UART implementation of the abstract protocol class
+/// UART implementation of the abstract protocol class
 /// \details
-/// @warning    This hardware implementation is not yet finished!
-///             This implementation can send data over the UART protocol,
-///             but cannot properly receive data yet.
-///             This is a work in progress
+/// @warning    The hardware uart of the arduino due (hwuart::HardwareUart) can send data,
+///             but cannot properly receive data yet. Uarts that can receive, like
+///             hwuart::PosixUart, work for both directions.
 class uart : public protocol {
 private:
     hwuart::uart_abstract& bus;
+    const uint_fast32_t timeout;
 
 public:
 
@@ -162,7 +364,8 @@ public:
     /// Constructor of the UART class
     /// \details
     /// @param  abstract_uart   A reference to a abstract uart class
-    uart(hwuart::uart_abstract& bus);
+    /// @param  timeout         Time in microseconds a read waits at most for the next byte
+    uart(hwuart::uart_abstract& bus, const uint_fast32_t timeout = 10'000);
 
     /// \brief
     /// This Funtion will wake up / initialise the spi bus / chip for communication
@@ -176,20 +379,36 @@ public:
     /// \details
     /// @param      commandBuffer   Pointer to the start of the commandbuffer that needs to be send
     /// @param      nBytes          Amount of bytes that need to send over spi
-    void sendData(uint8_t *commandBuffer, uint8_t nBytes);
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function sends the segments as one frame to the chip connected to the UART bus
+    /// \details
+    /// @param      segments        Pointer to the first segment that needs to be send
+    /// @param      count           Amount of segments
+    void sendData(const segment *segments, size_t count) override;
 
     /// \brief
     /// This function receives nBytes from the chip connected to the UART bus
     /// \details
-    ///
-    /// @warning    This function does not work properly yet! 
-    ///             Internal UART Receive register may overflow and therefore interrupt
-    ///             causing undefined behaviour
+    /// The bytes are streamed, so the next call continues where this one stopped.
+    /// When the chip stops sending before nBytes have arrived, the missing bytes are 0x00
     ///
     /// @param      receiveBuffer   Pointer to the start of the receiveBuffer where data can be stored in
-    /// @param      nBytes          Amount of bytes that need to be received over spi
-    void receiveData(uint8_t *receiveBuffer, uint8_t nBytes);
+    /// @param      nBytes          Amount of bytes that need to be received over the uart
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// This function checks whether the chip has started sending a frame
+    bool isReady() override;
 
+    /// \brief
+    /// This function changes the baudrate of the uart
+    bool setBaudrate(const uint32_t baudrate) override;
+
+    /// \brief
+    /// This function returns the baudrate of the uart
+    uint32_t getBaudrate() const override;
 };
 
 }// namespace communication
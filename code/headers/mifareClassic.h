@@ -1,13 +1,23 @@
 /**
  * @file
  * @brief    Data object for a nfc card where data can be stored in
- * 
- * This file provides a data object where a nfc reader can store the read cardinformation in. For now,
- * this card is fixed for just a Mifare classic 1k card. In the future templates will be added
- * so that the user can initialise a card class for any card.
- * 
- * TODO: Add template
- * 
+ *
+ * This file provides a data object where a nfc reader can store the read cardinformation in.
+ *
+ * cardIdentity is what is needed to recognise a card again: its UID (4, 7 or 10 bytes), ATQA and SAK, and the last
+ * known value of its value block. It takes 20 bytes, so it is the type to keep in tables of checked in cards and the like.
+ * card holds the identity of a card, the target number the reader has given it and the authenticated sector.
+ * A card object on its own does not store the memory of the card.
+ * mifareClassicCard<geometry> adds the memory of a Mifare Classic card with the given geometry, so the card
+ * only takes the bytes the card really has: 320 for a Mini, 1024 for a 1k and 4096 for a 4k.
+ * Next to the memory it keeps one bit per block that tells whether the block has been read, so a
+ * partial read of a card can be told apart from blocks that are 0. nfc::cardImage reads the missing blocks on first access.
+ * A second bitmap keeps the blocks that have been changed with setPage() and still have to be written to the card.
+ *
+ * All Mifare Classic cards have the same block layout, a 4k just goes on further: sector 0 - 31 have 4 blocks,
+ * sector 32 - 39 have 16 blocks. The last block of every sector is the sector trailer.
+ * cardGeometry does this math in constexpr functions.
+ *
  * @author    Nathan Houwaart
  * @license   See LICENSE
  */
@@ -19,34 +29,156 @@
 #include "pn532Command.h"
 
 /// \brief
-/// card class
+/// Block layout of a Mifare Classic card
+struct cardGeometry{
+    static constexpr uint8_t blockSize      = nfc::pn532::general::Mifare1kPageSize;
+    static constexpr uint8_t smallSectors   = 32;       // sectors of 4 blocks, the sectors after them have 16 blocks
+
+    uint8_t sectors;
+
+    /// \brief
+    /// Returns the first block of a sector
+    static constexpr uint16_t firstBlock(const uint8_t sector){
+        return (sector < smallSectors) ? sector * 4 : smallSectors * 4 + (sector - smallSectors) * 16;
+    }
+
+    /// \brief
+    /// Returns the amount of blocks of a sector
+    static constexpr uint8_t blocksIn(const uint8_t sector){
+        return (sector < smallSectors) ? 4 : 16;
+    }
+
+    /// \brief
+    /// Returns the sector a block belongs to
+    static constexpr uint8_t sectorOf(const uint16_t block){
+        return (block < smallSectors * 4) ? block / 4 : smallSectors + (block - smallSectors * 4) / 16;
+    }
+
+    /// \brief
+    /// Returns the sector trailer of a sector
+    static constexpr uint16_t trailerOf(const uint8_t sector){
+        return firstBlock(sector) + blocksIn(sector) - 1;
+    }
+
+    /// \brief
+    /// Returns whether a block is a sector trailer
+    static constexpr bool isTrailer(const uint16_t block){
+        return trailerOf(sectorOf(block)) == block;
+    }
+
+    /// \brief
+    /// Returns the amount of blocks of the card
+    constexpr uint16_t blocks() const { return firstBlock(sectors); }
+
+    /// \brief
+    /// Returns the size of the memory of the card in bytes
+    constexpr uint16_t size() const { return blocks() * blockSize; }
+
+    /// \brief
+    /// Returns the amount of 32 bit words of a bitmap with one bit per block
+    constexpr uint8_t bitmapWords() const { return (blocks() + 31) / 32; }
+};
+
+inline constexpr cardGeometry noMemory          = {0};      // a card of which only the UID is stored
+inline constexpr cardGeometry mifareMiniGeometry = {5};
+inline constexpr cardGeometry mifare1kGeometry  = {16};
+inline constexpr cardGeometry mifare4kGeometry  = {40};
+
+static_assert(mifareMiniGeometry.size() == 320 && mifare1kGeometry.size() == 1024 && mifare4kGeometry.size() == 4096);
+static_assert(mifare4kGeometry.trailerOf(39) == 255 && mifare4kGeometry.sectorOf(128) == 32);
+
+/// \brief
+/// Identity of a card
 /// \details
-/// This class saves the data of the card in a buffer
-/// You can either read, add orr add a UID.
+/// A plain struct without the memory of the card, it can be copied and compared cheaply.
+/// Two identities are the same card when their UIDs are the same.
+struct cardIdentity{
+    static const uint8_t noValue = 0xFF;    // valueBlock when no value is known, block 255 is a sector trailer
+
+    std::array<uint8_t, nfc::pn532::general::MifareMaxUIDsize> uid = {0};
+    uint8_t     uidSize     = 0;
+    uint8_t     atqa[2]     = {0};          // SENS_RES, as send by the card
+    uint8_t     sak         = 0;            // SEL_RES
+    uint8_t     valueBlock  = noValue;      // block of which the value is known
+    uint32_t    value       = 0;            // value of that block the last time it has been read or written
+
+    /// \brief
+    /// Returns whether a value of the card is known
+    bool hasValue() const { return valueBlock != noValue; }
+
+    /// \brief
+    /// Returns whether this is the identity of a card, and not an empty entry
+    bool valid() const { return uidSize != 0; }
 
-// template<uint8_t UIDsize, int cardSize>
+    bool operator==(const cardIdentity& other) const { return uidSize == other.uidSize && uid == other.uid; }
+    bool operator!=(const cardIdentity& other) const { return !(*this == other); }
+};
+
+static_assert(sizeof(cardIdentity) == 20, "a cardIdentity is meant to stay small");
+
+/// \brief
+/// card class
+/// \details
+/// This class saves the identity of a card and its authenticated sector.
+/// The memory of the card is stored by mifareClassicCard, a card object on its own ignores addPage.
 class card{
+public:
+    static const uint8_t maxUIDsize = nfc::pn532::general::MifareMaxUIDsize;
+
 private:
-    size_t                                                      pageSize;
-    std::array<uint8_t, nfc::pn532::general::Mifare1kUIDsize>   cardUID = {0};
-    uint8_t cardData[nfc::pn532::general::Mifare1kSize] = {0}; // initialise the array with 0's
+    cardIdentity                                                identity;
+    uint8_t                                                     targetNumber = 1;   // number the nfc chip has given the card
+
+    // sector of the card that is authenticated, see setSession()
+    struct authSession{
+        uint_fast32_t   generation  = 0;
+        uint8_t         cardNumber  = 0;
+        uint8_t         sector      = 0xFF;
+        uint8_t         keyType     = 0;
+        uint8_t         key[6]      = {0};
+    } session;
+
+protected:
+    /// \brief
+    /// Returns the memory of the card, nullptr when it is not stored
+    virtual uint8_t* memory(){ return nullptr; }
+    virtual const uint8_t* memory() const { return nullptr; }
+
+    /// \brief
+    /// Returns the bitmap of the blocks that have been read, one bit per block, nullptr when the memory is not stored
+    virtual uint32_t* validBlocks(){ return nullptr; }
+    virtual const uint32_t* validBlocks() const { return nullptr; }
+
+    /// \brief
+    /// Returns the bitmap of the blocks that have been changed, one bit per block, nullptr when the memory is not stored
+    virtual uint32_t* dirtyBlocks(){ return nullptr; }
+    virtual const uint32_t* dirtyBlocks() const { return nullptr; }
+
 public:
+    card() = default;
+
     /// \brief
-    /// Default onstructor for a normal nfc card 
+    /// Constructor of a card of which the identity is known
     /// \details
-    /// A normal nfc card has a page size of 16 bytes, hence this default constructor sets the page size to 16.
-    card():pageSize(nfc::pn532::general::Mifare1kPageSize){};
+    /// For example a card of a table of checked in cards, so the nfc functions can be used on it again
+    /// @param  identity    Identity of the card
+    explicit card(const cardIdentity& identity): identity(identity){}
+
+    /// \brief
+    /// Returns the geometry of the stored memory, noMemory when the memory is not stored
+    virtual const cardGeometry& geometry() const { return noMemory; }
 
     /// \brief
     /// Add a page to the card data buffer
     /// \details
-    /// This command stores the received bytes from the pn532 chip in a buffer.
-    /// This way we can read the whole card faster.
+    /// This command stores the received bytes from the pn532 chip in a buffer and marks the page as read.
+    /// This way we can read the whole card faster. Pages outside the geometry and pages that have been changed
+    /// with setPage() and not been written yet are ignored.
     /// @param  bytes       Pointer to an array of the bytes that need to be stored in the card object
     /// @param  bytesSize   Size of the array with data
     /// @param  pageNumber  Page the data needs to be stored in
-    void addPage(uint8_t* bytes, size_t bytesSize, int pageNumber);
-    
+    void addPage(const uint8_t* bytes, size_t bytesSize, int pageNumber);
+
     /// \brief
     /// Read a page from the card buffer
     /// \details
@@ -57,8 +189,11 @@ public:
     /// \brief
     /// This function sets the UID of a card object
     /// \details
-    /// @param uid  Pointer to an array of the UID that needs to be stored in the card data type
-    void setUID(uint8_t* uid);
+    /// A new UID is a new card, so the rest of the identity and the pages that have been read are cleared as well.
+    /// The same UID again keeps them
+    /// @param uid      Pointer to an array of the UID that needs to be stored in the card data type
+    /// @param length   Length of the UID: 4, 7 or 10 bytes. Longer UIDs are cut off at maxUIDsize
+    void setUID(const uint8_t* uid, uint8_t length = nfc::pn532::general::Mifare1kUIDsize);
 
     /// \brief
     /// This function sets the UID of a card object
@@ -67,17 +202,144 @@ public:
     /// @param  receivedCommand     a received command that the UID needs to be abducted from
     void setUID(receivedCommand& response);
 
-    /// \brief 
+    /// \brief
     /// This function will return the stored UID of a card data object
     /// \details
+    /// The bytes after getUIDsize() are 0
     /// @return array   User ID that is stored in the data object
-    std::array<uint8_t, nfc::pn532::general::Mifare1kUIDsize> getUID() const;
+    std::array<uint8_t, maxUIDsize> getUID() const { return identity.uid; }
+
+    /// \brief
+    /// Returns the length of the UID in bytes
+    uint8_t getUIDsize() const { return identity.uidSize; }
+
+    /// \brief
+    /// Returns the identity of the card, to store the card without its memory
+    const cardIdentity& getIdentity() const { return identity; }
+
+    /// \brief
+    /// Stores the ATQA (SENS_RES) and SAK (SEL_RES) the card has answered with
+    void setTargetData(const uint8_t* atqa, uint8_t sak);
+
+    /// \brief
+    /// Stores the value of a value block, after it has been read or written
+    void setValue(uint8_t block, uint32_t value){ identity.valueBlock = block; identity.value = value; }
+
+    /// \brief
+    /// Forgets the stored value when it is the value of block, because the block has been changed
+    void forgetValue(uint8_t block){ if(identity.valueBlock == block){ identity.valueBlock = cardIdentity::noValue; } }
+
+    /// \brief
+    /// Returns the 4 bytes of the UID that are used for the Mifare authentication
+    /// \details
+    /// For a 4 byte UID this is the UID itself, for 7 and 10 byte UIDs these are the last 4 bytes
+    const uint8_t* authenticationUID() const;
+
+    /// \brief
+    /// Sets the target number the nfc chip has given to this card
+    /// \details
+    /// When more cards are in the RF field, the target number tells the nfc chip which card a command is for
+    /// @param  tg  Target number (1 or 2 for the pn532)
+    void setTargetNumber(uint8_t tg){ targetNumber = tg; }
+
+    /// \brief
+    /// Returns the target number the nfc chip has given to this card
+    /// @return uint8_t Target number, to be used as cardNumber in the nfc functions
+    uint8_t getTargetNumber() const { return targetNumber; }
 
     /// \brief
     /// This function will return the data of one specific page that is stored in this data object
     /// \details
+    /// Pages outside the geometry are returned as 0, just as pages that have not been read. See hasPage()
     /// @return array   Content of one particulair page
     std::array<uint8_t, nfc::pn532::general::Mifare1kPageSize> getPage(uint8_t page) const;
+
+    /// \brief
+    /// Returns whether a page has been read from the card
+    bool hasPage(uint16_t page) const;
+
+    /// \brief
+    /// Returns the amount of pages that have been read from the card
+    uint16_t pagesRead() const;
+
+    /// \brief
+    /// Forgets all pages that have been read, the memory is cleared
+    /// \details
+    /// Changes that have not been written to the card are lost as well
+    void clearPages();
+
+    /// \brief
+    /// Changes a page in the memory of the card object
+    /// \details
+    /// The page counts as read and is marked as changed, until it has been written to the card. See nfc::cardImage::commit()
+    /// Pages outside the geometry are ignored.
+    /// @param  page    Page that is changed
+    /// @param  data    The 16 new bytes of the page
+    void setPage(uint16_t page, const uint8_t* data);
+
+    /// \brief
+    /// Returns whether a page has been changed and not yet been written to the card
+    bool isDirty(uint16_t page) const;
+
+    /// \brief
+    /// Returns the amount of pages that have been changed and not yet been written to the card
+    uint16_t pagesDirty() const;
+
+    /// \brief
+    /// Marks a page as written to the card
+    void markClean(uint16_t page);
+
+    /// \brief
+    /// Stores which sector of the card has been authenticated, and with which key
+    /// \details
+    /// The reader hands out a new generation every time an authentication ends: on a new
+    /// authentication, an error or when the card is selected again. So a session is only
+    /// valid as long as the generation of the reader has not changed.
+    /// @param  generation  Generation of the reader at the time of the authentication
+    /// @param  cardNumber  Target number of the card
+    /// @param  sector      Sector that has been authenticated
+    /// @param  keyType     Key A or key B
+    /// @param  key         The 6 byte key that has been used
+    void setSession(uint_fast32_t generation, uint8_t cardNumber, uint8_t sector, uint8_t keyType, const uint8_t* key);
+
+    /// \brief
+    /// Returns whether the sector is still authenticated with the given key
+    /// @param  generation  Current generation of the reader
+    /// @return bool        True when the authentication can be skipped
+    bool hasSession(uint_fast32_t generation, uint8_t cardNumber, uint8_t sector, uint8_t keyType, const uint8_t* key) const;
+
+    /// \brief
+    /// Forgets the authenticated sector
+    void clearSession(){ session = authSession(); }
+};
+
+/// \brief
+/// Mifare Classic card with its memory
+/// \details
+/// @tparam layout  Geometry of the card, for example mifare1kGeometry
+template<const cardGeometry& layout>
+class mifareClassicCard : public card{
+private:
+    static_assert(layout.sectors > 0, "a card without memory is a card object");
+
+    uint8_t cardData[layout.size()] = {0}; // initialise the array with 0's
+    uint32_t readBlocks[layout.bitmapWords()] = {0};
+    uint32_t changedBlocks[layout.bitmapWords()] = {0};
+
+protected:
+    uint8_t* memory() override { return cardData; }
+    const uint8_t* memory() const override { return cardData; }
+    uint32_t* validBlocks() override { return readBlocks; }
+    const uint32_t* validBlocks() const override { return readBlocks; }
+    uint32_t* dirtyBlocks() override { return changedBlocks; }
+    const uint32_t* dirtyBlocks() const override { return changedBlocks; }
+
+public:
+    const cardGeometry& geometry() const override { return layout; }
 };
 
-#endif
\ No newline at end of file
+using mifareMini    = mifareClassicCard<mifareMiniGeometry>;
+using mifare1k      = mifareClassicCard<mifare1kGeometry>;
+using mifare4k      = mifareClassicCard<mifare4kGeometry>;
+
+#endif
@@ -23,11 +23,83 @@
 #include "interface.h"
 #include "mifareClassic.h"
 
+#include <type_traits>
+
 namespace nfc {
 
 /// Struct where results of functions can be stored in
 struct Result {statusCode status; receivedCommand response;};
 
+/// \brief
+/// States of an asynchronous command
+/// \details
+///     idle:               No command has been submitted yet
+///     waitingForAck:      The command has been send, the chip has not acknowledged it yet
+///     waitingForResponse: The chip has acknowledged the command and is executing it
+///     done:               The response has been received and can be fetched
+///     failed:             The command timed out or the chip send an invalid frame
+///     cancelled:          The command has been aborted by the host
+enum class commandState : uint8_t {
+    idle,
+    waitingForAck,
+    waitingForResponse,
+    done,
+    failed,
+    cancelled
+};
+
+/// \brief
+/// Abstract listener that is notified about the progress of an asynchronous command
+/// \details
+/// The functions are called from within NFC::poll(), so they run in the context of the application
+class commandListener {
+public:
+    /// \brief
+    /// Called when the chip has acknowledged the command
+    virtual void acknowledged(){}
+
+    /// \brief
+    /// Called when the command is done or has failed. Not called after cancel()
+    /// @param result   Status of the command and, when done, the response of the chip
+    virtual void finished(const Result& result) = 0;
+};
+
+/// \brief
+/// What a sector read does when a sector cannot be authenticated
+/// \details
+///     abort:      Stop reading, the sectors that are left are not read
+///     skipSector: Go on with the next sector
+///     switchKey:  Try the sector again with the other key (A or B), then go on with the next sector
+enum class authFailurePolicy : uint8_t {
+    abort,
+    skipSector,
+    switchKey
+};
+
+/// \brief
+/// Options for NFC::mifareReadSectors()
+struct readOptions {
+    uint64_t            sectorMask      = ~uint64_t(0);                     // bit n set: sector n is read
+    bool                skipTrailers    = false;                            // don't read the sector trailer blocks
+    mifareCommands      keyType         = mifareCommands::authenticateKeyA; // key that is tried first
+    authFailurePolicy   onAuthFailure   = authFailurePolicy::skipSector;
+};
+
+/// \brief
+/// Options for the InAutoPoll functions
+/// \details
+/// The nfc chip polls pollCount times for every type, and waits period * 150 ms between two polls.
+/// With a pollCount of pn532::command::autoPoll::pollForever, the chip polls until a target has been found.
+struct autoPollOptions {
+    uint8_t             pollCount       = 0x01;
+    uint8_t             period          = 0x01;
+    uint8_t             types[pn532::command::autoPoll::maxTypes] = {pn532::command::autoPoll::Mifare};
+    uint8_t             typeCount       = 1;
+};
+
+/// Status of every sector of a Mifare Classic card after a sector read, a 4k has the most sectors
+using sectorStatus = std::array<statusCode, cardKeys::sectors>;
+
 /// \brief
 /// Pure abstract template class that can be implemented by any nfc reader
 class NFC {
@@ -64,7 +136,7 @@ public:
     ///         with this function to achieve the same thing
     /// @param commandBuffer    Pointer to the commandBuffer we want to send
     /// @param n_bytes          Amount of bytes that needs to be send 
-    virtual void sendData(uint8_t* commandBuffer, const uint8_t n_bytes) = 0;
+    virtual void sendData(const uint8_t* commandBuffer, const size_t n_bytes) = 0;
 
     /// \brief
     /// Abstract function to get data from the nfc chip over the provided interface
@@ -74,7 +146,7 @@ public:
     ///         with this function to achieve the same thing
     /// @param buffer       Pointer to the buffer we want to store received data in
     /// @param n_bytes      Amount of bytes that needs to be read
-    virtual void getData(uint8_t* buffer, const uint8_t n_bytes) = 0;
+    virtual void getData(uint8_t* buffer, const size_t n_bytes) = 0;
 
     /// \brief
     /// Abstract function to write a internal register of a nfc chip
@@ -143,6 +215,116 @@ public:
     /// @return Result[1]   received command/data frm the nfc chip
     virtual Result sendCommandAndCheckAck(setupSendCommand &command) = 0;
 
+    /// \brief
+    /// Abstract function that handles the complete communication for a command that is send as a list of segments
+    /// \details
+    /// The segments are send in one transfer, one after another, so they never need to be copied into one buffer
+    /// @param segments     Pointer to the first segment of the command frame
+    /// @param count        Amount of segments
+    /// @return Result[0]   Statuscode of the operation
+    /// @return Result[1]   received command/data frm the nfc chip
+    virtual Result sendCommandAndCheckAck(const communication::segment* segments, const size_t count) = 0;
+
+    /// \brief
+    /// Sends a (precomputed) command frame and handles the complete communication
+    /// \details
+    /// @param frame        Frame that needs to be send
+    /// @return Result[0]   Statuscode of the operation
+    /// @return Result[1]   received command/data frm the nfc chip
+    template<uint8_t n>
+    Result sendCommandAndCheckAck(const commandFrame<n>& frame)
+    {
+        const auto segment = frame.segment();
+        return sendCommandAndCheckAck(&segment, 1);
+    }
+
+    /// \brief
+    /// Sends a command frame with its payload and handles the complete communication
+    /// \details
+    /// The payload is send straight from the given buffer
+    /// @param frame        Frame that needs to be send
+    /// @param payload      Pointer to the payload of the frame
+    /// @return Result[0]   Statuscode of the operation
+    /// @return Result[1]   received command/data frm the nfc chip
+    template<uint8_t n, uint8_t payloadSize>
+    Result sendCommandAndCheckAck(commandFrame<n, payloadSize>& frame, const uint8_t* payload)
+    {
+        communication::segment segments[3];
+        frame.segments(payload, segments);
+        return sendCommandAndCheckAck(segments, 3);
+    }
+
+
+    // ------------------------------------------------------------------------------- //
+    // Asynchronous command functions                                                  //
+    // ------------------------------------------------------------------------------- //
+
+    /// \brief
+    /// Abstract function to send a command without waiting for the nfc chip
+    /// \details
+    /// The command is send right away, after that poll() advances the command through its states.
+    /// Only one command can be in progress at a time.
+    /// @param segments     Pointer to the first segment of the command frame
+    /// @param count        Amount of segments
+    /// @param listener     Optional listener that is notified from within poll()
+    /// @return statusCode  pn532StatusBusy when a command is still in progress, otherwise pn532StatusOK
+    virtual statusCode submit(const communication::segment* segments, const size_t count, commandListener* listener = nullptr) = 0;
+
+    /// \brief
+    /// Abstract function that checks once, without blocking, whether the nfc chip has answered
+    /// \details
+    /// @return commandState    State of the command after the check
+    virtual commandState poll() = 0;
+
+    /// \brief
+    /// Abstract function that returns the result of the last command
+    /// \details
+    /// @note   The response is only valid when the state is done, and only until the next command is submitted
+    /// @return Result[0]   Statuscode of the command. pn532StatusBusy when it is still in progress
+    /// @return Result[1]   received command/data frm the nfc chip
+    virtual Result fetch() = 0;
+
+    /// \brief
+    /// Abstract function that aborts the command that is in progress
+    /// \details
+    /// The pn532 is told to abort by sending an ACK frame to it
+    virtual void cancel() = 0;
+
+    /// \brief
+    /// Sends a (precomputed) command frame without waiting for the nfc chip
+    /// \details
+    /// @param frame        Frame that needs to be send
+    /// @param listener     Optional listener that is notified from within poll()
+    /// @return statusCode  pn532StatusBusy when a command is still in progress, otherwise pn532StatusOK
+    template<uint8_t n>
+    statusCode submit(const commandFrame<n>& frame, commandListener* listener = nullptr)
+    {
+        const auto segment = frame.segment();
+        return submit(&segment, 1, listener);
+    }
+
+    /// \brief
+    /// Sends a command frame with its payload without waiting for the nfc chip
+    /// \details
+    /// @param frame        Frame that needs to be send
+    /// @param payload      Pointer to the payload of the frame
+    /// @param listener     Optional listener that is notified from within poll()
+    /// @return statusCode  pn532StatusBusy when a command is still in progress, otherwise pn532StatusOK
+    template<uint8_t n, uint8_t payloadSize>
+    statusCode submit(commandFrame<n, payloadSize>& frame, const uint8_t* payload, commandListener* listener = nullptr)
+    {
+        communication::segment segments[3];
+        frame.segments(payload, segments);
+        return submit(segments, 3, listener);
+    }
+
+    /// \brief
+    /// Returns whether a command is still waiting for the nfc chip
+    static bool inProgress(const commandState state)
+    {
+        return state == commandState::waitingForAck || state == commandState::waitingForResponse;
+    }
+
 
     // ------------------------------------------------------------------------------- //   
     // More advanced functions                                                         //
@@ -185,11 +367,77 @@ public:
     virtual bool detectCard(card& cardinfo, const uint8_t nCards, const uint8_t cardtype) = 0;
 
     /// \brief
-    /// Abstract function to select / or deselect a specific card that is in the nfc's rf field.
+    /// Abstract function that lets the nfc chip poll for a card (one shot)
+    /// \details
+    /// The chip polls on its own and answers as soon as a target has been found, or when it has polled
+    /// options.pollCount times. The host only waits for that one answer.
+    /// @param  cardinfo    Card class where the UID of the found card is stored in
+    /// @param  options     Amount of polls, period and target types
+    /// @return false       No card has been found
+    /// @return true        A card has been found
+    virtual bool autoPoll(card& cardinfo, const autoPollOptions& options) = 0;
+
+    /// \brief
+    /// Abstract function that starts polling for a card without waiting for it (continuous)
+    /// \details
+    /// Use poll() to see when a card has been found and getAutoPollTarget() to get it.
+    /// Polling can be stopped with cancel(). After a card has been handled, call startAutoPoll() again.
+    /// @param  options     Amount of polls, period and target types
+    /// @param  listener    Optional listener that is notified when the chip has found a card
+    /// @return statusCode  pn532StatusOK when polling has been started, pn532StatusBusy when a command is still in progress
+    virtual statusCode startAutoPoll(const autoPollOptions& options, commandListener* listener = nullptr) = 0;
+
+    /// \brief
+    /// Abstract function that returns the card that has been found by startAutoPoll()
+    /// @param  cardinfo    Card class where the UID of the found card is stored in
+    /// @return false       Polling is still in progress, has failed or no card with a UID has been found, cardinfo is not changed
+    /// @return true        A card has been found, its UID and target number are stored in cardinfo
+    virtual bool getAutoPollTarget(card& cardinfo) = 0;
+
+    /// \brief
+    /// Abstract function for a nfc chip to detect up to nCards cards that are in it´s rf field at the same time
+    /// \details
+    /// Every card that has been found gets its UID and target number. Use the target number
+    /// (card::getTargetNumber()) as cardNumber for the other functions.
+    /// @param  cards       Array of at least nCards pointers to card classes
+    /// @param  nCards      Maximum amount of cards that needs to be detected (the pn532 detects at most 2)
+    /// @param  cardtype    Type of card that needs to be read
+    /// @return uint8_t     Amount of cards that have been found
+    virtual uint8_t detectCards(card* const* cards, const uint8_t nCards, const uint8_t cardtype) = 0;
+
+    /// \brief
+    /// Detects up to nCards cards into an array of cards of one type, for example mifare1k cards[2]
+    /// \details
+    /// The cards can be of any size, so the array is passed on as pointers to its elements
+    template<typename cardType, typename = std::enable_if_t<std::is_base_of_v<card, cardType>>>
+    uint8_t detectCards(cardType* cards, const uint8_t nCards, const uint8_t cardtype)
+    {
+        const uint8_t maxCards = 2;     // InListPassiveTarget lists at most 2 targets
+        card* pointers[maxCards] = {};
+        const uint8_t n = nCards > maxCards ? maxCards : nCards;
+        for(uint8_t i = 0; i < n; i++){ pointers[i] = &cards[i]; }
+        return detectCards(pointers, n, cardtype);
+    }
+
+    /// \brief
+    /// Abstract function to select a specific card that is in the nfc's rf field.
     /// \details
     /// This can be used when multiple cards are within the rf field of a NFC chip
-    /// @return statusCode Status of the operation
-    virtual statusCode selectCard() = 0;
+    /// @param  cardNumber  Target number of the card
+    /// @return statusCode  Status of the operation
+    virtual statusCode selectCard(const uint8_t cardNumber) = 0;
+
+    /// \brief
+    /// Abstract function to deselect a card. The card stays known by the nfc chip and can be selected again
+    /// @param  cardNumber  Target number of the card, 0 for all cards
+    /// @return statusCode  Status of the operation
+    virtual statusCode deselectCard(const uint8_t cardNumber) = 0;
+
+    /// \brief
+    /// Abstract function to release a card. The nfc chip forgets the card, it needs to be detected again
+    /// @param  cardNumber  Target number of the card, 0 for all cards
+    /// @return statusCode  Status of the operation
+    virtual statusCode releaseCard(const uint8_t cardNumber) = 0;
 
     /// \brief
     /// Abstract function to set the mode of the internal SAM (Security Access Module)
@@ -222,6 +470,13 @@ public:
     /// @return statuscode  Status of the operation
     virtual statusCode setSerialBaudrate(const nfc::baudRate br) = 0;
 
+    /// \brief
+    /// Abstract function to put a nfc chip in its low power mode
+    /// \details
+    /// @param  wakeUpEnable    Sources that are allowed to wake the chip again
+    /// @return statuscode      Status of the operation
+    virtual statusCode powerDown(const uint8_t wakeUpEnable) = 0;
+
 
     // ------------------------------------------------------------------------------- //
     // Mifare specific functions                                                       //
@@ -230,6 +485,7 @@ public:
     /// \brief
     /// Method to read a entire mifare classic card
     /// \details
+    /// Reads every sector with mifareReadSectors(). Sectors that can not be authenticated are skipped.
     /// @param cardinfo     a card class where the card data can be stored in
     /// @param cardNumber   card that needs to be read
     /// @param AorB         wether the sector trailer blocks need to be authenticated with key A or key B
@@ -237,6 +493,20 @@ public:
     /// @return statusCode  status of the operation
     virtual statusCode mifareReadCard(card& cardInfo, const uint8_t cardNumber, const mifareCommands AorB, const cardKeys& authenticationKeys) = 0;
 
+    /// \brief
+    /// Method to read a chosen set of sectors of a mifare classic card
+    /// \details
+    /// Every sector is authenticated once, after which its blocks are read. A sector that can not be
+    /// authenticated is handled as told by options.onAuthFailure. Nothing is printed, the result
+    /// of every sector is stored in status.
+    /// @param cardinfo     a card class where the card data can be stored in
+    /// @param cardNumber   card that needs to be read
+    /// @param cardKeys     struct to the sector trailer keys of the card
+    /// @param options      sectors to read, key to use and what to do when authentication fails
+    /// @param status       status of every sector, pn532StatusNotRead for sectors that have not been read
+    /// @return statusCode  status of the first sector that failed, pn532StatusOK when all sectors have been read
+    virtual statusCode mifareReadSectors(card& cardInfo, const uint8_t cardNumber, const cardKeys& authenticationKeys, const readOptions& options, sectorStatus& status) = 0;
+
     /// \brief
     /// Method to read a certain mifare classic page
     /// \details
@@ -267,6 +537,29 @@ public:
     /// @return statusCode  status of the operation
     virtual statusCode mifareAuthenticate(card&cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key) = 0;
 
+    /// \brief
+    /// Method to authenticate the sector of a page and read the page, without printing anything
+    /// \details
+    /// @param cardinfo     a card class where the card data can be stored in
+    /// @param cardNumber   card that needs to be read from
+    /// @param AorB         autenticate with key a or key b
+    /// @param pageNumber   pagenumber that needs to be read
+    /// @param key          pointer to key array that the sector needs to be autenticated with
+    /// @return statusCode  status of the operation
+    virtual statusCode mifareReadBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key) = 0;
+
+    /// \brief
+    /// Method to authenticate the sector of a page and write the page, without printing anything
+    /// \details
+    /// @param cardinfo     a card class of the card
+    /// @param cardNumber   card that needs to be written to
+    /// @param AorB         autenticate with key a or key b
+    /// @param pageNumber   pagenumber that needs to be written
+    /// @param key          pointer to key array that the sector needs to be autenticated with
+    /// @param data         the 16 bytes that need to be written
+    /// @return statusCode  status of the operation
+    virtual statusCode mifareWriteBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key, const uint8_t* data) = 0;
+
     /// \brief
     /// Abstract function to transform a given page ( pagenr ) to a valueblock.
     /// \details
@@ -329,6 +622,43 @@ public:
     /// @return statusCode  Status of the operation
     virtual statusCode mifareTransfer(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key) = 0;
 
+    /// \brief
+    /// Abstract function to increment or decrement a valueblock and read back its new value in one transaction
+    /// \details
+    /// The sector is authenticated, the value is incremented or decremented, transferred to the valueblock
+    /// and the valueblock is read back. When the transfer fails, the valueblock is restored and read again,
+    /// and compared with the value from before the transaction to find out whether the transfer has been written.
+    /// @param cardinfo     A card class where the card data can be stored in
+    /// @param cardNumber   Card that needs to be written to
+    /// @param AorB         Autenticate with key a or key b
+    /// @param pageNumber   Pagenumber of the valueblock
+    /// @param sector       Sector trailer block that needs to be authenticated
+    /// @param key          Pointer to key array that the sector trailer block needs to be autenticated with
+    /// @param operation    Incrementation or Decrementation
+    /// @param value        Value the valueblock needs to be incremented or decremented by
+    /// @param newValue     The value of the valueblock after the transaction, see the status
+    /// @return statusCode  pn532StatusOK: the value has been transferred, newValue holds it.
+    ///                     pn532StatusValueNotRead: the value has been transferred, but could not be read back. newValue is not set.
+    ///                     When the answer of the transfer was lost but the valueblock holds the new value, the status is OK as well.
+    ///                     pn532StatusValueRestored: the transfer did not reach the card, the valueblock holds its old value. newValue holds it.
+    ///                     pn532StatusRestoreFailed: the transfer failed and the valueblock is unknown, newValue is not set.
+    ///                     Any other status: the transaction failed before the transfer, the valueblock has not changed.
+    virtual statusCode mifareValueTransaction(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const mifareCommands operation, const uint32_t value, uint32_t& newValue) = 0;
+
+    /// \brief
+    /// Abstract function to read the value of a valueblock
+    /// \details
+    /// The value is stored in the identity of the card as well, the memory of the card is not needed for it.
+    /// @param cardinfo     A card class where the value is stored in
+    /// @param cardNumber   Card that needs to be read from
+    /// @param AorB         Autenticate with key a or key b
+    /// @param pageNumber   Pagenumber of the valueblock
+    /// @param sector       Sector trailer block that needs to be authenticated
+    /// @param key          Pointer to key array that the sector trailer block needs to be autenticated with
+    /// @param value        The value of the valueblock
+    /// @return statusCode  Status of the operation, pn532StatusInvalidValueBlock when the block is not a valueblock
+    virtual statusCode mifareReadValue(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, uint32_t& value) = 0;
+
 
 
 };
@@ -36,12 +36,150 @@
 namespace nfc
 {
     
+/// \brief
+/// Power states of the pn532 as seen by the driver
+/// \details
+///     unknown:        After start up or after a failed command. The chip is woken before the next command
+///     awake:          The chip answers commands without a wake up
+///     poweredDown:    The chip is in power down mode and needs a wake up
+enum class powerState : uint8_t {
+    unknown,
+    awake,
+    poweredDown
+};
+
+/// \brief
+/// Counters of responses that have been damaged on the bus
+struct linkStatistics {
+    uint_fast32_t checksumErrors    = 0;    // responses with a wrong LCS or DCS, or that could not be read
+    uint_fast32_t retransmits       = 0;    // NACKs that have been send
+    uint_fast32_t unrecovered       = 0;    // commands that failed because the response stayed damaged
+};
+
 /// \brief
 /// Implementation of the NFC class specificly for the pn532
 class PN532_chip : public NFC{
 private:
-    // buffer where the pn532's acknowlege 
+    // buffer where the pn532's acknowlege and the header of every other frame is stored in
     uint8_t ackBuffer[8] = {};
+
+    // buffer where the last received frame is stored in. receivedCommand points into this buffer
+    uint8_t frameBuffer[pn532::general::frameBufferSize] = {};
+    size_t  frameLength = 0;
+
+    /// Type of frame that has been read by readFrame()
+    enum class frameType : uint8_t { ack, nack, information, invalid };
+
+    /// \brief
+    /// Reads one frame from the pn532
+    /// \details
+    /// First the header is read. The header tells what kind of frame is send and how long it is,
+    /// so the rest of the frame is read with exactly the amount of bytes that is needed.
+    /// Normal and extended information frames are stored in frameBuffer, starting at LEN.
+    /// The header of an ACK frame is stored in ackBuffer.
+    /// The read is not ended, so call _protocol.endTransaction() afterwards.
+    /// @return frameType   Type of the frame that has been read
+    frameType readFrame();
+
+    // power state of the chip, so it is only woken up when needed
+    powerState              power = powerState::unknown;
+    uint_fast64_t           lastActivity = 0;
+    uint_fast32_t           idleTimeout = 1000;
+
+    /// \brief
+    /// Wakes the pn532 over the protocol when it is powered down, its state is unknown or it has been idle too long
+    void wakeIfNeeded();
+
+    // state of the asynchronous command
+    commandState            state = commandState::idle;
+    statusCode              commandStatus = statusCode::pn532StatusOK;
+    commandListener*        listener = nullptr;
+    uint_fast64_t           deadline = 0;
+    uint_fast32_t           responseTimeout = 0;    // time in ms the pn532 gets for the response, 0 is no timeout
+
+    // amount of NACKs that have been send for the response of the current command
+    uint8_t                 nacksSent = 0;
+    static const uint8_t    maxNacks = 3;
+    linkStatistics          linkStats;
+
+    /// \brief
+    /// Ends the asynchronous command with the given state and status and notifies the listener
+    void finish(const commandState newState, const statusCode status);
+
+    // generation of the Mifare authentication, see card::setSession(). Starts at 1, so a new card has no session
+    uint_fast32_t           sessionGeneration = 1;
+
+    /// \brief
+    /// Returns whether the last response ends the authentication of the card
+    /// \details
+    /// A Mifare error halts the card, a new selection, RF configuration, SAM configuration or power down resets it
+    bool endsSession() const;
+
+    /// \brief
+    /// Authenticates a block without printing anything
+    /// \details
+    /// When the sector of the block is still authenticated with the same key, nothing is send
+    /// @return statusCode  pn532StatusOK, the error of the card or the error of the transport
+    statusCode authenticateBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pageNumber, const uint8_t* key);
+
+    /// \brief
+    /// Reads a block into cardinfo without printing anything
+    /// \details
+    /// When block is given, the 16 bytes are also copied into it. So a card without memory can be used
+    /// @return statusCode  pn532StatusOK, the error of the card or the error of the transport
+    statusCode readBlock(card& cardinfo, const uint8_t cardNumber, const uint8_t pageNumber, uint8_t* block = nullptr);
+
+    /// \brief
+    /// Reads a valueblock, checks its format and stores the value in the identity of cardinfo
+    /// @return statusCode  pn532StatusOK, pn532StatusInvalidValueBlock or the error of the read
+    statusCode readValueBlock(card& cardinfo, const uint8_t cardNumber, const uint8_t pageNumber, uint32_t& value);
+
+    /// \brief
+    /// Sends a Mifare command with InDataExchange and checks the status the card has send back
+    /// @return statusCode  pn532StatusOK, the error of the card or the error of the transport
+    template<uint8_t n, uint8_t payloadSize>
+    statusCode dataExchange(const commandFrame<n, payloadSize>& frame)
+    {
+        auto [pass, response] = sendCommandAndCheckAck(frame);
+        if(pass != statusCode::pn532StatusOK) {return pass;}
+        if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
+        return statusCode::pn532StatusOK;
+    }
+
+    /// \brief
+    /// Stores the targets of an InListPassiveTarget response in cards
+    /// \details
+    /// Every target holds: Tg, SENS_RES (2), SEL_RES, NFCIDLength, NFCID and, for ISO/IEC14443-4 cards, the ATS
+    /// @return uint8_t     Amount of targets that have been stored
+    uint8_t parseTargets(const receivedCommand& response, card* const* cards, const uint8_t nCards);
+
+    /// \brief
+    /// Sends InSelect, InDeselect or InRelease for one target and checks its status
+    statusCode targetCommand(const uint8_t command, const uint8_t cardNumber);
+
+    /// \brief
+    /// Selects the card again after a Mifare error
+    /// \details
+    /// A Mifare Classic card halts after a failed authentication or read, and only answers again after it has been selected.
+    /// Up to two cards are listed, so a second card in the field stays in the session. The card with the UID of cardinfo
+    /// can get another target number, cardNumber is set to it.
+    /// @param  cardinfo    The card that has to be selected again
+    /// @param  cardNumber  Target number of the card, set to its new target number
+    /// @return statusCode  pn532StatusOK when the card is still in the field,
+    ///                     pn532StatusOtherCard when only other cards are in the field
+    statusCode reselectCard(const card& cardinfo, uint8_t& cardNumber);
+
+    /// \brief
+    /// Checks the serial link with a communication line test (diagnose echo)
+    /// \details
+    /// Unlike performSelftest(), the test is cancelled after a short timeout, because a link with
+    /// a wrong baudrate never answers
+    /// @return statusCode  pn532StatusOK when the echo came back unchanged
+    statusCode verifySerialLink();
+
+    // strategy used when no strategy is given to the constructor
+    communication::irqReady             defaultReady;
+    communication::readyStrategy&       ready;
    
 public:
     
@@ -62,6 +200,20 @@ public:
             hwlib::pin_in& irq
     );
 
+    /// \brief
+    /// Constructor for the pn532 NFC chip with a custom ready strategy
+    /// \details
+    /// Use this constructor when the chip's readiness should not be detected by polling the irq pin,
+    /// for example by using communication::statusReady when the irq pin is not connected.
+    /// @param _protocol    A protocol that the arduino can use to communicate with the pn532 chip
+    /// @param irq          Adress of the irq pin
+    /// @param ready        Strategy that is polled to find out whether the chip has a frame ready
+    PN532_chip(
+            communication::protocol& _protocol,
+            hwlib::pin_in& irq,
+            communication::readyStrategy& ready
+    );
+
 
     // ------------------------------------------------------------------------------- //   
     // Basic function(s)                                                               //
@@ -87,7 +239,7 @@ public:
     /// When called, this funciton will send n_bytes over the provided interface for the class
     /// @param commandBuffer    Pointer to the commandBuffer we want to send
     /// @param n_bytes          Amount of bytes that needs to be send 
-    void sendData(uint8_t* commandBuffer, const uint8_t nBytes) override;
+    void sendData(const uint8_t* commandBuffer, const size_t nBytes) override;
 
     /// \brief
     /// This function gets data from the pn532 over the provided interface
@@ -95,7 +247,7 @@ public:
     /// When called, this funciton will get n_bytes over the provided interface for the class
     /// @param buffer       Pointer to the buffer we want to store received data in
     /// @param n_bytes      Amount of bytes that needs to be read
-    void getData(uint8_t* buffer, const uint8_t nBytes) override ;
+    void getData(uint8_t* buffer, const size_t nBytes) override ;
 
     /// \brief
     /// This function is used to overwrite the content of a internal register of the pn532
@@ -167,6 +319,8 @@ public:
     /// \brief
     /// This function checks wether the pn532 has responded within the given timeout
     /// \details
+    /// The ready strategy is polled until it reports ready or until the deadline has passed.
+    /// The deadline is based on hwlib::now_ticks(), so the chip is detected as soon as it is ready.
     /// Will return false if the pn532 didnt respond in time
     /// @param timeout          Maximum time the arduino needs to wait for a response of the pn532 
     /// @return true            Chip responded in time
@@ -192,10 +346,63 @@ public:
     /// It waits till the chip responds
     /// It checks if the pn532 has send an ACKnowlege frame
     /// It waits again till the chip is ready to to send data to the host controller
+    /// It reads the header of the response and then exactly the amount of bytes the header announces
+    /// @note   The response points into a buffer of this class and is only valid until the next command
     /// @param command      Command that needs to be send
     /// @return statusCode  Status of the operation
     Result sendCommandAndCheckAck(setupSendCommand &command) override;
 
+    /// \brief
+    /// Function that handles the complete communication for a command that is send as a list of segments
+    /// \details
+    /// Works the same as the function above, but the segments are streamed over the protocol one after another.
+    /// This is the blocking version of submit(): it waits for the chip and polls until the command is done.
+    /// Precomputed frames (see nfc::pn532::frames) are send with this function without being copied.
+    /// @param segments     Pointer to the first segment of the command frame
+    /// @param count        Amount of segments
+    /// @return statusCode  Status of the operation
+    Result sendCommandAndCheckAck(const communication::segment* segments, const size_t count) override;
+    using NFC::sendCommandAndCheckAck;
+
+
+    // ------------------------------------------------------------------------------- //
+    // Asynchronous command functions                                                  //
+    // ------------------------------------------------------------------------------- //
+
+    /// \brief
+    /// This function sends a command to the pn532 without waiting for it
+    /// \details
+    /// The chip gets 2 seconds to acknowledge the command and another 2 seconds to send its response,
+    /// the same timeouts the blocking functions use.
+    /// @param segments     Pointer to the first segment of the command frame
+    /// @param count        Amount of segments
+    /// @param listener     Optional listener that is notified from within poll()
+    /// @return statusCode  pn532StatusBusy when a command is still in progress, pn532StatusInvalidParameter when the frame
+    ///                     is empty or longer than commandBufferSize (nothing is send), otherwise pn532StatusOK
+    statusCode submit(const communication::segment* segments, const size_t count, commandListener* listener = nullptr) override;
+    using NFC::submit;
+
+    /// \brief
+    /// This function asks the ready strategy once whether the pn532 has a frame ready and reads it if so
+    /// \details
+    /// When the ACK frame is read, the state goes to waitingForResponse. When the response is read the state goes to done.
+    /// An invalid frame or a passed deadline makes the state go to failed.
+    /// @return commandState    State of the command after the check
+    commandState poll() override;
+
+    /// \brief
+    /// This function returns the result of the last command
+    /// \details
+    /// @return Result[0]   Statuscode of the command. pn532StatusBusy when it is still in progress
+    /// @return Result[1]   The response of the pn532, pointing into the receive buffer of this class
+    Result fetch() override;
+
+    /// \brief
+    /// This function aborts the command that is in progress by sending an ACK frame to the pn532
+    /// \details
+    /// User manual p.31    section 6.2.1.3
+    void cancel() override;
+
 
     // ------------------------------------------------------------------------------- //   
     // More advanced functions                                                         //
@@ -245,12 +452,62 @@ public:
     /// @return true        A card has been detected
     bool detectCard(card& cardinfo, const uint8_t nCards, const uint8_t cardtype) override;
 
+    /// \brief
+    /// Method for the pn532 to poll for a card with InAutoPoll and wait for the answer
+    /// \details
+    /// @param  cardinfo    Card class where the UID of the found card is stored in
+    /// @param  options     Amount of polls, period and target types
+    /// @return bool        Wether a card has been found
+    bool autoPoll(card& cardinfo, const autoPollOptions& options) override;
+
+    /// \brief
+    /// Method for the pn532 to start InAutoPoll without waiting for the answer
+    /// \details
+    /// The response timeout is set to the time the pn532 needs for all polls, or switched off when it polls forever.
+    /// @param  options     Amount of polls, period and target types
+    /// @param  listener    Optional listener that is notified when the chip has found a card
+    /// @return statusCode  Status of the submit
+    statusCode startAutoPoll(const autoPollOptions& options, commandListener* listener = nullptr) override;
+
+    /// \brief
+    /// Method that stores the UID of the card that InAutoPoll has found in cardinfo
+    /// \details
+    /// The UID, ATQA, SAK and target number of the first target are stored. Only 106 kbps type A targets have a UID,
+    /// for other targets or a response that is too short cardinfo is not changed.
+    /// @param  cardinfo    Card class where the UID of the found card is stored in
+    /// @return bool        Wether a type A card has been found and stored in cardinfo
+    bool getAutoPollTarget(card& cardinfo) override;
+
+    /// \brief
+    /// Method for the pn532 to detect up to two cards that are in the RF field at the same time
+    /// \details
+    /// Both cards get their UID and target number, so they can be served one after the other without polling again
+    /// @param  cards       Array of at least nCards pointers to card classes
+    /// @param  nCards      Maximum amount of cards that needs to be detected (1 or 2)
+    /// @param  cardtype    Type of card that needs to be read
+    /// @return uint8_t     Amount of cards that have been found
+    uint8_t detectCards(card* const* cards, const uint8_t nCards, const uint8_t cardtype) override;
+    using NFC::detectCards;
+
     /// \brief 
     /// Metod so the pn532 can select a specific card if multiple cards are present within the RF field
     /// \details
-    /// @note   This function is not yet implemented, hence it will return a statusOK
+    /// Uses InSelect. The card that was selected before is deselected, so it loses its authentication
+    /// @param  cardNumber  Target number of the card
+    /// @return statusCode  Status of the operation
+    statusCode selectCard(const uint8_t cardNumber) override;
+
+    /// \brief
+    /// Method for the pn532 to deselect a card with InDeselect
+    /// @param  cardNumber  Target number of the card, 0 for all cards
     /// @return statusCode  Status of the operation
-    statusCode selectCard() override {return statusCode::pn532StatusOK;}
+    statusCode deselectCard(const uint8_t cardNumber) override;
+
+    /// \brief
+    /// Method for the pn532 to release a card with InRelease
+    /// @param  cardNumber  Target number of the card, 0 for all cards
+    /// @return statusCode  Status of the operation
+    statusCode releaseCard(const uint8_t cardNumber) override;
 
     /// \brief
     /// This function is used to select the data flow path by configuring the internal serial data switch
@@ -292,9 +549,49 @@ public:
     /// \brief
     /// This function is used to select te baud rate on the serial link between the host controller and the pn532
     /// \details
+    /// Over HSU the complete switch is negotiated:
+    ///     - SetSerialBaudRate is send, the pn532 answers with ACK and response at the old baud rate
+    ///     - the host sends an ACK frame, after which the pn532 switches
+    ///     - the host switches its uart and verifies the link with a communication line test
+    /// When the verification fails, the host goes back to the old baud rate and verifies again.
+    /// Over spi and i2c only the command is send.
     /// @param  br          New baud rate
-    /// @return statusCode  Status of the operation
+    /// @return statusCode  Status of the operation, pn532StatusBaudrateFallback when the old baud rate is used again
     statusCode setSerialBaudrate(const nfc::baudRate br) override;
+
+    /// \brief
+    /// This function puts the pn532 in power down mode
+    /// \details
+    /// The pn532 stays in power down until one of the enabled sources wakes it. The next command will
+    /// wake the chip over the protocol first, so make sure the source of the protocol is enabled.
+    /// Source:  https://www.nxp.com/docs/en/user-guide/141520.pdf 
+    /// P. 98    section 7.2.11
+    /// @param  wakeUpEnable    Combination of nfc::pn532::command::wakeUpSource values
+    /// @return statusCode      Status of the operation
+    statusCode powerDown(const uint8_t wakeUpEnable) override;
+
+    /// \brief
+    /// This function sets after how much time without communication the chip is woken up again before a command
+    /// \details
+    /// The pn532 only needs a wake up after power down, or when it may have lost its state (for example a reset).
+    /// A timeout of 0 wakes the chip before every command.
+    /// @param  timeout     Idle time in ms
+    void setIdleTimeout(const uint_fast32_t timeout){ idleTimeout = timeout; }
+
+    /// \brief
+    /// Returns the power state the driver assumes the pn532 is in
+    powerState getPowerState() const { return power; }
+
+    /// \brief
+    /// Returns the counters of damaged responses
+    /// \details
+    /// A response with a wrong LCS or DCS is asked again with a NACK, at most 3 times per command.
+    /// The command itself is not executed again, so an authentication or value operation is never repeated.
+    const linkStatistics& getLinkStatistics() const { return linkStats; }
+
+    /// \brief
+    /// Resets the counters of damaged responses
+    void resetLinkStatistics(){ linkStats = linkStatistics(); }
     
 
     // ------------------------------------------------------------------------------- //
@@ -305,6 +602,7 @@ public:
     /// Method for the pn532 to read a mifare classic card
     /// \details
     /// This method is used to read any mifare classic card (1k / 4K);
+    /// Every sector is read with mifareReadSectors(), the card data is not printed.
     /// @param  cardInfo    A card class where the card data can be stored in
     /// @param  cardNumber  Card that needs to be read from
     /// @param  cardNumber  Card that needs to be read
@@ -313,6 +611,19 @@ public:
     /// @return statusCode  Status of the operation
     statusCode mifareReadCard(card& cardInfo, const uint8_t cardNumber, const mifareCommands AorB, const cardKeys& authenticationKeys) override;
 
+    /// \brief
+    /// Method for the pn532 to read a chosen set of sectors of a mifare classic card
+    /// \details
+    /// Every sector costs one authentication and three or four reads. After a failed authentication
+    /// the card is selected again, so the next sector or key can be tried.
+    /// @param  cardInfo    A card class where the card data can be stored in
+    /// @param  cardNumber  Card that needs to be read
+    /// @param  cardKeys    Struct to the sector trailer keys of the card
+    /// @param  options     Sectors to read, key to use and what to do when authentication fails
+    /// @param  status      Status of every sector
+    /// @return statusCode  Status of the first sector that failed
+    statusCode mifareReadSectors(card& cardInfo, const uint8_t cardNumber, const cardKeys& authenticationKeys, const readOptions& options, sectorStatus& status) override;
+
     /// \brief
     /// Method for the pn532 to read a certain mifare classic page
     /// \details
@@ -335,6 +646,8 @@ public:
     /// \brief
     /// Method for the pn532 to authenticate a certain sector trailer block of a mifare classic card
     /// \details
+    /// The authentication is remembered in cardinfo. When the sector is still authenticated with the same key,
+    /// nothing is send. This also counts for the value functions (increment, decrement and transfer).
     /// @param  cardinfo    A card class where the card data can be stored in
     /// @param  cardNumber  Card that needs to be written to
     /// @param  AorB        Autenticate with key a or key b
@@ -343,6 +656,31 @@ public:
     /// @return statusCode  Status of the operation
     statusCode mifareAuthenticate(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key) override;
 
+    /// \brief
+    /// Method for the pn532 to authenticate the sector of a page and read the page, without printing anything
+    /// \details
+    /// Costs one read, and one authentication when the sector is not authenticated with this key yet
+    /// @param  cardinfo    A card class where the card data can be stored in
+    /// @param  cardNumber  Card that needs to be read from
+    /// @param  AorB        Autenticate with key a or key b
+    /// @param  pageNumber  Pagenumber that needs to be read
+    /// @param  key         Pointer to key array that the sector needs to be autenticated with
+    /// @return statusCode  Status of the operation
+    statusCode mifareReadBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key) override;
+
+    /// \brief
+    /// Method for the pn532 to authenticate the sector of a page and write the page, without printing anything
+    /// \details
+    /// Costs one write, and one authentication when the sector is not authenticated with this key yet
+    /// @param  cardinfo    A card class of the card
+    /// @param  cardNumber  Card that needs to be written to
+    /// @param  AorB        Autenticate with key a or key b
+    /// @param  pageNumber  Pagenumber that needs to be written
+    /// @param  key         Pointer to key array that the sector needs to be autenticated with
+    /// @param  data        The 16 bytes that need to be written, send straight from data
+    /// @return statusCode  Status of the operation
+    statusCode mifareWriteBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key, const uint8_t* data) override;
+
     /// \brief
     /// This function will transform a given page ( pagenr ) to a valueblock.
     /// \details
@@ -405,6 +743,49 @@ public:
     /// @param key          Pointer to key array that the sector trailer block needs to be autenticated with
     /// @return statusCode  Status of the operation
     statusCode mifareTransfer(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key) override;
+
+    /// \brief
+    /// Method for the pn532 to increment or decrement a valueblock and read back its new value
+    /// \details
+    /// Costs one authentication (none when the sector is still authenticated), the value command, the transfer and one read.
+    /// The value before the transaction is needed to undo a failed transfer. It is read first, unless the identity of
+    /// cardinfo already holds the value of the valueblock.
+    /// When the transfer fails, the card is selected again, the valueblock is written back with Restore and Transfer and read again.
+    /// A transfer of which only the answer has been lost has been written, so the valueblock then holds the new value:
+    /// this is told apart from a transfer that did not reach the card by comparing it with the value from before.
+    /// @param cardinfo     A card class where the card data can be stored in
+    /// @param cardNumber   Card that needs to be written to
+    /// @param AorB         Autenticate with key a or key b
+    /// @param pageNumber   Pagenumber of the valueblock
+    /// @param sector       Sector trailer block that needs to be authenticated
+    /// @param key          Pointer to key array that the sector trailer block needs to be autenticated with
+    /// @param operation    Incrementation or Decrementation
+    /// @param value        Value the valueblock needs to be incremented or decremented by
+    /// @param newValue     The value of the valueblock after the transaction, see the status
+    /// @return statusCode  pn532StatusOK: the value has been transferred, newValue holds it.
+    ///                     pn532StatusValueNotRead: the value has been transferred, but could not be read back. newValue is not set.
+    ///                     When the answer of the transfer was lost but the valueblock holds the new value, the status is OK as well.
+    ///                     pn532StatusValueRestored: the transfer did not reach the card, the valueblock holds its old value.
+    ///                     newValue holds that value.
+    ///                     pn532StatusRestoreFailed: the transfer failed and the valueblock could not be read again, or holds
+    ///                     neither the old nor the new value. newValue is not set. The card has to be selected again before it can be read.
+    ///                     Any other status: the transaction failed before the transfer, the valueblock has not changed.
+    statusCode mifareValueTransaction(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const mifareCommands operation, const uint32_t value, uint32_t& newValue) override;
+
+    /// \brief
+    /// Method for the pn532 to read the value of a valueblock
+    /// \details
+    /// Costs one authentication (none when the sector is still authenticated) and one read, nothing is printed.
+    /// The value is also stored in the identity of cardinfo, so cardinfo can be a card without memory.
+    /// @param cardinfo     A card class where the value is stored in
+    /// @param cardNumber   Card that needs to be read from
+    /// @param AorB         Autenticate with key a or key b
+    /// @param pageNumber   Pagenumber of the valueblock
+    /// @param sector       Sector trailer block that needs to be authenticated
+    /// @param key          Pointer to key array that the sector trailer block needs to be autenticated with
+    /// @param value        The value of the valueblock
+    /// @return statusCode  Status of the operation, pn532StatusInvalidValueBlock when the block is not a valueblock
+    statusCode mifareReadValue(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, uint32_t& value) override;
 };
 
 
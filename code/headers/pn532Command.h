@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief    This file contains two data objects that handle and trim the outgoing and received commands of a pn532
+ * @brief    This file contains the data objects that handle and trim the outgoing and received commands of a pn532
  * 
  * This file provides data objects that help standardize the received pn532 commands to a fixed format.
  * Normally, the pn532 sends a frame to the host controller with information in response to a command send. However,
@@ -19,8 +19,11 @@
  *  - DCS               = Packed data Checksum
  *  - 0x00              = Postamble (end of a command)
  * 
+ * Frames that do not fit in a normal frame use the extended frame format, where LEN and LCS are 0xFF
+ * and are followed by a 16 bit length (LENM, LENL) and its checksum (LCS).
+ * 
  * For more detailled information, please refer to the user manual:
- * https://www.nxp.com/docs/en/user-guide/141520.pdf    P. 28  - 6.2.1.1
+ * https://www.nxp.com/docs/en/user-guide/141520.pdf    P. 28  - 6.2.1.1 and P. 29 - 6.2.1.2
  * 
  * @author    Nathan Houwaart
  * @license   See LICENSE
@@ -32,25 +35,39 @@
 #include "../../hwlib/library/hwlib.hpp"
 #include "declarations.h"
 
+namespace communication{
+
+/// \brief
+/// One piece of data that is send as part of a larger transfer
+/// \details
+/// A command can be send as a list of segments, for example a precomputed header, the caller's payload
+/// and the checksum. The protocol sends them in one transaction, so the segments never need to be copied into one buffer.
+struct segment{
+    const uint8_t*  data;
+    size_t          length;
+};
+
+} // namespace communication
 
 /// \brief
 /// setupSendCommand
 /// \details
 /// This is a data object that manages te setup of a send command for the pn532
-/// A commandBuffer can be up to 64 bytes long
+/// A command can be up to 264 bytes long. Commands longer than 254 bytes are send as an extended frame
 /// The appropriate constructors and operators are provided.
 class setupSendCommand {
 public:
-    uint8_t length;
-    uint8_t startCommand = 4;
-    uint8_t finalbuffer[64];
+    uint16_t length;
+    uint16_t startCommand = 4;
+    uint8_t finalbuffer[nfc::pn532::general::commandBufferSize];
     
     /// \brief
     /// Constructor for setupSendCommand
     /// \details
     /// This constructor manages the proper layout for a command that can be send to the pn532.
     /// It will add preambles, calculate the checksums, and calculate the proper commandsize.
-    setupSendCommand(const uint8_t* commandsToSend, uint8_t commandSize);
+    /// A command longer than 264 bytes is not build: length is then 0, and the frame is refused when it is send.
+    setupSendCommand(const uint8_t* commandsToSend, uint16_t commandSize);
 
     /// \brief
     /// Function to calculate the checksum of a command.
@@ -58,34 +75,169 @@ public:
     /// The pn532 will use the 
     /// This function will calculate the cecksum by adding all commands to each other.
     /// The checksum will be inverted and 1 will be added for the correct checksum
-    uint8_t calculateChecksum(const uint8_t* buffer, int index, uint8_t n);
+    uint8_t calculateChecksum(const uint8_t* buffer, int index, uint16_t n);
+};
+
+/// \brief
+/// commandFrame
+/// \details
+/// This is a data object that holds a complete pn532 command frame that is build at compile time.
+/// The preamble, LEN, LCS, TFI, command bytes and DCS are computed by the constexpr constructor, so a
+/// constexpr commandFrame is stored in flash and can be send without any runtime work.
+///
+/// Command bytes that depend on runtime values are patched with set(), which updates the DCS incrementally.
+///
+/// A frame can also carry payloadSize bytes that are not stored in the frame, such as the 16 bytes of a write
+/// command. The payload is then send straight from the caller's buffer, between the command bytes and the DCS.
+/// @tparam n               Amount of command bytes, including the command code
+/// @tparam payloadSize     Amount of payload bytes that follow the command bytes
+template<uint8_t n, uint8_t payloadSize = 0>
+class commandFrame {
+    static_assert(n + payloadSize < 0xFF, "commandFrame only builds normal frames, use setupSendCommand for extended frames");
+
+public:
+    static constexpr uint8_t headerSize = n + 5;    // start code, LEN, LCS, TFI and the command bytes
+
+    uint8_t finalbuffer[headerSize + 1];            // the last byte is the DCS over TFI and the command bytes
+    uint8_t dcs = 0;                                // DCS over TFI, the command bytes and the payload
+
+    /// \brief
+    /// Constructor for commandFrame
+    /// \details
+    /// @param  commands    The command code followed by its parameters
+    constexpr commandFrame(const uint8_t (&commands)[n]): finalbuffer{}
+    {
+        finalbuffer[0] = nfc::pn532::general::Preamble1;
+        finalbuffer[1] = nfc::pn532::general::Preamble2;
+        finalbuffer[2] = n + payloadSize + 1;
+        finalbuffer[3] = static_cast<uint8_t>(~finalbuffer[2] + 1);
+        finalbuffer[4] = nfc::pn532::general::HostToPn532;
+        uint8_t sum = finalbuffer[4];
+        for(uint8_t i = 0; i < n; i++){
+            finalbuffer[5 + i] = commands[i];
+            sum += commands[i];
+        }
+        finalbuffer[headerSize] = static_cast<uint8_t>(~sum + 1);
+    }
+
+    /// \brief
+    /// Returns command byte index. Index 0 is the command code
+    constexpr uint8_t get(const uint8_t index) const { return finalbuffer[5 + index]; }
+
+    /// \brief
+    /// Overwrites command byte index and updates the DCS with the difference
+    /// \details
+    /// @param  index       Index of the command byte. Index 0 is the command code
+    /// @param  value       New value of the command byte
+    constexpr void set(const uint8_t index, const uint8_t value)
+    {
+        uint8_t &byte = finalbuffer[5 + index];
+        finalbuffer[headerSize] += byte - value;
+        byte = value;
+    }
+
+    /// \brief
+    /// Overwrites size command bytes, starting at index
+    constexpr void set(const uint8_t index, const uint8_t* values, const uint8_t size)
+    {
+        for(uint8_t i = 0; i < size; i++){ set(index + i, values[i]); }
+    }
+
+    /// \brief
+    /// Returns the complete frame as one segment. Only for frames without a payload
+    communication::segment segment() const
+    {
+        static_assert(payloadSize == 0, "a frame with a payload is send with segments()");
+        return communication::segment{finalbuffer, sizeof(finalbuffer)};
+    }
+
+    /// \brief
+    /// Adds the payload to the DCS and returns the header, payload and DCS segments
+    /// \details
+    /// @param  payload     Pointer to payloadSize bytes that are send after the command bytes
+    /// @param  out         Array where the three segments are stored in
+    void segments(const uint8_t* payload, communication::segment (&out)[3])
+    {
+        uint8_t sum = 0;
+        for(uint8_t i = 0; i < payloadSize; i++){ sum += payload[i]; }
+        dcs = finalbuffer[headerSize] - sum;
+
+        out[0] = communication::segment{finalbuffer, headerSize};
+        out[1] = communication::segment{payload, payloadSize};
+        out[2] = communication::segment{&dcs, 1};
+    }
 };
 
 /// \brief
 /// ReceiveCommand
 /// \details
-/// This data object manages the received command from a pn532. 
-/// The command buffer can be up to 64 bytes long.
+/// This data object gives access to a frame the pn532 has send to the host controller.
+/// The frame is not copied: finalBuffer points to the receive buffer of the chip class,
+/// so the content is only valid until the next command is send to the chip.
+/// The frame always has the same layout, whatever interface or frame type (normal or extended) has been used:
+///
+///  LEN, LCS, TFI, PD0, PD1, PDn, DCS, 0x00
+///
+/// For an extended frame LEN holds the low byte of the length.
 /// The appropriate constructors and operators are provided
 class receivedCommand{
 public:
-    uint8_t length;
+    size_t length;
     bool isSucces;
-    uint8_t finalBuffer[64];
+    const uint8_t* finalBuffer;
 
     /// \brief
     /// Default constructor for a received command
     /// \details
-    /// Since no command has been received, isSucces will be false
-    receivedCommand():length(0),isSucces(false){};
+    /// Since no command has been received, isSucces will be false and finalBuffer points to an empty frame
+    receivedCommand();
 
     /// \brief
     /// Constructor for receivedCommand
     /// \details
-    /// This constructor manages the proper layout for a command that the pn532 has send to the host controller.
-    /// It will check wether the command has been succesfully received.
-    /// It will remove preambles and trim the command to the correct size
-    receivedCommand(const uint8_t* receiveBufferP, uint8_t bufferSize);
+    /// isSucces is only true when the LCS and the DCS of the frame are correct
+    /// @param  frame       Pointer to a frame that starts at LEN (preamble and start code removed)
+    /// @param  length      Length of the frame: the (extended) LEN + 4
+    receivedCommand(const uint8_t* frame, size_t length);
 };
 
+namespace nfc{
+namespace pn532{
+
+/// \brief
+/// Precomputed command frames
+/// \details
+/// Commands without parameters, and the parameters this library uses most, are build at compile time.
+/// Commands with parameters copy their frame and patch the parameters with commandFrame::set().
+namespace frames{
+    inline constexpr commandFrame<9> performSelftest({command::PerformSelftest, command::diagnose::CommunicationLineTest,
+                                                      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+    inline constexpr commandFrame<1> GetFirmwareVersion({command::GetFirmwareVersion});
+    inline constexpr commandFrame<1> getGeneralStatus({command::getGeneralStatus});
+    inline constexpr commandFrame<1> readGPIO({command::readGPIO});
+    inline constexpr commandFrame<2> SAMConfiguration({command::SAMConfiguration, command::SAMmode::Normal_mode});
+    inline constexpr commandFrame<3> RFFieldOn({command::RFConfiguration, command::RFItem::RFField, 0x01});
+    inline constexpr commandFrame<3> RFFieldOff({command::RFConfiguration, command::RFItem::RFField, 0x00});
+    inline constexpr commandFrame<5> setMaxRetries({command::RFConfiguration, command::RFItem::MaxRetries, 0xFF, 0xFF, 0xFF});
+    inline constexpr commandFrame<3> InListPassiveTarget({command::InListPassiveTarget, 0x01, command::TypeA_ISO_IEC14443});
+    inline constexpr commandFrame<4> InAutoPoll({command::InAutoPoll, 0x01, 0x01, command::autoPoll::Mifare});
+    inline constexpr commandFrame<2> InSelect({command::InSelect, 0x01});
+    inline constexpr commandFrame<2> InDeselect({command::InDeselect, 0x01});
+    inline constexpr commandFrame<2> InRelease({command::InRelease, 0x01});
+    inline constexpr commandFrame<3> readRegister({command::readRegister, 0x00, 0x00});
+    inline constexpr commandFrame<4> writeRegister({command::writeRegister, 0x00, 0x00, 0x00});
+    inline constexpr commandFrame<3> writeGPIO({command::writeGPIO, 0x00, 0x00});
+    inline constexpr commandFrame<2> setSerialBaudrate({command::setSerialBaudrate, 0x00});
+    inline constexpr commandFrame<2> PowerDown({command::PowerDown, 0x00});
+    inline constexpr commandFrame<4> mifareRead({command::InDataExchange, 0x01, mifareCommands::Read16Bytes, 0x00});
+    inline constexpr commandFrame<4, 16> mifareWrite({command::InDataExchange, 0x01, mifareCommands::Write16Bytes, 0x00});
+    inline constexpr commandFrame<14> mifareAuthenticate({command::InDataExchange, 0x01, mifareCommands::authenticateKeyA, 0x00,
+                                                          0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00});
+    inline constexpr commandFrame<8> mifareValue({command::InDataExchange, 0x01, mifareCommands::Incrementation, 0x00, 0x00, 0x00, 0x00, 0x00});
+    inline constexpr commandFrame<4> mifareTransfer({command::InDataExchange, 0x01, mifareCommands::Transfare, 0x00});
+} // namespace frames
+
+} // namespace pn532
+} // namespace nfc
+
 #endif //V1_OOPC_18_NATHANHOUWAART_PN532COMMAND_H
@@ -0,0 +1,236 @@
+/**
+ * @file
+ * @brief     Software stand-in for a pn532 that can be used instead of a real bus
+ *
+ * This file provides a protocol implementation that does not talk to a chip, but emulates one.
+ * It answers the commands of the nfc library the same way a pn532 with one (or two) Mifare Classic 1k
+ * cards in its RF field would. It also drives a fake irq pin, so the complete PN532_chip class can be
+ * used and benchmarked on a host without any hardware.
+ *
+ * The emulator delivers the frames the same way the protocol implementations do: a read starts
+ * at the preamble of the next frame and can be continued with receiveMore until endTransaction.
+ * Every byte that is send or received is counted, so the bus load of a command can be measured.
+ *
+ * A NACK of the host makes the emulator send its last response again, without executing the command again.
+ *
+ * The emulator keeps the timing of a real chip: the ACK frame and the response only become
+ * available after ackDelay and responseDelay microseconds. Commands that need the RF field
+ * (InListPassiveTarget, InDataExchange, InAutoPoll) take rfDelay microseconds longer.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_PN532EMULATOR_H
+#define V1_OOPC_18_NATHANHOUWAART_PN532EMULATOR_H
+
+#include "interface.h"
+#include "mifareClassic.h"
+
+namespace communication{
+
+/// \brief
+/// Emulated pn532 that implements the abstract protocol class
+class pn532Emulator : public protocol
+{
+public:
+
+    /// \brief
+    /// Fake irq pin that is driven by the emulator
+    /// \details
+    /// The pin reads low as soon as the emulator has a frame ready for the host, just like the real irq pin
+    class irqPin : public hwlib::pin_in
+    {
+    private:
+        pn532Emulator &chip;
+
+    public:
+        irqPin(pn532Emulator &chip): chip(chip){}
+
+        bool read() override { return !chip.frameReady(); }
+    };
+
+    /// \brief
+    /// Counters that show how the emulated chip has been used
+    struct statistics{
+        uint_fast32_t commands          = 0;
+        uint_fast32_t bytesSent         = 0;
+        uint_fast32_t bytesReceived     = 0;
+        uint_fast32_t statusReads       = 0;
+        uint_fast32_t wakeUps           = 0;
+        uint_fast32_t authentications   = 0;
+        uint_fast32_t nacks             = 0;
+    };
+
+    irqPin          irq;
+    statistics      stats;
+
+    uint_fast32_t   ackDelay        = 250;      // time in us before the ACK frame is ready
+    uint_fast32_t   responseDelay   = 1000;     // time in us between the ACK frame and the response
+    uint_fast32_t   rfDelay         = 3000;     // extra time in us for commands that use the RF field
+    uint_fast32_t   wakeUpDelay     = 2000;     // time in us a wake up takes, the same as the spi wake up pulse
+
+    /// \brief
+    /// Emulated Mifare Classic card, a Mini, 1k or 4k with a 4, 7 or 10 byte UID
+    struct emulatedCard{
+        bool        present             = false;
+        uint8_t     uid[card::maxUIDsize] = {};
+        uint8_t     uidLength           = 4;
+        uint8_t     sak                 = 0x08;
+        uint8_t     atqa                = 0x04;     // second byte of SENS_RES, the first is 0x00
+        uint8_t     sectors             = 16;
+        uint8_t     memory[mifare4kGeometry.size()] = {};
+        uint8_t     authenticatedSector = 0xFF;
+        bool        halted              = false;    // the card has halted after an error, until it is selected again
+        uint32_t    valueRegister       = 0;
+
+        /// \brief
+        /// Formats the card as a fresh Mifare Classic card with transport keys (0xFF)
+        /// \details
+        /// @param  newUid      UID of the card
+        /// @param  length      Length of the UID: 4, 7 or 10 bytes
+        /// @param  geometry    mifareMiniGeometry, mifare1kGeometry or mifare4kGeometry
+        void format(const uint8_t *newUid, uint8_t length = 4, const cardGeometry& geometry = mifare1kGeometry);
+    };
+
+    static const uint8_t maxCards = 2;
+
+    emulatedCard    cards[maxCards];            // cards[0] is in the RF field, cards[1] can be put in the field next to it
+    bool            failTransfer    = false;    // the next Transfer fails, like a card that is pulled away during the write
+    bool            loseTransferAnswer = false; // the next Transfer is written, but its answer is lost, like a card that is pulled away right after the write
+    uint_fast32_t   damageResponses = 0;        // the next responses get a flipped bit, like noise on the bus. A NACK sends them again undamaged
+
+    uint_fast32_t   serialBaudrate  = 115200;   // baudrate of the HSU link, only used by pn532EmulatorPty
+    bool            failBaudrateSwitch = false; // the next SetSerialBaudrate is answered, but the chip keeps its old baudrate
+
+    /// \brief
+    /// Constructor of the emulator
+    /// \details
+    /// Both emulated cards are freshly formatted, only the first one is in the RF field
+    pn532Emulator();
+
+    /// \brief
+    /// Wakes the emulated chip from power down
+    /// \details
+    /// Takes wakeUpDelay microseconds, like the wake up of a real protocol.
+    /// While the emulated chip is powered down, it ignores every command.
+    void wakeUp() override;
+
+    /// \brief
+    /// Takes a command frame, answers it and schedules the ACK and response frames
+    /// \details
+    /// Both normal and extended command frames are accepted
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+    using protocol::sendData;
+
+    /// \brief
+    /// Starts reading the next frame of the emulated chip
+    /// \details
+    /// When no frame is ready, or when more bytes are requested than the frame holds, 0x00 is returned
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// Continues reading the frame that has been started by receiveData
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// Status read of the emulated chip. Counts as a bus transaction
+    bool isReady() override;
+
+    /// \brief
+    /// Returns whether the emulated chip has a frame ready, without using the bus
+    bool frameReady() const;
+
+    /// \brief
+    /// Returns the time (hwlib::now_us) the next frame of the emulated chip is ready, 0 when no frame is pending
+    uint_fast64_t nextFrameAt() const;
+
+    /// \brief
+    /// Returns whether a SetSerialBaudrate has been answered and waits for the ACK of the host
+    /// \details
+    /// The emulated chip changes serialBaudrate when the host has acknowledged the response
+    bool baudrateSwitchPending() const { return pendingBaudrate != 0; }
+
+    /// \brief
+    /// Takes the card out of the RF field and lets it enter the field again after the given time
+    /// \details
+    /// InListPassiveTarget waits for the card (like a pn532 with MaxRetries 0xFF) and InAutoPoll
+    /// answers at the first poll after the card has entered the field.
+    /// @param  us  Time in us after which the card enters the RF field
+    void presentCardAfter(uint_fast32_t us);
+
+    /// \brief
+    /// Resets all counters
+    void resetStatistics(){ stats = statistics(); }
+
+private:
+    uint8_t         response[nfc::pn532::general::frameBufferSize + 6] = {};
+    uint16_t        responseLength  = 0;
+    uint16_t        damagedByte     = 0;        // byte of the response that has been damaged, 0 when it is intact
+    bool            ackPending      = false;
+    bool            responsePending = false;
+    uint_fast64_t   ackReadyAt      = 0;
+    uint_fast64_t   responseReadyAt = 0;
+
+    const uint8_t  *readFrame       = nullptr;  // frame that is being read by the host
+    size_t          readLength      = 0;
+    size_t          readOffset      = 0;
+
+    bool            poweredDown     = false;
+    bool            powerDownPending = false;   // power down after the response has been read
+
+    uint_fast32_t   pendingBaudrate = 0;        // baudrate of an answered SetSerialBaudrate, 0 when there is none
+
+    uint_fast64_t   cardArrivesAt   = 0;        // time cards[0] enters the RF field, 0 when no card is on its way
+
+    // the targets the emulated pn532 has listed. Target number Tg is card targets[Tg - 1], released targets are 0xFF
+    uint8_t         targets[maxCards] = {};
+    uint8_t         targetCount     = 0;
+    uint8_t         selectedTarget  = 0;        // target the pn532 talks to, 0 when none
+
+    /// \brief
+    /// Returns whether cards[0] is in the RF field
+    bool cardInField();
+
+    /// \brief
+    /// Returns the card of a listed target and makes it the selected target
+    /// \details
+    /// When another target was selected, the pn532 halts that card and wakes this one, so both lose their authentication
+    /// @return emulatedCard*   The card, nullptr when the target is not listed
+    emulatedCard* target(uint8_t tg);
+
+    /// \brief
+    /// Lists up to maxTargets cards that are in the field and stores NbTg and their target data in out
+    uint16_t listTargets(uint8_t maxTargets, uint8_t *out);
+
+    /// \brief
+    /// Executes InAutoPoll and schedules its response
+    uint16_t autoPoll(const uint8_t *command, uint16_t n, uint8_t *out);
+
+    /// \brief
+    /// Stores the target data of a card (Tg, SENS_RES, SEL_RES, NFCIDLength, NFCID) in out
+    uint16_t targetData(uint8_t tg, const emulatedCard& card, uint8_t *out) const;
+
+    /// \brief
+    /// Executes one command and stores the response data in out
+    /// \details
+    /// @param  command     Command code followed by its parameters
+    /// @param  n           Length of the command including the command code
+    /// @param  out         Buffer where the response data (after the response code) is stored
+    /// @return uint16_t    Amount of response data bytes
+    uint16_t execute(const uint8_t *command, uint16_t n, uint8_t *out);
+
+    /// \brief
+    /// Executes one Mifare command of an InDataExchange on a card
+    uint16_t mifareExchange(emulatedCard& card, const uint8_t *command, uint16_t n, uint8_t *out);
+
+    /// \brief
+    /// Builds a complete response frame out of the response data
+    /// \details
+    /// Responses that do not fit in a normal frame are build as an extended frame
+    void buildResponse(const uint8_t responseCode, const uint8_t *data, uint16_t n);
+};
+
+} // namespace communication
+
+#endif //V1_OOPC_18_NATHANHOUWAART_PN532EMULATOR_H
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @brief     Software pn532 in HSU mode behind a pseudo-terminal
+ *
+ * This file connects the software pn532 emulator to the master side of a pseudo-terminal. The slave side
+ * (slaveName()) behaves like the serial port of a pn532 module in HSU mode, so the complete uart path of the
+ * driver (hwuart::PosixUart, communication::uart and communication::uartReady) can be run and benchmarked on
+ * a Linux host without any hardware.
+ *
+ * A thread reads the byte stream of the host into a ringbuffer, takes the frames out of it and passes them to the emulator.
+ * The ACK and response frames of the emulator are written back as soon as the emulator has them ready.
+ * 0x55 outside a frame wakes the emulator up, like the HSU wake up of a real pn532.
+ *
+ * A pseudo-terminal has no line rate, so the baudrate is emulated: every frame takes the time it would
+ * take on a serial line with the baudrate the host has set on the slave side. Bytes the host sends with another
+ * baudrate than emulator.serialBaudrate are garbage to the chip and are dropped, except for the ACK that completes
+ * a SetSerialBaudrate.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_PN532EMULATORPTY_H
+#define V1_OOPC_18_NATHANHOUWAART_PN532EMULATORPTY_H
+
+#include "pn532Emulator.h"
+
+#include <atomic>
+#include <thread>
+
+namespace communication{
+
+/// \brief
+/// Runs a pn532Emulator behind a pseudo-terminal
+class pn532EmulatorPty
+{
+private:
+    pn532Emulator      &emulator;
+    int                 master = -1;
+    std::thread         worker;
+    std::atomic<bool>   running{false};
+
+    hwuart::buffer<512> input;              // bytes of the host that are not yet passed to the emulator
+
+    /// \brief
+    /// The thread: passes the frames of the host to the emulator and writes its answers back
+    void run();
+
+    /// \brief
+    /// Passes the complete frames of the host to the emulator
+    /// \details
+    /// An incomplete frame stays in the input buffer until the rest has been received
+    void receive();
+
+    /// \brief
+    /// Writes the next frame the emulator has ready to the host
+    void transmit();
+
+    /// \brief
+    /// Returns the baudrate the host has set on the slave side of the pseudo-terminal
+    uint32_t hostBaudrate() const;
+
+    /// \brief
+    /// Waits the time nBytes take on the serial line, 10 bits per byte at the baudrate of the emulator
+    void waitWireTime(size_t nBytes) const;
+
+public:
+    /// \brief
+    /// Constructor of the pn532EmulatorPty class
+    /// \details
+    /// Opens a new pseudo-terminal. The emulator is only used by the thread between start() and stop()
+    pn532EmulatorPty(pn532Emulator &emulator);
+
+    /// \brief
+    /// Stops the thread and closes the pseudo-terminal
+    ~pn532EmulatorPty();
+
+    pn532EmulatorPty(const pn532EmulatorPty&) = delete;
+    pn532EmulatorPty& operator=(const pn532EmulatorPty&) = delete;
+
+    /// \brief
+    /// Path of the slave side of the pseudo-terminal, to be opened as serial port
+    const char* slaveName() const;
+
+    /// \brief
+    /// Starts the thread that runs the emulator
+    void start();
+
+    /// \brief
+    /// Stops the thread. After this the emulator can be used by the caller again
+    void stop();
+};
+
+} // namespace communication
+
+#endif // V1_OOPC_18_NATHANHOUWAART_PN532EMULATORPTY_H
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief     Software pn532 chips as slaves of an spi bus
+ *
+ * This file puts one or more pn532 emulators behind a hwlib::spi_bus. Every emulator gets its own sel pin,
+ * so the complete spi path of the driver (communication::spi, and several readers sharing one bus) can be run
+ * and benchmarked on a host without any hardware.
+ *
+ * The bus decodes the transactions of the pn532 spi protocol: the first byte after sel goes low is the
+ * data write (0x01), status read (0x02) or data read (0x03). The frame of a data write is passed to the emulator
+ * when sel goes high again. Every transferred byte can take the time it takes on a real bus (byteTime).
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_PN532EMULATORSPI_H
+#define V1_OOPC_18_NATHANHOUWAART_PN532EMULATORSPI_H
+
+#include "pn532Emulator.h"
+
+namespace communication{
+
+/// \brief
+/// Spi bus with emulated pn532 chips as slaves
+class pn532EmulatorSpi : public hwlib::spi_bus
+{
+public:
+    static const uint8_t maxSlaves = 8;
+
+    /// \brief
+    /// Counters that show how the bus has been used
+    struct statistics{
+        uint_fast32_t calls         = 0;    // write_and_read calls
+        uint_fast32_t bytes         = 0;
+        uint_fast32_t selWrites     = 0;
+        uint_fast32_t transactions  = 0;    // falling edges of the sel pins
+    };
+
+    /// \brief
+    /// Sel pin of one emulated chip
+    class selPin : public hwlib::pin_out
+    {
+    private:
+        pn532EmulatorSpi   *bus     = nullptr;
+        uint8_t             slave   = 0;
+        bool                level   = true;
+
+        friend class pn532EmulatorSpi;
+
+    public:
+        void write(bool x) override;
+        void flush() override {}
+    };
+
+    statistics      stats;
+    uint_fast32_t   byteTime = 0;           // time in ns one byte takes on the bus, 8000 is a 1 MHz clock
+
+    /// \brief
+    /// Constructor of the pn532EmulatorSpi class
+    pn532EmulatorSpi(){}
+
+    pn532EmulatorSpi(const pn532EmulatorSpi&) = delete;
+    pn532EmulatorSpi& operator=(const pn532EmulatorSpi&) = delete;
+
+    /// \brief
+    /// Connects an emulator to the bus and returns its sel pin
+    /// \details
+    /// At most maxSlaves emulators can be connected. After that the sel pin of the last one is returned
+    selPin& attach(pn532Emulator &emulator);
+
+    /// \brief
+    /// Resets all counters
+    void resetStatistics(){ stats = statistics(); }
+
+private:
+    /// \brief
+    /// Emulated chip with the state of its current transaction
+    struct slaveState{
+        pn532Emulator  *emulator    = nullptr;
+        uint8_t         operation   = 0;    // first byte of the transaction, 0 when it has not been send yet
+        uint8_t         command[nfc::pn532::general::commandBufferSize] = {};
+        size_t          commandLength = 0;
+        bool            reading     = false;
+    };
+
+    selPin          pins[maxSlaves];
+    slaveState      slaves[maxSlaves];
+    uint8_t         slaveCount  = 0;
+    uint8_t         selected    = maxSlaves;    // slave whose sel pin is low, maxSlaves when none
+
+    /// \brief
+    /// Starts (sel low) or ends (sel high) the transaction of a slave
+    void select(uint8_t slave, bool active);
+
+    /// \brief
+    /// Transfers n bytes to and from the selected slave
+    void write_and_read(const size_t n, const uint8_t data_out[], uint8_t data_in[]) override;
+};
+
+} // namespace communication
+
+#endif // V1_OOPC_18_NATHANHOUWAART_PN532EMULATORSPI_H
@@ -20,9 +20,13 @@
  *      - NFC->SAMConfiguration()
  *      - NFC->RFField()
  *      - NFC->detectCard()
+ *      - NFC->autoPoll()
+ *      - NFC->startAutoPoll()
  *      - NFC->mifareAuthenticate()
  *      - NFC->mifareReadCard()
+ *      - NFC->mifareReadSectors()
  *      - NFC->mifareMakeValueBlock()
+ *      - NFC->poll()               (only when a command fails)
  * 
  * @note    The content that is written to the display can be changed / altered in the pn532Oled.cpp file. When you do,
  *          just make sure there is a hwlib::wait_ms( x ) after you write to the oled. Otherwise the contend will be
@@ -54,6 +58,9 @@ private:
     NFC                 & slave;
     hwlib::terminal_from& display;
 
+    // state seen by the last poll(), so an error is only displayed once
+    commandState          lastState = commandState::idle;
+
 public:
 
     // ------------------------------------------------------------------------------- //
@@ -80,11 +87,11 @@ public:
 
     /// \brief
     /// Same as slave.sendData()
-    void sendData(uint8_t *commandBuffer, const uint8_t nBytes) override;
+    void sendData(const uint8_t *commandBuffer, const size_t nBytes) override;
 
     /// \brief
     /// Same as slave.getData()
-    void getData(uint8_t *buffer, const uint8_t nBytes) override;
+    void getData(uint8_t *buffer, const size_t nBytes) override;
 
     /// \brief
     /// Same as slave.writeRegister()
@@ -119,6 +126,33 @@ public:
     /// Same as slave.sendCommandAndCheckAck()
     Result sendCommandAndCheckAck(setupSendCommand &command) override;
 
+    /// \brief
+    /// Same as slave.sendCommandAndCheckAck()
+    Result sendCommandAndCheckAck(const communication::segment* segments, const size_t count) override;
+    using NFC::sendCommandAndCheckAck;
+
+
+    // ------------------------------------------------------------------------------- //
+    // Asynchronous command functions                                                  //
+    // ------------------------------------------------------------------------------- //
+
+    /// \brief
+    /// Same as slave.submit()
+    statusCode submit(const communication::segment* segments, const size_t count, commandListener* listener = nullptr) override;
+    using NFC::submit;
+
+    /// \brief
+    /// Same as slave.poll(). Displays an error when the command fails
+    commandState poll() override;
+
+    /// \brief
+    /// Same as slave.fetch()
+    Result fetch() override;
+
+    /// \brief
+    /// Same as slave.cancel()
+    void cancel() override;
+
 
     // ------------------------------------------------------------------------------- //   
     // More advanced functions                                                         //
@@ -152,14 +186,43 @@ public:
     /// Wait for a card and update the display to inform that the pn532 is ready to detect a card
     bool detectCard(card& cardinfo, const uint8_t nCards, const uint8_t cardtype) override;
 
+    /// \brief
+    /// Poll for a card and update the display to inform that the pn532 is ready to detect a card
+    bool autoPoll(card& cardinfo, const autoPollOptions& options) override;
+
+    /// \brief
+    /// Start polling for a card and update the display to inform that the pn532 is ready to detect a card
+    statusCode startAutoPoll(const autoPollOptions& options, commandListener* listener = nullptr) override;
+
+    /// \brief
+    /// Same as slave.getAutoPollTarget()
+    bool getAutoPollTarget(card& cardinfo) override;
+
+    /// \brief
+    /// Wait for cards and update the display to inform that the pn532 is ready to detect a card
+    uint8_t detectCards(card* const* cards, const uint8_t nCards, const uint8_t cardtype) override;
+    using NFC::detectCards;
+
     /// \brief
     /// Same as slave.selectCard()
-    statusCode selectCard() override;
+    statusCode selectCard(const uint8_t cardNumber) override;
+
+    /// \brief
+    /// Same as slave.deselectCard()
+    statusCode deselectCard(const uint8_t cardNumber) override;
+
+    /// \brief
+    /// Same as slave.releaseCard()
+    statusCode releaseCard(const uint8_t cardNumber) override;
 
     /// \brief
     /// Same as slave.setSerialBaudrate()
     statusCode setSerialBaudrate(const baudRate br) override;
 
+    /// \brief
+    /// Same as slave.powerDown()
+    statusCode powerDown(const uint8_t wakeUpEnable) override;
+
 
     // ------------------------------------------------------------------------------- //
     // Mifare specific functions                                                       //
@@ -173,6 +236,14 @@ public:
     /// Try to authenticate a sector trailer block and display the status on the display
     statusCode mifareAuthenticate(card&cardinfo, uint8_t cardNumber, mifareCommands AorB, uint8_t pagenr, const uint8_t* key) override;
 
+    /// \brief
+    /// Same as slave.mifareReadBlock()
+    statusCode mifareReadBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key) override;
+
+    /// \brief
+    /// Same as slave.mifareWriteBlock()
+    statusCode mifareWriteBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key, const uint8_t* data) override;
+
     /// \brief
     /// Same as slave.mifareWritePage()    
     statusCode mifareWritePage(card& cardinfo, uint8_t cardNumber, uint8_t pageNumber,const  char* data)override;
@@ -181,6 +252,10 @@ public:
     /// Will try to read a card and will display the status on the display()
     statusCode mifareReadCard(card& cardInfo, const uint8_t cardNumber, const mifareCommands AorB, const cardKeys& authenticationKeys)override;
 
+    /// \brief
+    /// Will try to read the chosen sectors and will display the status on the display()
+    statusCode mifareReadSectors(card& cardInfo, const uint8_t cardNumber, const cardKeys& authenticationKeys, const readOptions& options, sectorStatus& status) override;
+
     /// \brief
     /// Will try to make a value block and will display the status on the display()
     statusCode mifareMakeValueBlock(card&cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key)override;
@@ -197,6 +272,14 @@ public:
     /// Same as slave.mifareDecrement()
     statusCode mifareDecrement(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const uint32_t value)override;
 
+    /// \brief
+    /// Same as slave.mifareValueTransaction()
+    statusCode mifareValueTransaction(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const mifareCommands operation, const uint32_t value, uint32_t& newValue) override;
+
+    /// \brief
+    /// Same as slave.mifareReadValue()
+    statusCode mifareReadValue(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, uint32_t& value) override;
+
 };
 } // namespace nfc
 
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief     Implementation of the abstract UART interface over a POSIX serial port
+ *
+ * This file implements hwuart::uart_abstract for Linux hosts, like a gateway with a pn532 module
+ * in HSU mode on /dev/ttyUSB0 or /dev/ttyS0. It also works on a pseudo-terminal, which is used to
+ * run the driver against the software pn532 emulator (see pn532EmulatorPty.h).
+ *
+ * The serial port is opened non-blocking. Data is written and read in blocks, and waiting for data is
+ * done with poll(), so the process sleeps while the pn532 is busy instead of spinning on rxReady().
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_POSIX_UART_H
+#define V1_OOPC_18_NATHANHOUWAART_POSIX_UART_H
+
+#include "hardware_uart.h"
+
+namespace hwuart
+{
+
+/// \brief
+/// Implementation of the abstract UART class over a termios file descriptor
+/// \details
+/// The port is set to raw mode, 8 data bits, no parity and one stop bit.
+/// Any baudrate the serial driver supports can be used, not only the standard ones.
+class PosixUart : public uart_abstract{
+private:
+
+    int fd = -1;
+    unsigned int baudrate;
+    buffer<256> rxBuffer;
+    int overruns = 0;
+
+public:
+
+    /// \brief
+    /// Constructor of the PosixUart class
+    /// \details
+    /// Opens the serial port and initialises it. When the port cannot be opened,
+    /// a message is printed and isOpen() returns false.
+    /// @param device   Path of the serial port, for example /dev/ttyUSB0
+    /// @param baudrate The baudrate the bus needs to be set to
+    PosixUart(const char *device, unsigned int baudrate);
+
+    /// \brief
+    /// Closes the serial port
+    ~PosixUart();
+
+    PosixUart(const PosixUart&) = delete;
+    PosixUart& operator=(const PosixUart&) = delete;
+
+    /// \brief
+    /// Returns whether the serial port is open
+    bool isOpen() const { return fd >= 0; }
+
+    /// \brief
+    /// Sets the serial port to raw mode with the baudrate of the constructor
+    void uart_init() override;
+
+    /// \brief
+    /// Changes the baudrate, after the bytes that are still in the output buffer have been send
+    bool setBaudrate(const uint32_t newBaudrate) override;
+
+    /// \brief
+    /// Returns the baudrate in bits per second
+    uint32_t getBaudrate() const override { return baudrate; }
+
+    /// \brief
+    /// Checks how many bytes are stored in the buffer
+    int avialable() override;
+
+    /// \brief
+    /// Stores a byte in the ringbuffer
+    void storeByte(const char c) override;
+
+    /// \brief
+    /// Checks whether the serial driver has lost bytes since the last call
+    /// \details
+    /// Uses the overrun counters of the serial driver. Pseudo-terminals do not have them and never overrun
+    bool uart_has_overrun() override;
+
+    /// \brief
+    /// Receives a byte from the serial port, 0 when there is none
+    uint8_t receiveByte() override;
+
+    /// \brief
+    /// Checks whether a byte can be read from the serial port
+    bool rxReady() override;
+
+    /// \brief
+    /// Get a character from the ringbuffer if available
+    uint8_t getC() override;
+
+    /// \brief
+    /// Send a byte over the serial port
+    void sendByte(const uint8_t c) override;
+
+    /// \brief
+    /// Writes nBytes to the serial port, with as few write() calls as possible
+    void sendBytes(const uint8_t *data, const size_t nBytes) override;
+
+    /// \brief
+    /// Sleeps in poll() until a byte can be read, or until the timeout has passed
+    bool waitReadable(const uint_fast32_t timeout) override;
+
+    /// \brief
+    /// Receives up to nBytes with as few read() calls as possible
+    size_t receiveBytes(uint8_t *data, const size_t nBytes, const uint_fast32_t timeout) override;
+};
+
+} // namespace hwuart
+
+#endif // V1_OOPC_18_NATHANHOUWAART_POSIX_UART_H
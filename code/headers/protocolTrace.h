@@ -0,0 +1,219 @@
+/**
+ * @file
+ * @brief     Recording and replaying of the bus traffic of a pn532
+ *
+ * traceRecorder is a protocol that sits between PN532_chip and the real protocol. Every call (wakeUp, sendData,
+ * receiveData, ...) is passed on and stored in a compact binary trace, with the time since the previous call.
+ * traceReplay is a protocol without a chip behind it: it answers the driver with the bytes of a trace, so a session
+ * that has been captured at a gate can be run again on any host, as often as needed.
+ *
+ * A trace starts with the bytes 'P', 'T' and the version. Every event after that is:
+ *      - the type of the event (traceEvent), one byte
+ *      - the time in us since the previous event started, as varint
+ *      - the amount of data bytes, as varint
+ *      - the data bytes: the bytes that were send or received, or the baudrate (4 bytes, little endian) followed by
+ *        the result of the switch (1 byte, 0 when the protocol refused the baudrate)
+ * A varint stores 7 bits per byte, the highest bit tells that another byte follows. Most events take 3 bytes plus their data.
+ *
+ * The replay can run at full speed, so only the cpu time of the driver is measured, or at the original timing:
+ * then every read waits until as much time has passed since the previous event as in the trace.
+ * The replay also drives an irq pin and answers isReady(), so both irqReady and statusReady can be used.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_PROTOCOLTRACE_H
+#define V1_OOPC_18_NATHANHOUWAART_PROTOCOLTRACE_H
+
+#include "interface.h"
+
+namespace communication{
+
+/// \brief
+/// Types of the events in a trace
+enum class traceEvent : uint8_t{
+    wakeUp          = 0x01,
+    send            = 0x02,
+    receive         = 0x03,
+    receiveMore     = 0x04,
+    endTransaction  = 0x05,
+    baudrate        = 0x06
+};
+
+/// \brief
+/// Protocol decorator that records all traffic of another protocol
+class traceRecorder : public protocol
+{
+private:
+    protocol       &bus;
+    uint8_t        *trace;
+    const size_t    capacity;
+    size_t          length = 0;
+    bool            full = false;
+    uint_fast64_t   lastEvent;
+
+    /// \brief
+    /// Stores the type, the time and the length of an event
+    /// \details
+    /// When the event with its data does not fit in the trace, nothing is stored and recording stops
+    /// @return bool    Whether the data bytes of the event can be stored after it
+    bool beginEvent(traceEvent type, size_t nBytes);
+
+    /// \brief
+    /// Stores the data bytes of an event, after beginEvent has returned true
+    void appendData(const uint8_t *data, size_t nBytes);
+
+public:
+    /// \brief
+    /// Constructor of the traceRecorder class
+    /// \details
+    /// @param  bus         The protocol the chip is connected to, all calls are passed on to it
+    /// @param  trace       Buffer where the trace is stored in
+    /// @param  capacity    Size of the buffer in bytes
+    traceRecorder(protocol &bus, uint8_t *trace, size_t capacity);
+
+    void wakeUp() override;
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+
+    /// \brief
+    /// Records the segments as one send event and passes them on as segments, so the bus still sends them in one transaction
+    void sendData(const segment *segments, size_t count) override;
+
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override;
+    void endTransaction() override;
+
+    /// \brief
+    /// Passed on to the bus, not recorded. The replay derives readiness from the time of the reads
+    bool isReady() override;
+
+    /// \brief
+    /// Passed on to the bus, the baudrate is recorded together with the result of the bus
+    bool setBaudrate(const uint32_t baudrate) override;
+    uint32_t getBaudrate() const override;
+
+    /// \brief
+    /// Returns the amount of bytes of the trace
+    size_t size() const { return length; }
+
+    /// \brief
+    /// Returns whether the buffer was full and events have been lost
+    bool overflowed() const { return full; }
+
+    /// \brief
+    /// Starts a new, empty trace in the same buffer
+    void clear();
+};
+
+/// \brief
+/// Protocol that plays a recorded trace back to the driver
+/// \details
+/// Every call of the driver is compared with the next event of the trace. A call of another type, or a send with other
+/// bytes, is counted as mismatch: the driver no longer does what it did when the trace was recorded.
+/// A read that does not match gets 0x00 bytes, like a bus without a chip.
+class traceReplay : public protocol
+{
+public:
+
+    /// \brief
+    /// Fake irq pin that reads low when the next read of the trace is due
+    class irqPin : public hwlib::pin_in
+    {
+    private:
+        traceReplay &replay;
+
+    public:
+        irqPin(traceReplay &replay): replay(replay){}
+
+        bool read() override { return !replay.frameReady(); }
+    };
+
+    /// \brief
+    /// Counters of the replay
+    struct statistics{
+        uint_fast32_t events        = 0;
+        uint_fast32_t mismatches    = 0;
+    };
+
+    irqPin          irq;
+    statistics      stats;
+
+    /// \brief
+    /// Constructor of the traceReplay class
+    /// \details
+    /// @param  trace           The recorded trace
+    /// @param  size            Size of the trace in bytes
+    /// @param  originalTiming  false: every event is played back at once. true: reads wait for the time of the trace
+    traceReplay(const uint8_t *trace, size_t size, bool originalTiming = false);
+
+    void wakeUp() override;
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override;
+    using protocol::sendData;
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override;
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override;
+    void endTransaction() override;
+
+    /// \brief
+    /// Status read of the replay, the same as frameReady()
+    bool isReady() override;
+
+    /// \brief
+    /// Returns the result the bus of the recording gave for this baudrate
+    bool setBaudrate(const uint32_t baudrate) override;
+    uint32_t getBaudrate() const override { return baudrate; }
+
+    /// \brief
+    /// Returns whether the next event is a read that is due, or not a read at all
+    bool frameReady() const;
+
+    /// \brief
+    /// Returns whether the trace starts with a valid header
+    bool valid() const { return start != 0; }
+
+    /// \brief
+    /// Returns whether all events of the trace have been played back
+    bool finished() const { return position >= size; }
+
+    /// \brief
+    /// Plays the trace back from the start again and resets the counters
+    void rewind();
+
+private:
+    const uint8_t  *trace;
+    const size_t    size;
+    const bool      originalTiming;
+    size_t          start = 0;          // first event after the header, 0 when the header is not valid
+    size_t          position = 0;       // next event in the trace
+    uint_fast64_t   lastEvent = 0;      // time (hwlib::now_us) the previous event has been played back
+    uint32_t        baudrate = 0;
+
+    /// \brief
+    /// The decoded header of an event
+    struct event{
+        traceEvent      type;
+        uint_fast32_t   delay;
+        size_t          length;
+        const uint8_t  *data;
+        size_t          next;           // position of the event after this one
+    };
+
+    /// \brief
+    /// Decodes the event at position, returns false at the end of the trace or when the event is damaged
+    bool peek(event &e) const;
+
+    /// \brief
+    /// Takes the next event of the trace when it has the given type, counts a mismatch when it has not
+    /// \details
+    /// In original timing, a read waits until it is due
+    /// @return const uint8_t*  The data of the event, nullptr when the types do not match
+    const uint8_t* take(traceEvent type, size_t &length);
+
+    /// \brief
+    /// Plays back a read: copies the data of the event, 0x00 for the bytes the trace does not have
+    void read(traceEvent type, uint8_t *receiveBuffer, size_t nBytes);
+};
+
+} // namespace communication
+
+#endif // V1_OOPC_18_NATHANHOUWAART_PROTOCOLTRACE_H
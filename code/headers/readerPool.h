@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief     Several nfc readers that share one bus, with a command queue per reader
+ *
+ * A gate with more than one pn532 connects them all to the same spi bus. Every reader has its own
+ * communication::spi with its own sel pin, and its own irq pin. While one reader is busy with a card (the RF part of
+ * a command takes milliseconds), the bus is free and the pool sends commands to the other readers.
+ *
+ * Commands are put in the queue of a reader with enqueue(). step() gives every reader one turn, round-robin:
+ * a busy reader is polled once, an idle reader gets the next command of its queue. The reader that goes first
+ * changes every step, so no reader gets the bus before the others all the time.
+ * The pool uses the asynchronous functions of the readers (submit, poll), so it never waits for a chip itself.
+ *
+ * @note    Give every reader an irqReady strategy (the default of PN532_chip). A statusReady strategy
+ *          polls the chip over the shared bus, which takes the bus away from the other readers.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#ifndef V1_OOPC_18_NATHANHOUWAART_READERPOOL_H
+#define V1_OOPC_18_NATHANHOUWAART_READERPOOL_H
+
+#include "nfc.h"
+
+namespace nfc
+{
+
+/// \brief
+/// Round-robin scheduler for several nfc readers on one bus
+class readerPool
+{
+public:
+    static const uint8_t maxReaders = 8;
+    static const uint8_t queueSize  = 4;
+    static const uint8_t maxSegments = 3;
+
+    /// \brief
+    /// Counters of one reader
+    struct readerStatistics{
+        uint_fast32_t submitted = 0;
+        uint_fast32_t completed = 0;
+        uint_fast32_t failed    = 0;
+    };
+
+    /// \brief
+    /// Constructor of the readerPool class
+    readerPool(){}
+
+    /// \brief
+    /// Adds a reader to the pool
+    /// \details
+    /// The reader must not be used outside the pool while it has commands in the pool
+    /// @param  reader      The reader
+    /// @return uint8_t     Number of the reader in the pool, maxReaders when the pool is full
+    uint8_t addReader(NFC& reader);
+
+    /// \brief
+    /// Returns the amount of readers in the pool
+    uint8_t size() const { return readerCount; }
+
+    /// \brief
+    /// Puts a command in the queue of a reader
+    /// \details
+    /// The segments are copied, the data they point to is not: it must stay valid until the command has been send.
+    /// The listener is notified by the reader when the command is done or has failed. It may enqueue the next command.
+    /// @param  reader      Number of the reader
+    /// @param  segments    Pointer to the first segment of the command frame
+    /// @param  count       Amount of segments, at most maxSegments
+    /// @param  listener    Optional listener of the command
+    /// @return statusCode  pn532StatusOK, pn532StatusBusy when the queue is full, pn532StatusInvalidParameter
+    statusCode enqueue(uint8_t reader, const communication::segment* segments, size_t count, commandListener* listener = nullptr);
+
+    /// \brief
+    /// Puts a (precomputed) command frame in the queue of a reader
+    template<uint8_t n>
+    statusCode enqueue(uint8_t reader, const commandFrame<n>& frame, commandListener* listener = nullptr)
+    {
+        const auto segment = frame.segment();
+        return enqueue(reader, &segment, 1, listener);
+    }
+
+    /// \brief
+    /// Puts a command frame with its payload in the queue of a reader
+    template<uint8_t n, uint8_t payloadSize>
+    statusCode enqueue(uint8_t reader, commandFrame<n, payloadSize>& frame, const uint8_t* payload, commandListener* listener = nullptr)
+    {
+        communication::segment segments[3];
+        frame.segments(payload, segments);
+        return enqueue(reader, segments, 3, listener);
+    }
+
+    /// \brief
+    /// Gives every reader one turn
+    /// \details
+    /// A busy reader is polled once. A reader that is (or has just become) idle gets the next command of its queue.
+    /// @return true    A command is still queued or in progress
+    /// @return false   All readers are idle and all queues are empty
+    bool step();
+
+    /// \brief
+    /// Calls step() until all commands have been handled
+    void run();
+
+    /// \brief
+    /// Returns the amount of commands of a reader that are queued or in progress
+    uint8_t pending(uint8_t reader) const;
+
+    /// \brief
+    /// Returns the counters of a reader
+    const readerStatistics& statistics(uint8_t reader) const { return readers[reader].stats; }
+
+private:
+    /// \brief
+    /// Command that waits in the queue of a reader
+    struct job{
+        communication::segment  segments[maxSegments];
+        uint8_t                 count       = 0;
+        commandListener*        listener    = nullptr;
+    };
+
+    /// \brief
+    /// A reader with its queue
+    struct readerState{
+        NFC*                nfc     = nullptr;
+        job                 queue[queueSize];
+        uint8_t             head    = 0;
+        uint8_t             count   = 0;
+        bool                busy    = false;
+        readerStatistics    stats;
+    };
+
+    readerState     readers[maxReaders];
+    uint8_t         readerCount = 0;
+    uint8_t         first       = 0;        // reader that gets the first turn of the next step
+
+    /// \brief
+    /// The turn of one reader
+    /// @return true    The reader still has work
+    bool turn(readerState& reader);
+};
+
+} // namespace nfc
+
+#endif // V1_OOPC_18_NATHANHOUWAART_READERPOOL_H
@@ -134,7 +134,7 @@ public:
       uint8_t data[], 
       size_t n  
    ){
-      for( uint_fast8_t i = 0; i < n; i++ ){
+      for( size_t i = 0; i < n; i++ ){
          if( ( ! first_read ) || ( i > 0 )){
             write_ack();
          }   
@@ -402,5 +402,200 @@ public:
    }
    
 }; // class i2c_bus_bit_banged_scl_sda    
+
+
+// ==========================================================================
+//
+// statically dispatched bit-banged i2c bus implementation
+//
+// ==========================================================================
+
+/// statically dispatched bit-banged i2c bus implementation
+///
+/// This class implements the same bit-banged master as 
+/// i2c_bus_bit_banged_scl_sda, with the same i2c_bus interface, 
+/// but the pin types and the clock are template parameters:
+///    - the pins are accessed through their concrete types, 
+///      so the pin calls are not virtual and can be inlined
+///    - the bit and byte loops are inside this class, 
+///      so only one virtual call is done per byte (or block of bytes)
+///    - half_period_ns is the time in ns scl is low and high,
+///      5'000 gives at most 100 kHz, 1'250 at most 400 kHz, 
+///      0 gives no wait at all: the speed is then only limited by the pins.
+///      The wait is wait_ns_busy(), so its resolution depends on the target:
+///      a target without its own wait_ns_busy() rounds up to whole us,
+///      which makes 1'250 a wait of 2 us (at most 250 kHz)
+///    - a slave can stretch the clock for at most stretch_timeout_us,
+///      after that the bit is clocked anyway and stretch_timeouts() 
+///      is incremented
+///
+/// The pin types must be concrete (non-abstract) pin_oc implementations,
+/// like hwlib::target::pin_oc.
+/// Limitations:
+///    - only the 7-bit address format is supported
+///    - only a single master is supported
+template< 
+   typename scl_pin, 
+   typename sda_pin, 
+   uint_fast32_t half_period_ns = 5'000, 
+   uint_fast32_t stretch_timeout_us = 1'000 
+>
+class i2c_bus_bit_banged_scl_sda_static : 
+   public i2c_primitives, 
+   public i2c_bus
+{
+private:
+
+   static_assert( 
+      ! std::is_abstract< scl_pin >::value && ! std::is_abstract< sda_pin >::value,
+      "the pins of i2c_bus_bit_banged_scl_sda_static must be concrete pin types" );
+
+   scl_pin & scl;
+   sda_pin & sda;
+   uint_fast32_t timeouts = 0;
+
+   // the qualified calls are not virtual
+   void scl_set( bool x ){ scl.scl_pin::write( x ); scl.scl_pin::flush(); }
+   void sda_set( bool x ){ sda.sda_pin::write( x ); sda.sda_pin::flush(); }
+   bool sda_get(){ sda.sda_pin::refresh(); return sda.sda_pin::read(); }
+
+   void wait_half_period(){
+      if constexpr ( half_period_ns > 0 ){
+         wait_ns_busy( half_period_ns );
+      }
+   }
+
+   // release scl and wait for the slave to release it too
+   void scl_release(){
+      scl_set( 1 );
+      wait_half_period();
+      scl.scl_pin::refresh();
+      if( scl.scl_pin::read() ){
+         return;
+      }
+
+      const auto deadline = now_ticks() + stretch_timeout_us * ticks_per_us();
+      do {
+         if( now_ticks() >= deadline ){
+            ++timeouts;
+            return;
+         }
+         scl.scl_pin::refresh();
+      } while( ! scl.scl_pin::read() );
+   }
+
+   void put_bit( bool x ){
+      scl_set( 0 );
+      wait_half_period();
+      sda_set( x );
+      scl_release();
+   }
+
+   bool get_bit(){
+      scl_set( 0 );
+      sda_set( 1 );
+      wait_half_period();
+      scl_release();
+      bool result = sda_get();
+      wait_half_period();
+      return result;
+   }
+
+   void put_byte( uint_fast8_t x ){
+      for( uint_fast8_t i = 0; i < 8; i++ ){
+         put_bit( ( x & 0x80 ) != 0 );
+         x = x << 1;
+      }
+   }
+
+   uint_fast8_t get_byte(){
+      uint_fast8_t result = 0;
+      for( uint_fast8_t i = 0; i < 8; i++ ){
+         result = ( result << 1 ) | ( get_bit() ? 0x01 : 0x00 );
+      }
+      return result;
+   }
+
+   void write_bit( bool x ) override {
+      put_bit( x );
+   }
+
+   bool read_bit() override {
+      return get_bit();
+   }
+
+   bool read_ack() override {
+      return ! get_bit();
+   }
+
+   void write_ack() override {
+      put_bit( 0 );
+   }
+
+   void write_nack() override {
+      put_bit( 1 );
+   }
+
+   void write( uint8_t x ) override {
+      put_byte( x );
+   }
+
+   void write( const uint8_t data[], size_t n ) override {
+      for( size_t i = 0; i < n; i++ ){
+         (void) get_bit();
+         put_byte( data[ i ] );
+      }
+   }
+
+   uint_fast8_t read_byte() override {
+      return get_byte();
+   }
+
+   void read( bool first_read, uint8_t data[], size_t n ) override {
+      for( size_t i = 0; i < n; i++ ){
+         if( ( ! first_read ) || ( i > 0 )){
+            put_bit( 0 );
+         }
+         data[ i ] = get_byte();
+      }
+   }
+
+   void write_start() override {
+      sda_set( 0 );
+      wait_half_period();
+      scl_set( 0 );
+      wait_half_period();
+   }
+
+   void write_stop() override {
+      scl_set( 0 );
+      wait_half_period();
+      sda_set( 0 );
+      wait_half_period();
+      scl_set( 1 );
+      wait_half_period();
+      sda_set( 1 );
+      wait_half_period();
+   }
+
+public:
+
+   /// construct a bit-banged I2C bus from the scl and sda pins
+   /// 
+   /// This constructor creates a bit-banged I2C bus master
+   /// from the scl and sda pins.
+   i2c_bus_bit_banged_scl_sda_static( scl_pin & scl, sda_pin & sda ):
+      i2c_bus( *(i2c_primitives*) this ), scl( scl ), sda( sda )
+   {
+      scl_set( 1 );
+      sda_set( 1 );
+   }
+
+   /// the number of clock stretches that took longer than stretch_timeout_us
+   uint_fast32_t stretch_timeouts() const {
+      return timeouts;
+   }
+
+}; // class i2c_bus_bit_banged_scl_sda_static
    
 }; // namespace hwlib
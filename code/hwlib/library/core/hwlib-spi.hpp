@@ -57,10 +57,12 @@ public:
       
       pin_direct_from_out_t sel;
       
-      spi_transaction( spi_bus & bus, pin_out & _sel ):
+      spi_transaction( spi_bus & bus, pin_out & _sel, bool select = true ):
          bus( bus ), sel( direct( _sel ))
       {
-         sel.write( 0 );        
+         if( select ){
+            sel.write( 0 );        
+         }
       }
       
       friend class spi_bus;
@@ -180,6 +182,15 @@ public:
       return spi_transaction( *this, sel );
    }
 
+   /// spi continued transaction
+   ///
+   /// This function returns a SPI transaction object 
+   /// for a sel pin that is still low from an earlier transaction.
+   /// The sel pin is not written, the transfer simply continues.
+   spi_transaction continued_transaction( pin_out & sel ){
+      return spi_transaction( *this, sel, false );
+   }
+
 }; // class spi_bus  
 
 
@@ -205,7 +216,7 @@ private:
       uint8_t data_in[] 
    ) override {
 
-      for( uint_fast8_t i = 0; i < n; ++i ){
+      for( size_t i = 0; i < n; ++i ){
           
          uint_fast8_t d = 
             ( data_out == nullptr )
@@ -257,5 +268,183 @@ public:
    }
    
 }; // class spi_bus_bit_banged_sclk_mosi_miso    
+
+
+/// bit order of a SPI transfer
+enum class spi_bit_order { lsb_first, msb_first };
+
+/// statically dispatched bit-banged SPI bus implementation
+///
+/// This class implements a bit-banged SPI master (mode 0) like 
+/// spi_bus_bit_banged_sclk_mosi_miso, but:
+///    - the pin types are template parameters, the pins are called
+///      through their concrete types, so the calls are not virtual 
+///      and can be inlined
+///    - half_period_ns is the time in ns sclk is low and high,
+///      0 gives no wait at all
+///    - the bit order is a template parameter, the pn532 uses lsb_first
+///    - a write-only transfer (data_in is nullptr) does not read miso,
+///      and only writes mosi when the bit changes
+///    - a read-only transfer (data_out is nullptr) writes mosi once (0)
+///      and then only clocks and reads
+///
+/// The pin types must be concrete (non-abstract) pin implementations,
+/// like hwlib::target::pin_out and hwlib::target::pin_in.
+template< 
+   typename sclk_pin, 
+   typename mosi_pin, 
+   typename miso_pin, 
+   uint_fast32_t half_period_ns = 1'000,
+   spi_bit_order bit_order = spi_bit_order::lsb_first
+>
+class spi_bus_bit_banged_sclk_mosi_miso_static : public spi_bus {
+private:
+
+   static_assert( 
+      ! std::is_abstract< sclk_pin >::value 
+         && ! std::is_abstract< mosi_pin >::value 
+         && ! std::is_abstract< miso_pin >::value,
+      "the pins of spi_bus_bit_banged_sclk_mosi_miso_static must be concrete pin types" );
+
+   static constexpr bool lsb = ( bit_order == spi_bit_order::lsb_first );
+
+   sclk_pin & sclk;
+   mosi_pin & mosi;
+   miso_pin & miso;
+
+   // the qualified calls are not virtual
+   void sclk_set( bool x ){ sclk.sclk_pin::write( x ); sclk.sclk_pin::flush(); }
+   void mosi_set( bool x ){ mosi.mosi_pin::write( x ); mosi.mosi_pin::flush(); }
+   bool miso_get(){ miso.miso_pin::refresh(); return miso.miso_pin::read(); }
+
+   void HWLIB_INLINE wait_half_period(){
+      if constexpr ( half_period_ns > 0 ){
+         wait_ns_busy( half_period_ns );
+      }
+   }
+
+   // the bit that goes out first
+   static bool HWLIB_INLINE first_bit( uint_fast8_t d ){
+      return lsb ? ( ( d & 0x01 ) != 0 ) : ( ( d & 0x80 ) != 0 );
+   }
+
+   static uint_fast8_t HWLIB_INLINE shift_out( uint_fast8_t d ){
+      return lsb ? ( d >> 1 ) : ( ( d << 1 ) & 0xFF );
+   }
+
+   static uint_fast8_t HWLIB_INLINE shift_in( uint_fast8_t d, bool x ){
+      return lsb 
+         ? ( ( d >> 1 ) | ( x ? 0x80 : 0x00 ) ) 
+         : ( ( ( d << 1 ) & 0xFF ) | ( x ? 0x01 : 0x00 ) );
+   }
+
+   void HWLIB_INLINE clock_pulse(){
+      wait_half_period();
+      sclk_set( 1 );
+      wait_half_period();
+      sclk_set( 0 );
+   }
+
+   void write_only( const size_t n, const uint8_t data_out[] ){
+      bool last = ! first_bit( data_out[ 0 ] );
+      for( size_t i = 0; i < n; ++i ){
+         uint_fast8_t d = data_out[ i ];
+         for( uint_fast8_t j = 0; j < 8; ++j ){
+            const bool x = first_bit( d );
+            if( x != last ){
+               mosi_set( x );
+               last = x;
+            }
+            clock_pulse();
+            d = shift_out( d );
+         }
+      }
+   }
+
+   void read_only( const size_t n, uint8_t data_in[] ){
+      mosi_set( 0 );
+      for( size_t i = 0; i < n; ++i ){
+         uint_fast8_t d = 0;
+         for( uint_fast8_t j = 0; j < 8; ++j ){
+            wait_half_period();
+            sclk_set( 1 );
+            wait_half_period();
+            d = shift_in( d, miso_get() );
+            sclk_set( 0 );
+         }
+         data_in[ i ] = d;
+      }
+   }
+
+   void write_and_read_both( 
+      const size_t n, 
+      const uint8_t data_out[], 
+      uint8_t data_in[] 
+   ){
+      for( size_t i = 0; i < n; ++i ){
+         uint_fast8_t d = data_out[ i ];
+         uint_fast8_t r = 0;
+         for( uint_fast8_t j = 0; j < 8; ++j ){
+            mosi_set( first_bit( d ) );
+            d = shift_out( d );
+            wait_half_period();
+            sclk_set( 1 );
+            wait_half_period();
+            r = shift_in( r, miso_get() );
+            sclk_set( 0 );
+         }
+         data_in[ i ] = r;
+      }
+   }
+
+   void write_and_read( 
+      const size_t n, 
+      const uint8_t data_out[], 
+      uint8_t data_in[] 
+   ) override {
+      if( n == 0 ){
+         return;
+      }
+
+      if( data_in == nullptr ){
+         if( data_out == nullptr ){
+            // nothing to write or read, but the clock pulses are still given
+            mosi_set( 0 );
+            for( size_t i = 0; i < 8 * n; ++i ){
+               clock_pulse();
+            }
+         } else {
+            write_only( n, data_out );
+         }
+      } else if( data_out == nullptr ){
+         read_only( n, data_in );
+      } else {
+         write_and_read_both( n, data_out, data_in );
+      }
+      wait_half_period();
+   }
+
+public:
+
+   /// construct a bit-banged SPI bus from the sclk, miso and mosi pins
+   ///
+   /// This constructor creates a bit-banged SPI bus master
+   /// from the sclk, miso and mosi pins. 
+   ///
+   /// The chip select pins for the individual chips supplied to the 
+   /// write_and_read() functions.
+   spi_bus_bit_banged_sclk_mosi_miso_static( 
+      sclk_pin & sclk, 
+      mosi_pin & mosi, 
+      miso_pin & miso 
+   ):
+      sclk( sclk ), 
+      mosi( mosi ), 
+      miso( miso )
+   {
+      sclk_set( 0 );
+   }
+
+}; // class spi_bus_bit_banged_sclk_mosi_miso_static
    
 }; // namespace hwlib
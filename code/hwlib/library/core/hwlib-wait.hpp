@@ -123,7 +123,10 @@ uint_fast64_t ticks_per_us();
 #ifdef _HWLIB_ONCE
 
 // The default wait_xx functions call the wait_xx_busy functions.
-// An RTOS can override these defaults to hook into all waiting
+// An RTOS can override these defaults to hook into all waiting,
+// a target that provides its own wait_xx functions defines _HWLIB_TARGET_WAIT.
+
+#ifndef _HWLIB_TARGET_WAIT
 
 void HWLIB_WEAK wait_ns( int_fast32_t n ){
    wait_ns_busy( n );
@@ -137,6 +140,8 @@ void HWLIB_WEAK wait_ms( int_fast32_t n ){
    wait_ms_busy( n );
 }
 
+#endif // _HWLIB_TARGET_WAIT
+
 // the target must implement either wait_ns_busy(), wait_us_busy(), or both,
 // and indicate so by defining the corresponding macro, to
 // prevent multiple definitions.
@@ -72,7 +72,7 @@
 /// - HWLIB_TARGET_native : Linux native 
 #ifdef HWLIB_TARGET_Linux
    #define HWLIB_TARGET
-   #include HWLIB_INCLUDE( targets/hwlib-native-sfml.hpp )
+   #include HWLIB_INCLUDE( targets/hwlib-native-linux.hpp )
 #endif
 
 #ifdef HWLIB_TARGET_pyd
@@ -16,6 +16,7 @@
 #ifndef HWLIB_ARDUINO_DUE_H
 #define HWLIB_ARDUINO_DUE_H
 
+#define _HWLIB_TARGET_WAIT_NS_BUSY
 #define _HWLIB_TARGET_WAIT_US_BUSY
 #include HWLIB_INCLUDE( ../hwlib-all.hpp )
 
@@ -914,6 +915,12 @@ uint64_t now_us(){
    return now_ticks() / ticks_per_us();
 }   
 
+void HWLIB_WEAK wait_ns_busy( int_fast32_t n ){
+   // one tick is 1/84 us, about 12 ns
+   auto end = now_ticks() + ( static_cast< uint64_t >( n ) * ticks_per_us() + 999 ) / 1000;
+   while( now_ticks() < end ){}
+}
+
 void HWLIB_WEAK wait_us_busy( int_fast32_t n ){
    auto end = now_us() + n;
    while( now_us() < end ){}
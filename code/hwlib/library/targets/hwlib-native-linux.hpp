@@ -0,0 +1,404 @@
+// ==========================================================================
+//
+// File      : hwlib-native-linux.hpp
+// Part of   : C++ hwlib library for close-to-the-hardware OO programming
+// Copyright : wouter@voti.nl 2017-2019
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+// this file contains Doxygen lines
+/// @file
+
+#ifndef HWLIB_NATIVE_LINUX_H
+#define HWLIB_NATIVE_LINUX_H
+
+#define _HWLIB_TARGET_WAIT
+#define _HWLIB_TARGET_WAIT_NS_BUSY
+#define _HWLIB_TARGET_WAIT_US_BUSY
+#define _HWLIB_TARGET_WAIT_MS
+#include HWLIB_INCLUDE( ../hwlib-all.hpp )
+#include <vector>
+
+/// \brief
+/// hwlib implementation for a Linux host
+/// \details
+/// This target runs hwlib applications as a normal Linux process,
+/// so they can be profiled and benchmarked without a board.
+///
+///    - the time is taken from the monotonic clock, one tick is one ns
+///    - the busy waits spin on that clock, the other waits sleep
+///      and spin the last part, so they are both cheap and precise
+///    - the console (cout / cin) is stdout / stdin
+///    - the pins, ports and windows only exist in memory:
+///      what is written can be read back, and a test can
+///      set the level of an input
+///
+namespace hwlib {
+
+namespace target {
+
+/// in-memory pin
+///
+/// The pin stores the level that has been written, a read returns
+/// that level. A test can use set() to change the level of an input.
+/// The pin counts the writes, so the pin traffic can be measured.
+class pin_in_out : public hwlib::pin_in_out {
+private:
+
+   bool level;
+   bool output;
+
+public:
+
+   /// the amount of write() calls
+   uint_fast32_t writes = 0;
+
+   pin_in_out( bool level = false ):
+      level( level ), output( false )
+   {}
+
+   void direction_set_input() override { output = false; }
+   void direction_set_output() override { output = true; }
+   void direction_flush() override {}
+
+   bool read() override { return level; }
+   void refresh() override {}
+
+   void write( bool x ) override { level = x; ++writes; }
+   void flush() override {}
+
+   /// set the level as seen by a read, like an external signal would
+   void set( bool x ){ level = x; }
+
+   /// the current direction of the pin
+   bool is_output() const { return output; }
+
+}; // class pin_in_out
+
+/// in-memory input pin
+class pin_in : public hwlib::pin_in {
+private:
+
+   bool level;
+
+public:
+
+   pin_in( bool level = false ): level( level ){}
+
+   bool read() override { return level; }
+
+   /// set the level as seen by a read, like an external signal would
+   void set( bool x ){ level = x; }
+
+}; // class pin_in
+
+/// in-memory output pin
+class pin_out : public hwlib::pin_out {
+private:
+
+   bool level = false;
+
+public:
+
+   /// the amount of write() calls
+   uint_fast32_t writes = 0;
+
+   void write( bool x ) override { level = x; ++writes; }
+   void flush() override {}
+
+   /// the level that has been written last
+   bool get() const { return level; }
+
+}; // class pin_out
+
+/// in-memory open-collector pin
+///
+/// Like a real open-collector pin with a pull-up, the pin reads low
+/// when either the pin itself or the other side of the line pulls it low.
+class pin_oc : public hwlib::pin_oc {
+private:
+
+   bool level = true;
+   bool external = true;
+
+public:
+
+   /// the amount of write() calls
+   uint_fast32_t writes = 0;
+
+   bool read() override { return level && external; }
+   void refresh() override {}
+
+   void write( bool x ) override { level = x; ++writes; }
+   void flush() override {}
+
+   /// release (true) or pull down (false) the line from the other side
+   void set( bool x ){ external = x; }
+
+   /// the level that has been written last
+   bool get() const { return level; }
+
+}; // class pin_oc
+
+/// in-memory port
+///
+/// The port stores the value that has been written, a read returns
+/// that value. A test can use set() to change the value of the inputs.
+class port_in_out : public hwlib::port_in_out {
+private:
+
+   uint_fast8_t n;
+   uint_fast16_t value = 0;
+
+public:
+
+   /// the amount of write() calls
+   uint_fast32_t writes = 0;
+
+   port_in_out( uint_fast8_t n = 8 ): n( n ){}
+
+   uint_fast8_t number_of_pins() override { return n; }
+
+   void direction_set_input() override {}
+   void direction_set_output() override {}
+   void direction_flush() override {}
+
+   uint_fast16_t read() override { return value; }
+   void refresh() override {}
+
+   void write( uint_fast16_t x ) override { value = x & mask(); ++writes; }
+   void flush() override {}
+
+   /// set the value as seen by a read, like external signals would
+   void set( uint_fast16_t x ){ value = x & mask(); }
+
+private:
+
+   uint_fast16_t mask() const {
+      return ( n >= 16 ) ? 0xFFFF : ( ( 1u << n ) - 1 );
+   }
+
+}; // class port_in_out
+
+/// in-memory open-collector port
+class port_oc : public hwlib::port_oc {
+private:
+
+   uint_fast8_t n;
+   uint_fast16_t value = 0xFFFF;
+   uint_fast16_t external = 0xFFFF;
+
+public:
+
+   /// the amount of write() calls
+   uint_fast32_t writes = 0;
+
+   port_oc( uint_fast8_t n = 8 ): n( n ){}
+
+   uint_fast8_t number_of_pins() override { return n; }
+
+   uint_fast16_t read() override {
+      return value & external & ( ( n >= 16 ) ? 0xFFFF : ( ( 1u << n ) - 1 ) );
+   }
+   void refresh() override {}
+
+   void write( uint_fast16_t x ) override { value = x; ++writes; }
+   void flush() override {}
+
+   /// release (1) or pull down (0) the lines from the other side
+   void set( uint_fast16_t x ){ external = x; }
+
+}; // class port_oc
+
+/// in-memory window
+///
+/// The pixels are kept in memory, so what has been drawn can be
+/// read back. The window counts the pixel writes and flushes.
+/// When print is set, every flush prints the window as text,
+/// which makes it possible to follow a display on the console.
+class window : public hwlib::window {
+private:
+
+   std::vector< color > pixels;
+
+   void write_implementation(
+      xy pos,
+      color col
+   ) override {
+      pixels[ pos.y * size.x + pos.x ] = col;
+      ++writes;
+   }
+
+public:
+
+   /// the amount of pixel writes
+   uint_fast32_t writes = 0;
+
+   /// the amount of flush() calls
+   uint_fast32_t flushes = 0;
+
+   /// print the window on every flush
+   bool print;
+
+   window(
+      xy size,
+      color foreground = white,
+      color background = black,
+      bool print = false
+   ):
+      hwlib::window( size, foreground, background ),
+      pixels( size.x * size.y, background ),
+      print( print )
+   {}
+
+   window( int x, int y, bool print = false ):
+      window( xy( x, y ), white, black, print )
+   {}
+
+   /// the color of a pixel
+   color read( xy pos ) const {
+      return pixels[ pos.y * size.x + pos.x ];
+   }
+
+   void clear() override {
+      clear( background );
+   }
+
+   void clear( color col ) override {
+      for( auto & p : pixels ){
+         p = col;
+      }
+      writes += pixels.size();
+   }
+
+   void flush() override {
+      ++flushes;
+      if( ! print ){
+         return;
+      }
+      for( int y = 0; y < size.y; y += 2 ){
+         for( int x = 0; x < size.x; ++x ){
+
+            // two rows of pixels per line of text
+            bool top = read( xy( x, y ) ) != background;
+            bool bottom = ( y + 1 < size.y ) && ( read( xy( x, y + 1 ) ) != background );
+            uart_putc( top ? ( bottom ? '8' : '"' ) : ( bottom ? 'o' : ' ' ) );
+         }
+         uart_putc( '\n' );
+      }
+   }
+
+}; // class window
+
+}; // namespace target
+
+/// the time a sleeping wait spins at its end
+///
+/// The kernel wakes a sleeping process a bit late. A wait sleeps
+/// until this amount of us before its end and spins the rest,
+/// waits shorter than this only spin.
+constexpr int_fast32_t native_spin_us = 100;
+
+/// sleep until the monotonic clock reaches the given tick
+void native_sleep_until( uint_fast64_t ticks );
+
+}; // namespace hwlib
+
+#ifdef _HWLIB_ONCE
+
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstdio>
+
+namespace hwlib {
+
+uint_fast64_t now_ticks(){
+   timespec t;
+   clock_gettime( CLOCK_MONOTONIC, &t );
+   return static_cast< uint_fast64_t >( t.tv_sec ) * 1'000'000'000 + t.tv_nsec;
+}
+
+uint_fast64_t ticks_per_us(){
+   return 1'000;
+}
+
+uint_fast64_t now_us(){
+   return now_ticks() / ticks_per_us();
+}
+
+void native_sleep_until( uint_fast64_t ticks ){
+   timespec t;
+   t.tv_sec  = ticks / 1'000'000'000;
+   t.tv_nsec = ticks % 1'000'000'000;
+
+   // restart when a signal interrupts the sleep
+   while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr ) != 0 ){}
+}
+
+void wait_ns_busy( int_fast32_t n ){
+   auto end = now_ticks() + n;
+   while( now_ticks() < end ){}
+}
+
+void wait_us_busy( int_fast32_t n ){
+   wait_ns_busy( n * 1'000 );
+}
+
+void wait_ms_busy( int_fast32_t n ){
+   while( n > 0 ){
+      wait_us_busy( 1'000 );
+      --n;
+   }
+}
+
+void wait_ns( int_fast32_t n ){
+   auto end = now_ticks() + n;
+   if( n > native_spin_us * 1'000 ){
+      native_sleep_until( end - native_spin_us * 1'000 );
+   }
+   while( now_ticks() < end ){}
+}
+
+void wait_us( int_fast32_t n ){
+   while( n > 1'000'000 ){
+      wait_ns( 1'000'000'000 );
+      n -= 1'000'000;
+   }
+   wait_ns( n * 1'000 );
+}
+
+void wait_ms( int_fast32_t n ){
+   while( n > 1'000 ){
+      wait_us( 1'000'000 );
+      n -= 1'000;
+   }
+   wait_us( n * 1'000 );
+}
+
+void uart_putc( char c ){
+   std::putchar( c );
+   if( c == '\n' ){
+      std::fflush( stdout );
+   }
+}
+
+char uart_getc(){
+   std::fflush( stdout );
+   return std::getchar();
+}
+
+bool HWLIB_WEAK uart_char_available(){
+   pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+   return poll( &fd, 1, 0 ) > 0;
+}
+
+}; // namespace hwlib
+
+#endif // #ifdef _HWLIB_ONCE
+
+#endif // HWLIB_NATIVE_LINUX_H
@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in cardDump.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/cardDump.h"
+
+namespace {
+
+// offsets in the footer
+const size_t magicAt     = 0;
+const size_t versionAt   = 4;
+const size_t sectorsAt   = 5;
+const size_t uidSizeAt   = 6;
+const size_t sakAt       = 7;
+const size_t atqaAt      = 8;
+const size_t uidAt       = 12;
+const size_t bitmapAt    = 24;
+const size_t readTimeAt  = 56;
+const size_t dumpTimeAt  = 64;
+
+static_assert(dumpTimeAt + 8 == dumpFormat::footerSize && bitmapAt + dumpFormat::bitmapSize == readTimeAt);
+
+const cardGeometry* const geometries[] = {&mifareMiniGeometry, &mifare1kGeometry, &mifare4kGeometry};
+
+uint64_t readTime64(const uint8_t *bytes)
+{
+    uint64_t value = 0;
+    for(uint8_t i = 0; i < 8; i++){ value |= static_cast<uint64_t>(bytes[i]) << (8 * i); }
+    return value;
+}
+
+void writeTime64(uint8_t *bytes, uint64_t value)
+{
+    for(uint8_t i = 0; i < 8; i++){ bytes[i] = static_cast<uint8_t>(value >> (8 * i)); }
+}
+
+} // namespace
+
+bool validFooter(const uint8_t *footer, const cardGeometry &geometry)
+{
+    for(uint8_t i = 0; i < 4; i++){
+        if(footer[magicAt + i] != dumpFormat::magic[i]){ return false; }
+    }
+    return footer[versionAt] == dumpFormat::version && footer[sectorsAt] == geometry.sectors && footer[uidSizeAt] <= card::maxUIDsize;
+}
+
+bool dumpRecord::valid() const
+{
+    return validFooter(footer(), layout);
+}
+
+bool dumpRecord::hasBlock(uint16_t page) const
+{
+    if(page >= layout.blocks()){ return false; }
+    return footer()[bitmapAt + page / 8] & (1 << (page % 8));
+}
+
+const uint8_t* dumpRecord::block(uint16_t page) const
+{
+    return hasBlock(page) ? record + page * cardGeometry::blockSize : nullptr;
+}
+
+cardIdentity dumpRecord::identity() const
+{
+    const uint8_t *f = footer();
+    cardIdentity id;
+    id.uidSize = (f[uidSizeAt] <= card::maxUIDsize) ? f[uidSizeAt] : card::maxUIDsize;
+    for(uint8_t i = 0; i < id.uidSize; i++){ id.uid[i] = f[uidAt + i]; }
+    id.atqa[0] = f[atqaAt];
+    id.atqa[1] = f[atqaAt + 1];
+    id.sak = f[sakAt];
+    return id;
+}
+
+uint64_t dumpRecord::readTime() const
+{
+    return readTime64(&footer()[readTimeAt]);
+}
+
+uint64_t dumpRecord::dumpTime() const
+{
+    return readTime64(&footer()[dumpTimeAt]);
+}
+
+size_t writeDump(const card &cardinfo, uint64_t readTime, uint64_t dumpTime, uint8_t *out, size_t capacity)
+{
+    const auto &geometry = cardinfo.geometry();
+    const size_t size = dumpFormat::recordSize(geometry);
+    if(geometry.sectors == 0 || capacity < size){ return 0; }
+
+    uint8_t *f = out + geometry.size();
+    for(size_t i = 0; i < dumpFormat::footerSize; i++){ f[i] = 0; }
+
+    for(uint16_t page = 0; page < geometry.blocks(); page++){
+        const auto data = cardinfo.getPage(page);
+        for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ out[page * cardGeometry::blockSize + i] = data[i]; }
+        if(cardinfo.hasPage(page)){ f[bitmapAt + page / 8] |= 1 << (page % 8); }
+    }
+
+    const auto &identity = cardinfo.getIdentity();
+    for(uint8_t i = 0; i < 4; i++){ f[magicAt + i] = dumpFormat::magic[i]; }
+    f[versionAt]    = dumpFormat::version;
+    f[sectorsAt]    = geometry.sectors;
+    f[uidSizeAt]    = identity.uidSize;
+    f[sakAt]        = identity.sak;
+    f[atqaAt]       = identity.atqa[0];
+    f[atqaAt + 1]   = identity.atqa[1];
+    for(uint8_t i = 0; i < identity.uidSize; i++){ f[uidAt + i] = identity.uid[i]; }
+    writeTime64(&f[readTimeAt], readTime);
+    writeTime64(&f[dumpTimeAt], dumpTime);
+    return size;
+}
+
+const cardGeometry& dumpGeometry(const uint8_t *record, size_t size)
+{
+    for(const auto geometry : geometries){
+        if(size == dumpFormat::recordSize(*geometry) && dumpRecord(record, *geometry).valid()){ return *geometry; }
+    }
+    return noMemory;
+}
+
+void writeFileHeader(const cardGeometry &geometry, uint8_t *out)
+{
+    for(uint8_t i = 0; i < 4; i++){ out[i] = dumpFormat::fileMagic[i]; }
+    out[4] = dumpFormat::fileVersion;
+    out[5] = geometry.sectors;
+    out[6] = 0;
+    out[7] = 0;
+}
+
+const cardGeometry& fileGeometry(const uint8_t *header)
+{
+    for(uint8_t i = 0; i < 4; i++){
+        if(header[i] != dumpFormat::fileMagic[i]){ return noMemory; }
+    }
+    if(header[4] != dumpFormat::fileVersion){ return noMemory; }
+
+    for(const auto geometry : geometries){
+        if(header[5] == geometry->sectors){ return *geometry; }
+    }
+    return noMemory;
+}
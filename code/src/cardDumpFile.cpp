@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in cardDumpFile.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/cardDumpFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+
+// writes all bytes, also when write() is interrupted or only writes a part
+bool writeAll(int fd, const uint8_t *data, size_t nBytes)
+{
+    while(nBytes > 0){
+        const auto n = write(fd, data, nBytes);
+        if(n < 0 && errno == EINTR){ continue; }
+        if(n <= 0){ return false; }
+        data += n;
+        nBytes -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+
+// dumpWriter
+
+dumpWriter::dumpWriter(const char *path)
+{
+    fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd < 0){ return; }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0){ close(fd); fd = -1; return; }
+    if(info.st_size == 0){ return; }
+
+    uint8_t header[dumpFormat::fileHeaderSize];
+    if(pread(fd, header, sizeof(header), 0) == sizeof(header)){ layout = fileGeometry(header); }
+    if(layout.sectors == 0){ close(fd); fd = -1; return; }
+
+    // a part of a record after the last whole record is removed, so new records line up again
+    const size_t recordSize = dumpFormat::recordSize(layout);
+    const size_t records = static_cast<size_t>(info.st_size) - dumpFormat::fileHeaderSize;
+    const auto whole = static_cast<off_t>(dumpFormat::fileHeaderSize + records / recordSize * recordSize);
+    if(whole != info.st_size && ftruncate(fd, whole) != 0){ close(fd); fd = -1; }
+}
+
+dumpWriter::~dumpWriter()
+{
+    if(fd >= 0){ close(fd); }
+}
+
+bool dumpWriter::append(const card &cardinfo, uint64_t readTime, uint64_t dumpTime)
+{
+    const auto &geometry = cardinfo.geometry();
+    if(fd < 0 || geometry.sectors == 0){ return false; }
+    if(layout.sectors != 0 && layout.sectors != geometry.sectors){ return false; }
+
+    // the first record of a file is written together with the file header
+    uint8_t buffer[dumpFormat::fileHeaderSize + dumpFormat::recordSize(mifare4kGeometry)];
+    const size_t start = (layout.sectors == 0) ? 0 : dumpFormat::fileHeaderSize;
+    writeFileHeader(geometry, buffer);
+    const auto size = writeDump(cardinfo, readTime, dumpTime, &buffer[dumpFormat::fileHeaderSize], sizeof(buffer) - dumpFormat::fileHeaderSize);
+    if(size == 0){ return false; }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0){ return false; }
+    if(!writeAll(fd, &buffer[start], dumpFormat::fileHeaderSize + size - start)){
+        // remove the part of the record that has been written, so the file still ends with a whole record.
+        // When that fails as well, new records would not line up anymore, so the writer stops
+        if(ftruncate(fd, info.st_size) != 0){ close(fd); fd = -1; }
+        return false;
+    }
+
+    layout = geometry;
+    return true;
+}
+
+
+// dumpFile
+
+dumpFile::dumpFile(const char *path)
+{
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0){ return; }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < dumpFormat::fileHeaderSize){ return; }
+
+    void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(mapping == MAP_FAILED){ return; }
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    base = static_cast<const uint8_t*>(mapping);
+    size = info.st_size;
+    layout = fileGeometry(base);
+}
+
+dumpFile::~dumpFile()
+{
+    if(base != nullptr){ munmap(const_cast<uint8_t*>(base), size); }
+    if(fd >= 0){ close(fd); }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in cardImage.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/cardImage.h"
+
+namespace nfc{
+
+cardImage::cardImage(NFC &reader, card &cardinfo, const cardKeys &keys, const mifareCommands keyType):
+    reader(reader),
+    cardinfo(cardinfo),
+    keys(keys),
+    keyType(keyType)
+{}
+
+const uint8_t* cardImage::sectorKey(const uint8_t sector) const
+{
+    return (keyType == mifareCommands::authenticateKeyB) ? keys.bKeys[sector] : keys.aKeys[sector];
+}
+
+statusCode cardImage::load(const uint16_t page)
+{
+    if(page >= cardinfo.geometry().blocks()){ return statusCode::pn532StatusInvalidParameter; }
+    if(cardinfo.hasPage(page)){
+        stats.hits++;
+        return statusCode::pn532StatusOK;
+    }
+
+    auto status = reader.mifareReadBlock(cardinfo, cardinfo.getTargetNumber(), keyType, page, sectorKey(cardGeometry::sectorOf(page)));
+    if(status == statusCode::pn532StatusOK){ stats.reads++; }
+    return status;
+}
+
+statusCode cardImage::loadSector(const uint8_t sector)
+{
+    if(sector >= cardinfo.geometry().sectors){ return statusCode::pn532StatusInvalidParameter; }
+
+    // the first read authenticates the sector, the others use the same session
+    const uint16_t first = cardGeometry::firstBlock(sector);
+    for(uint16_t page = first; page < first + cardGeometry::blocksIn(sector); page++){
+        auto status = load(page);
+        if(status != statusCode::pn532StatusOK){ return status; }
+    }
+    return statusCode::pn532StatusOK;
+}
+
+statusCode cardImage::getPage(const uint16_t page, block &data)
+{
+    auto status = load(page);
+    data = (status == statusCode::pn532StatusOK) ? cardinfo.getPage(page) : block{};
+    return status;
+}
+
+statusCode cardImage::setPage(const uint16_t page, const block &data)
+{
+    if(page == 0 || page >= cardinfo.geometry().blocks()){ return statusCode::pn532StatusInvalidParameter; }
+
+    // a block that is already on the card does not have to be written again
+    if(cardinfo.hasPage(page) && !cardinfo.isDirty(page) && cardinfo.getPage(page) == data){ return statusCode::pn532StatusOK; }
+    cardinfo.setPage(page, data.data());
+    return statusCode::pn532StatusOK;
+}
+
+statusCode cardImage::commit()
+{
+    for(uint8_t sector = 0; sector < cardinfo.geometry().sectors; sector++){
+        auto status = commitSector(sector);
+        if(status != statusCode::pn532StatusOK){ return status; }
+    }
+    return statusCode::pn532StatusOK;
+}
+
+statusCode cardImage::commitSector(const uint8_t sector)
+{
+    if(sector >= cardinfo.geometry().sectors){ return statusCode::pn532StatusInvalidParameter; }
+
+    // the trailer is the last block of the sector, so it is written after the data blocks
+    const uint16_t first = cardGeometry::firstBlock(sector);
+    for(uint16_t page = first; page < first + cardGeometry::blocksIn(sector); page++){
+        if(!cardinfo.isDirty(page)){ continue; }
+        auto status = writePage(page);
+        if(status != statusCode::pn532StatusOK){ return status; }
+    }
+    return statusCode::pn532StatusOK;
+}
+
+statusCode cardImage::writePage(const uint16_t page)
+{
+    const uint8_t *key = sectorKey(cardGeometry::sectorOf(page));
+    const block written = cardinfo.getPage(page);
+
+    auto status = reader.mifareWriteBlock(cardinfo, cardinfo.getTargetNumber(), keyType, page, key, written.data());
+    if(status != statusCode::pn532StatusOK){ return status; }
+
+    // the read back stores what the card holds in the image
+    cardinfo.markClean(page);
+    status = reader.mifareReadBlock(cardinfo, cardinfo.getTargetNumber(), keyType, page, key);
+
+    // key A of a trailer reads as 0's, key B depends on the access bits: of a trailer only the access bits are compared
+    const bool trailer = cardGeometry::isTrailer(page);
+    const auto readBack = cardinfo.getPage(page);
+    bool same = status == statusCode::pn532StatusOK;
+    for(uint8_t i = trailer ? 6 : 0; same && i < (trailer ? 10 : cardGeometry::blockSize); i++){ same = readBack[i] == written[i]; }
+
+    if(!same){
+        cardinfo.setPage(page, written.data());
+        return (status != statusCode::pn532StatusOK) ? status : statusCode::pn532StatusVerifyError;
+    }
+
+    // the image keeps the keys that have been written
+    if(trailer){
+        cardinfo.setPage(page, written.data());
+        cardinfo.markClean(page);
+    }
+    stats.writes++;
+    return statusCode::pn532StatusOK;
+}
+
+} // namespace nfc
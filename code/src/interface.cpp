@@ -10,6 +10,59 @@
 
 namespace communication{
 
+// protocol default implementations
+
+void protocol::sendData(const segment *segments, size_t count)
+{
+    uint8_t buffer[nfc::pn532::general::commandBufferSize];
+    size_t nBytes = 0;
+    for(size_t i = 0; i < count; i++){ nBytes += segments[i].length; }
+
+    // a part of the frame would be another frame, so a frame that does not fit is not send at all
+    if(nBytes > sizeof(buffer)){ return; }
+
+    nBytes = 0;
+    for(size_t i = 0; i < count; i++){
+        for(size_t j = 0; j < segments[i].length; j++){ buffer[nBytes++] = segments[i].data[j]; }
+    }
+    sendData(buffer, nBytes);
+}
+
+
+// ready strategy implementations
+
+readyStrategy::readyStrategy(const uint_fast32_t pollInterval): pollInterval(pollInterval)
+{}
+
+bool readyStrategy::poll()
+{
+    if(isReady()){ return true; }
+    if(pollInterval > 0){ hwlib::wait_us(pollInterval); }
+    return false;
+}
+
+irqReady::irqReady(hwlib::pin_in &irq, const uint_fast32_t pollInterval):
+    readyStrategy(pollInterval),
+    irq(irq)
+{}
+
+bool irqReady::isReady()
+{
+    irq.refresh();
+    return !irq.read();
+}
+
+statusReady::statusReady(protocol &bus, const uint_fast32_t pollInterval):
+    readyStrategy(pollInterval),
+    bus(bus)
+{}
+
+bool statusReady::isReady()
+{
+    return bus.isReady();
+}
+
+
 // i2c function implementations
 
 i2c::i2c(
@@ -25,14 +78,52 @@ void i2c::wakeUp()
    bus.write(adress).write(adress);
 }
 
-void i2c::sendData(uint8_t *commandBuffer, uint8_t nBytes)
+void i2c::sendData(const uint8_t *commandBuffer, size_t nBytes)
 {
     bus.write(adress).write(commandBuffer, nBytes);
 }
 
-void i2c::receiveData(uint8_t *receiveBuffer, uint8_t nBytes)
+void i2c::sendData(const segment *segments, size_t count)
+{
+    auto transaction = bus.write(adress);
+    for(size_t i = 0; i < count; i++){
+        transaction.write(segments[i].data, segments[i].length);
+    }
+}
+
+void i2c::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    endTransaction();
+
+    // the same steps as a hwlib::i2c_read_transaction, but the read is kept open for receiveMore
+    bus.primitives.write_start();
+    bus.primitives.write((adress << 1) | 0x01);
+    bus.primitives.read_ack();
+    reading = true;
+
+    uint8_t status;
+    bus.primitives.read(true, &status, 1);
+    bus.primitives.read(false, receiveBuffer, nBytes);
+}
+
+void i2c::receiveMore(uint8_t *receiveBuffer, size_t nBytes)
+{
+    if(!reading){ receiveData(receiveBuffer, nBytes); return; }
+    bus.primitives.read(false, receiveBuffer, nBytes);
+}
+
+void i2c::endTransaction()
+{
+    if(!reading){ return; }
+    bus.primitives.read_ack();
+    bus.primitives.write_stop();
+    reading = false;
+}
+
+bool i2c::isReady()
 {
-    bus.read(adress).read(receiveBuffer, nBytes);
+    endTransaction();
+    return (bus.read(adress).read_byte() & 0x01) != 0;
 }
 
 
@@ -55,29 +146,66 @@ void spi::wakeUp()
     sel.flush();
 }
 
-void spi::sendData(uint8_t *commandBuffer, uint8_t nBytes)
+void spi::sendData(const uint8_t *commandBuffer, size_t nBytes)
 {
-    bus.transaction(sel).write(1);
-    bus.transaction(sel).write(nBytes, commandBuffer);
+    const segment frame{commandBuffer, nBytes};
+    sendData(&frame, 1);
+}
+
+void spi::sendData(const segment *segments, size_t count)
+{
+    // the data write (0x01) and all segments in one transaction, sel stays low until endTransaction
+    auto transaction = bus.transaction(sel);
+    transaction.write(dataWrite);
+    for(size_t i = 0; i < count; i++){
+        transaction.write(segments[i].length, segments[i].data);
+    }
 }
 
+void spi::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    auto transaction = bus.transaction(sel);
+    transaction.write(dataRead);
+    transaction.read(nBytes, receiveBuffer);
+}
 
-void spi::receiveData(uint8_t *receiveBuffer, uint8_t nBytes)
+void spi::receiveMore(uint8_t *receiveBuffer, size_t nBytes)
 {
-    bus.transaction(sel).write(3);
-    bus.transaction(sel).read(nBytes, receiveBuffer);
+    // sel is still low, the read simply continues without writing sel again
+    bus.continued_transaction(sel).read(nBytes, receiveBuffer);
 }
 
 void spi::endTransaction()
 {
-    bus.transaction(sel).endTransaction();
+    sel.write(1);
+    sel.flush();
+}
+
+bool spi::isReady()
+{
+    auto transaction = bus.transaction(sel);
+    transaction.write(statusRead);
+    const uint8_t status = transaction.read_byte();
+    transaction.endTransaction();
+    return (status & 0x01) != 0;
 }
 
 
 
 // UART specific functions
 
-uart::uart(hwuart::uart_abstract& bus):bus(bus){
+uartReady::uartReady(hwuart::uart_abstract &bus, const uint_fast32_t timeout):
+    readyStrategy(0),
+    bus(bus),
+    timeout(timeout)
+{}
+
+bool uartReady::isReady()
+{
+    return bus.waitReadable(timeout);
+}
+
+uart::uart(hwuart::uart_abstract& bus, const uint_fast32_t timeout):bus(bus), timeout(timeout){
     wakeUp();
 }
 
@@ -87,23 +215,38 @@ void uart::wakeUp()
     sendData(wake, 7);
 }
 
-void uart::sendData(uint8_t *commandBuffer, uint8_t nBytes)
+void uart::sendData(const uint8_t *commandBuffer, size_t nBytes)
 {
-    for(int i = 0; i < nBytes; i++){
-        bus.sendByte(commandBuffer[i]);
-    }
+    bus.sendBytes(commandBuffer, nBytes);
 }
 
-void uart::receiveData(uint8_t *receiveBuffer, uint8_t nBytes)
+void uart::sendData(const segment *segments, size_t count)
 {
-    for(int i = 0; i < nBytes; i++){
-         while(!bus.rxReady()){} // wait till the bus is ready
-        bus.storeByte(bus.getC());
-    }
-   
-    for(int i = 0; i < bus.avialable(); i++){
-        receiveBuffer[i] = bus.getC();
+    // gather the segments, so the frame is one bulk write
+    protocol::sendData(segments, count);
+}
+
+void uart::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    const size_t n = bus.receiveBytes(receiveBuffer, nBytes, timeout);
+    for(size_t i = n; i < nBytes; i++){
+        receiveBuffer[i] = 0x00;
     }
 }
+
+bool uart::isReady()
+{
+    return bus.avialable() > 0 || bus.rxReady();
+}
+
+bool uart::setBaudrate(const uint32_t baudrate)
+{
+    return bus.setBaudrate(baudrate);
+}
+
+uint32_t uart::getBaudrate() const
+{
+    return bus.getBaudrate();
+}
     
 } // namespace communication
\ No newline at end of file
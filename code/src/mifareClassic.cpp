@@ -9,50 +9,154 @@
 
 #include "../headers/mifareClassic.h"
 
-void card::addPage(uint8_t *bytes, size_t bytesSize, int pageNumber)
+void card::addPage(const uint8_t *bytes, size_t bytesSize, int pageNumber)
 {
+    const auto pageSize = cardGeometry::blockSize;
+    if(pageNumber < 0 || pageNumber >= geometry().blocks()){ return; }
+
+    // a changed page keeps its new content until it has been written
+    if(isDirty(pageNumber)){ return; }
+
+    uint8_t *data = memory();
     int j = 0;
-    for (size_t i = 5; i < bytesSize; i++)
+    for (size_t i = 5; i < bytesSize && j < pageSize; i++)
     {
-        cardData[(pageNumber * pageSize) + j] = bytes[i];
+        data[(pageNumber * pageSize) + j] = bytes[i];
         j++;
     }
+
+    // only a complete page counts as read
+    if(j == pageSize){ validBlocks()[pageNumber / 32] |= uint32_t(1) << (pageNumber % 32); }
 }
 
-void card::readPage(int pageNumber) const
+bool card::hasPage(uint16_t page) const
+{
+    if(page >= geometry().blocks()){ return false; }
+    return validBlocks()[page / 32] & (uint32_t(1) << (page % 32));
+}
+
+uint16_t card::pagesRead() const
+{
+    uint16_t n = 0;
+    for(uint16_t page = 0; page < geometry().blocks(); page++){
+        if(hasPage(page)){ n++; }
+    }
+    return n;
+}
+
+void card::clearPages()
+{
+    uint8_t *data = memory();
+    for(uint16_t i = 0; i < geometry().size(); i++){ data[i] = 0; }
+
+    uint32_t *valid = validBlocks();
+    uint32_t *dirty = dirtyBlocks();
+    for(uint8_t i = 0; i < geometry().bitmapWords(); i++){ valid[i] = 0; dirty[i] = 0; }
+}
+
+void card::setPage(uint16_t page, const uint8_t* data)
+{
+    const auto pageSize = cardGeometry::blockSize;
+    if(page >= geometry().blocks()){ return; }
+
+    uint8_t *memoryData = memory();
+    for(uint8_t i = 0; i < pageSize; i++){ memoryData[page * pageSize + i] = data[i]; }
+    validBlocks()[page / 32] |= uint32_t(1) << (page % 32);
+    dirtyBlocks()[page / 32] |= uint32_t(1) << (page % 32);
+}
+
+bool card::isDirty(uint16_t page) const
+{
+    if(page >= geometry().blocks()){ return false; }
+    return dirtyBlocks()[page / 32] & (uint32_t(1) << (page % 32));
+}
+
+uint16_t card::pagesDirty() const
+{
+    uint16_t n = 0;
+    for(uint16_t page = 0; page < geometry().blocks(); page++){
+        if(isDirty(page)){ n++; }
+    }
+    return n;
+}
+
+void card::markClean(uint16_t page)
 {
+    if(page >= geometry().blocks()){ return; }
+    dirtyBlocks()[page / 32] &= ~(uint32_t(1) << (page % 32));
+}
 
-    for (size_t i = (pageNumber * pageSize) + 0; i < ((pageNumber * pageSize) + pageSize); i++)
+void card::readPage(int pageNumber) const
+{
+    for (const auto byte : getPage(pageNumber))
     {
-        hwlib::cout << "0x" << hwlib::setw(2) << hwlib::setfill('0') << hwlib::hex << cardData[i] << "  ";
+        hwlib::cout << "0x" << hwlib::setw(2) << hwlib::setfill('0') << hwlib::hex << byte << "  ";
     }
     hwlib::cout << hwlib::endl;
 }
 
 void card::setUID(receivedCommand& response){
-    for(uint8_t i = 0; i < response.finalBuffer[9]; i++){
-        cardUID[i] = response.finalBuffer[i+10];
-    }
+    setUID(&response.finalBuffer[10], response.finalBuffer[9]);
 }
 
-void card::setUID(uint8_t* uid){
-    for(uint8_t i = 0; i < 4; i++){
-        cardUID[i] = uid[i];
+void card::setUID(const uint8_t* uid, uint8_t length){
+    clearSession();
+    if(length > maxUIDsize){ length = maxUIDsize; }
+
+    cardIdentity selected;
+    for(uint8_t i = 0; i < length; i++){
+        selected.uid[i] = uid[i];
+    }
+    selected.uidSize = length;
+
+    // another card: what has been read from the old one is no longer valid
+    if(selected != identity){
+        identity = selected;
+        clearPages();
     }
 }
 
-std::array<uint8_t, 4> card::getUID() const {
-    return cardUID;
+void card::setTargetData(const uint8_t* atqa, uint8_t sak){
+    identity.atqa[0] = atqa[0];
+    identity.atqa[1] = atqa[1];
+    identity.sak = sak;
+}
+
+const uint8_t* card::authenticationUID() const
+{
+    const auto uidSize = identity.uidSize;
+    return (uidSize > nfc::pn532::general::Mifare1kUIDsize) ? &identity.uid[uidSize - nfc::pn532::general::Mifare1kUIDsize] : identity.uid.data();
 }
 
 std::array<uint8_t, nfc::pn532::general::Mifare1kPageSize> card::getPage(uint8_t page) const{
     using nfc::pn532::general::Mifare1kPageSize;
 
-    uint8_t j = 0;
     std::array<uint8_t, Mifare1kPageSize> pageData = {};
-    for(int i = page*Mifare1kPageSize; i < (page*Mifare1kPageSize)+Mifare1kPageSize; i++){
-        pageData[j] = cardData[i];
-        j++;
+    if(page >= geometry().blocks()){ return pageData; }
+
+    const uint8_t *data = memory();
+    for(uint8_t i = 0; i < Mifare1kPageSize; i++){
+        pageData[i] = data[page * Mifare1kPageSize + i];
     }
     return pageData;
- }
\ No newline at end of file
+ }
+
+void card::setSession(uint_fast32_t generation, uint8_t cardNumber, uint8_t sector, uint8_t keyType, const uint8_t* key)
+{
+    session.generation  = generation;
+    session.cardNumber  = cardNumber;
+    session.sector      = sector;
+    session.keyType     = keyType;
+    for(uint8_t i = 0; i < 6; i++){ session.key[i] = key[i]; }
+}
+
+bool card::hasSession(uint_fast32_t generation, uint8_t cardNumber, uint8_t sector, uint8_t keyType, const uint8_t* key) const
+{
+    if(session.generation != generation || session.cardNumber != cardNumber || session.sector != sector || session.keyType != keyType){
+        return false;
+    }
+    for(uint8_t i = 0; i < 6; i++){
+        if(session.key[i] != key[i]){ return false; }
+    }
+    return true;
+}
@@ -23,6 +23,21 @@ PN532_chip::PN532_chip(
             hwlib::pin_in& irq
     ):
             NFC(_protocol),
+            defaultReady(irq),
+            ready(defaultReady),
+            irq(irq)
+    {
+        init();
+    }
+
+PN532_chip::PN532_chip(
+            communication::protocol& _protocol,
+            hwlib::pin_in& irq,
+            communication::readyStrategy& ready
+    ):
+            NFC(_protocol),
+            defaultReady(irq),
+            ready(ready),
             irq(irq)
     {
         init();
@@ -36,36 +51,42 @@ PN532_chip::PN532_chip(
 
 void PN532_chip::init()
 {
-     _protocol.wakeUp();
+    _protocol.wakeUp();
+    power = powerState::awake;
+    lastActivity = hwlib::now_ticks();
 }
 
-void PN532_chip::sendData(uint8_t *commandBuffer, const uint8_t nBytes)
+void PN532_chip::wakeIfNeeded()
 {
-    _protocol.wakeUp();
+    const auto now = hwlib::now_ticks();
+    const bool idle = (now - lastActivity) >= (static_cast<uint_fast64_t>(idleTimeout) * 1000 * hwlib::ticks_per_us());
+    if(power != powerState::awake || idle){
+        _protocol.wakeUp();
+        power = powerState::awake;
+    }
+    lastActivity = now;
+}
+
+void PN532_chip::sendData(const uint8_t *commandBuffer, const size_t nBytes)
+{
+    wakeIfNeeded();
     _protocol.sendData(commandBuffer, nBytes);
     _protocol.endTransaction();
 }
 
-void PN532_chip::getData(uint8_t *buffer, const uint8_t nBytes)
+void PN532_chip::getData(uint8_t *buffer, const size_t nBytes)
 {
     _protocol.receiveData(buffer, nBytes);
 }
 
 statusCode PN532_chip::writeRegister(const uint16_t reg, const uint8_t val){
 
-    uint8_t adrH = ( reg >> 8 ) & 0xFF;
-    uint8_t adrL = ( reg & 0xFF);
-
-    uint8_t commands[] = {
-        pn532::command::writeRegister,
-        adrH,
-        adrL,
-        val
-    };
+    auto frame = pn532::frames::writeRegister;
+    frame.set(1, ( reg >> 8 ) & 0xFF);
+    frame.set(2, ( reg & 0xFF));
+    frame.set(3, val);
 
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3] != 0x09) {return statusCode::pn532StatusWrongCommand;}
@@ -76,18 +97,11 @@ statusCode PN532_chip::writeRegister(const uint16_t reg, const uint8_t val){
 std::array<uint8_t, 2> PN532_chip::readRegister(const uint16_t reg){
     std::array<uint8_t, 2> readRegister = {0};
 
-    uint8_t adrH = ( reg >> 8 ) & 0xFF;
-    uint8_t adrL = ( reg & 0xFF );
-
-    uint8_t commands[] = {
-        pn532::command::readRegister,
-        adrH,
-        adrL
-    };
+    auto frame = pn532::frames::readRegister;
+    frame.set(1, ( reg >> 8 ) & 0xFF);
+    frame.set(2, ( reg & 0xFF ));
 
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {readRegister[0] = pass; return readRegister;}
 
     if(response.finalBuffer[3] != 0x07) {readRegister[0] = statusCode::pn532StatusWrongCommand; return readRegister;}
@@ -105,15 +119,11 @@ statusCode PN532_chip::writeGPIO(uint8_t newPinState){
     // set validation bit
     newPinState |= pn532::command::GPIO::validationBit;
 
-    uint8_t commands[] = {
-        pn532::command::writeGPIO,
-        newPinState,
-        0x00        // p72 and p71 are reserved and thus not used.
-    };
-
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
+    // p72 and p71 are reserved and thus not used.
+    auto frame = pn532::frames::writeGPIO;
+    frame.set(1, newPinState);
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3] == 0x0F) { return statusCode::pn532StatusOK;}
@@ -122,13 +132,7 @@ statusCode PN532_chip::writeGPIO(uint8_t newPinState){
 
 std::array<uint8_t, 2> PN532_chip::readGPIO(){
     std::array<uint8_t, 2> readGPIO = {0};
-    uint8_t commands[] = {
-        pn532::command::readGPIO
-    };
-
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(pn532::frames::readGPIO);
     if(pass != statusCode::pn532StatusOK) {readGPIO[0] = pass; return readGPIO;}
 
     if(response.finalBuffer[3] != 0x0D) { readGPIO[0] = statusCode::pn532StatusWrongCommand; return readGPIO;}
@@ -148,55 +152,224 @@ std::array<uint8_t, 2> PN532_chip::readGPIO(){
 
 bool PN532_chip::waitForChip(const int timeout)
 {
-    int timer = 0;
-    while (timer < timeout)
+    const uint_fast64_t deadline = hwlib::now_ticks() + (static_cast<uint_fast64_t>(timeout) * 1000 * hwlib::ticks_per_us());
+    do
     {
-        if (!irq.read()){ return true;}
-        hwlib::wait_ms(10);
-        timer += 10;
-    }
+        if (ready.poll()){ return true;}
+    } while (hwlib::now_ticks() < deadline);
     return false;
 }
 
 bool PN532_chip::checkAck(const uint8_t *buffer, const uint8_t n)
 {
-    // the ack buffers for spi and i2c slightly differ. 
-    if(buffer[0] != 0x00){
-        for (uint8_t i = 0; i < n-1; i++){
-            if (pn532::general::Ack_buffer_template_i2c[i] != buffer[i]){
-                return false;
-            }
+    if(n < sizeof(pn532::general::Ack_buffer_template)){ return false; }
+    for (uint8_t i = 0; i < sizeof(pn532::general::Ack_buffer_template); i++){
+        if (pn532::general::Ack_buffer_template[i] != buffer[i]){
+            return false;
         }
-        return true;
+    }
+    return true;
+}
+
+PN532_chip::frameType PN532_chip::readFrame()
+{
+    using namespace pn532::general;
+
+    // preamble, start code, LEN and LCS
+    getData(ackBuffer, 5);
+
+    // over spi the first preamble byte can be missing. Shift the header so it always starts with the preamble,
+    // the byte after LCS has then already been read and is stored in ackBuffer[5]
+    uint8_t extra = 0;
+    if(ackBuffer[0] == Preamble1 && ackBuffer[1] == Preamble2){
+        for(uint8_t i = 5; i > 0; i--){ ackBuffer[i] = ackBuffer[i - 1]; }
+        ackBuffer[0] = Preamble1;
+        extra = 1;
+    }
+    if(ackBuffer[1] != Preamble1 || ackBuffer[2] != Preamble2){ return frameType::invalid; }
+
+    const uint8_t len = ackBuffer[3];
+    const uint8_t lcs = ackBuffer[4];
+
+    // ACK and NACK frames only have a postamble left
+    if((len == 0x00 && lcs == 0xFF) || (len == 0xFF && lcs == 0x00)){
+        if(extra == 0){ _protocol.receiveMore(&ackBuffer[5], 1); }
+        return len == 0x00 ? frameType::ack : frameType::nack;
+    }
+
+    uint16_t length = len;
+    if(len == 0xFF && lcs == 0xFF){
+        // extended frame: LENM, LENL and LCS follow. User manual p.29
+        _protocol.receiveMore(&ackBuffer[5 + extra], 3 - extra);
+        extra = 0;
+        length = (ackBuffer[5] << 8) | ackBuffer[6];
+        if(static_cast<uint8_t>(ackBuffer[5] + ackBuffer[6] + ackBuffer[7]) != 0x00){ return frameType::invalid; }
+        frameBuffer[1] = ackBuffer[7];
     }else{
-        for (uint8_t i = 0; i < n-2; i++){
-            if (pn532::general::Ack_buffer_template_spi[i] != buffer[i]){
-                return false;
-            }
-        }
-       return true;
-    }  
+        frameBuffer[1] = lcs;
+    }
+    if(length == 0 || length > maxFrameLength){ return frameType::invalid; }
+    frameBuffer[0] = length & 0xFF;
+
+    // TFI, packet data, DCS and postamble
+    if(extra == 1){ frameBuffer[2] = ackBuffer[5]; }
+    _protocol.receiveMore(&frameBuffer[2 + extra], length + 2 - extra);
+    frameLength = length + 4;
+
+    return frameType::information;
 }
 
 Result PN532_chip::sendCommandAndCheckAck(setupSendCommand &command)
 {
-    sendData(command.finalbuffer, command.length);
-    if (!waitForChip()) {return Result{statusCode::pn532StatusTimeout, receivedCommand()};}
-    hwlib::wait_ms(10);
+    const communication::segment segment{command.finalbuffer, command.length};
+    return sendCommandAndCheckAck(&segment, 1);
+}
 
-    getData(ackBuffer, 7); // size of the ack buffer
+Result PN532_chip::sendCommandAndCheckAck(const communication::segment* segments, const size_t count)
+{
+    const auto status = submit(segments, count);
+    if(status != statusCode::pn532StatusOK) {return Result{status, receivedCommand()};}
 
-    if(!checkAck(ackBuffer, (sizeof(ackBuffer) / sizeof(ackBuffer[0])))) return Result{statusCode::pn532StatusInvalidAckFrame, receivedCommand()};
-    
-    if (!waitForChip()) {return Result{statusCode::pn532StatusTimeout, receivedCommand()};}
+    while(inProgress(poll())){
+        waitForChip();
+    }
+    return fetch();
+}
+
+// ------------------------------------------------------------------------------- //
+// Asynchronous command functions                                                  //
+// ------------------------------------------------------------------------------- //
+
+namespace {
+    // time in ms the pn532 gets for the ACK frame, and again for the response
+    const uint_fast64_t commandTimeout = 2000;
+
+    uint_fast64_t deadlineFromNow(const uint_fast64_t timeout = commandTimeout)
+    {
+        if(timeout == 0){ return ~static_cast<uint_fast64_t>(0); }
+        return hwlib::now_ticks() + (timeout * 1000 * hwlib::ticks_per_us());
+    }
+}
+
+statusCode PN532_chip::submit(const communication::segment* segments, const size_t count, commandListener* listener)
+{
+    if(inProgress(state)) {return statusCode::pn532StatusBusy;}
+
+    // an empty frame is a command that could not be build, a frame that is too long can not be send whole
+    size_t nBytes = 0;
+    for(size_t i = 0; i < count; i++){ nBytes += segments[i].length; }
+    if(nBytes == 0 || nBytes > pn532::general::commandBufferSize) {return statusCode::pn532StatusInvalidParameter;}
+
+    wakeIfNeeded();
+    _protocol.sendData(segments, count);
+    _protocol.endTransaction();
+
+    state = commandState::waitingForAck;
+    commandStatus = statusCode::pn532StatusBusy;
+    nacksSent = 0;
+    this->listener = listener;
+    deadline = deadlineFromNow();
+    responseTimeout = commandTimeout;
+    return statusCode::pn532StatusOK;
+}
+
+commandState PN532_chip::poll()
+{
+    if(!inProgress(state)) {return state;}
 
-    uint8_t databuffer[64] = {0};
-    getData(databuffer, 40);
+    if(!ready.isReady()){
+        if(hwlib::now_ticks() >= deadline){ finish(commandState::failed, statusCode::pn532StatusTimeout); }
+        return state;
+    }
 
+    const auto type = readFrame();
     _protocol.endTransaction();
 
-    auto response = receivedCommand(databuffer, 64);
-    return Result{statusCode::pn532StatusOK, response};
+    if(state == commandState::waitingForAck){
+        if(type != frameType::ack || !checkAck(ackBuffer, sizeof(pn532::general::Ack_buffer_template))){
+            finish(commandState::failed, statusCode::pn532StatusInvalidAckFrame);
+            return state;
+        }
+        state = commandState::waitingForResponse;
+        deadline = deadlineFromNow(responseTimeout);
+        if(listener != nullptr){ listener->acknowledged(); }
+        return state;
+    }
+
+    if(type == frameType::information && receivedCommand(frameBuffer, frameLength).isSucces){
+        finish(commandState::done, statusCode::pn532StatusOK);
+        return state;
+    }
+
+    // the response has been damaged on the way. A NACK makes the pn532 send it again, without executing the command again
+    linkStats.checksumErrors++;
+    if(nacksSent < maxNacks){
+        nacksSent++;
+        linkStats.retransmits++;
+        sendData(pn532::general::Nack_buffer_template, sizeof(pn532::general::Nack_buffer_template));
+        deadline = deadlineFromNow();
+        return state;
+    }
+
+    linkStats.unrecovered++;
+    finish(commandState::failed, (type == frameType::information) ? statusCode::pn532StatusChecksumError : statusCode::pn532StatusInvalidAckFrame);
+    return state;
+}
+
+Result PN532_chip::fetch()
+{
+    if(state == commandState::done) {return Result{statusCode::pn532StatusOK, receivedCommand(frameBuffer, frameLength)};}
+    return Result{commandStatus, receivedCommand()};
+}
+
+void PN532_chip::cancel()
+{
+    if(!inProgress(state)) {return;}
+
+    sendData(pn532::general::Ack_buffer_template, sizeof(pn532::general::Ack_buffer_template));
+    state = commandState::cancelled;
+    commandStatus = statusCode::pn532StatusCancelled;
+    listener = nullptr;
+    sessionGeneration++;
+}
+
+bool PN532_chip::endsSession() const
+{
+    namespace cmd = pn532::command;
+
+    // frameBuffer: LEN, LCS, TFI, response code, data
+    switch(static_cast<uint8_t>(frameBuffer[3] - 1)){
+    case cmd::InDataExchange:
+        return frameLength < 5 || (frameBuffer[4] & 0x3F) != 0x00;
+    case cmd::InListPassiveTarget:
+    case cmd::InAutoPoll:
+    case cmd::InSelect:
+    case cmd::InDeselect:
+    case cmd::InRelease:
+    case cmd::RFConfiguration:
+    case cmd::SAMConfiguration:
+    case cmd::PowerDown:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void PN532_chip::finish(const commandState newState, const statusCode status)
+{
+    state = newState;
+    commandStatus = status;
+    lastActivity = hwlib::now_ticks();
+
+    // the chip might have been reset or powered down, so wake it before the next command
+    if(newState == commandState::failed){ power = powerState::unknown; }
+
+    // the card can not be trusted to be authenticated anymore
+    if(newState != commandState::done || endsSession()){ sessionGeneration++; }
+
+    auto notify = listener;
+    listener = nullptr;
+    if(notify != nullptr){ notify->finished(fetch()); }
 }
 
 // ------------------------------------------------------------------------------- //   
@@ -205,21 +378,15 @@ Result PN532_chip::sendCommandAndCheckAck(setupSendCommand &command)
 
 statusCode PN532_chip::performSelftest()
 {
-    const uint8_t dummyData[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
-    const uint8_t commands[] = {
-        pn532::command::PerformSelftest,
-        pn532::command::diagnose::CommunicationLineTest,
-        dummyData[0], dummyData[1], dummyData[2], dummyData[3],
-        dummyData[4], dummyData[5], dummyData[6]};
-
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(commands[0]));
+    // the dummy data is command byte 2 till 8 of the precomputed frame
+    const auto& frame = pn532::frames::performSelftest;
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     for (int i = 0; i < 7; i++)
     {
-        if(response.finalBuffer[i+5] != dummyData[i])
+        if(response.finalBuffer[i+5] != frame.get(i + 2))
         {
             return statusCode::pn532StatusSelftestFail;
         }          
@@ -232,11 +399,7 @@ statusCode PN532_chip::performSelftest()
 std::array<uint8_t, 5> PN532_chip::getGeneralStatus()
 {
     std::array<uint8_t, 5> generalStatus = {0};
-    uint8_t commands[] = {
-        pn532::command::getGeneralStatus};
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(pn532::frames::getGeneralStatus);
     if(pass != statusCode::pn532StatusOK) {generalStatus[0] = statusCode::pn532StatusInvalidAckFrame; return generalStatus;}
 
     generalStatus[0] = statusCode::pn532StatusOK;
@@ -251,12 +414,7 @@ std::array<uint8_t, 5> PN532_chip::getFirmwareVersion()
 {
     std::array<uint8_t, 5> firmwareVersion = {0};
 
-    uint8_t commands[] = {
-        pn532::command::GetFirmwareVersion
-    };
-    
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(pn532::frames::GetFirmwareVersion);
     if(pass != statusCode::pn532StatusOK) {firmwareVersion[0] = pass; return firmwareVersion;}
 
     firmwareVersion[0] = statusCode::pn532StatusOK;
@@ -269,13 +427,12 @@ std::array<uint8_t, 5> PN532_chip::getFirmwareVersion()
 
 statusCode PN532_chip::SAMConfiguration(const uint8_t mode)
 {
-    uint8_t commands[] = {
-        pn532::command::SAMConfiguration,
-        mode};
-
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
+    auto frame = pn532::frames::SAMConfiguration;
+    frame.set(1, mode);
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = (mode == pn532::command::SAMmode::Normal_mode) 
+        ? sendCommandAndCheckAck(pn532::frames::SAMConfiguration) 
+        : sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3] != 0x15) {return statusCode::pn532statusSAMerror;}
@@ -285,15 +442,7 @@ statusCode PN532_chip::SAMConfiguration(const uint8_t mode)
 
 statusCode PN532_chip::RFField(const bool state)
 {
-    uint8_t commands[] = {
-        pn532::command::RFConfiguration,
-        pn532::command::RFItem::RFField,
-        static_cast<uint8_t>(state)
-    };
-
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(state ? pn532::frames::RFFieldOn : pn532::frames::RFFieldOff);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3]!= 0x33){return statusCode::pn532StatusWrongCommand;}
@@ -304,19 +453,13 @@ statusCode PN532_chip::RFField(const bool state)
 
 statusCode PN532_chip::setMaxRetries(const uint8_t maxRetries)
 {
-    uint8_t commands[] = {
-        pn532::command::RFConfiguration,
-        pn532::command::RFItem::MaxRetries,
-        0xFF, //MxRtyATR    default 0xff
-        0xFF, //MxRtyPSL    default 0xff
-        maxRetries
-        /// Source : https://www.nxp.com/docs/en/user-guide/141520.pdf 
-        /// P. 103   section 7.3.1
-    };
+    // MxRtyATR and MxRtyPSL keep their default 0xFF
+    /// Source : https://www.nxp.com/docs/en/user-guide/141520.pdf 
+    /// P. 103   section 7.3.1
+    auto frame = pn532::frames::setMaxRetries;
+    frame.set(4, maxRetries);
 
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3]!= 0x33){return statusCode::pn532StatusWrongCommand;}
@@ -325,26 +468,63 @@ statusCode PN532_chip::setMaxRetries(const uint8_t maxRetries)
     return statusCode::pn532StatusOK;
 }
 
-bool PN532_chip::detectCard(card& cardinfo, const uint8_t nCards, const uint8_t cardtype)
+uint8_t PN532_chip::parseTargets(const receivedCommand& response, card* const* cards, const uint8_t nCards)
 {
-    uint8_t commands[] = {
-        pn532::command::InListPassiveTarget,
-        nCards,
-        cardtype};
+    // finalBuffer: LEN, LCS, TFI, response code, NbTg, targets
+    if(response.length < 5) {return 0;}
+    const uint8_t found = response.finalBuffer[4];
+    const size_t end = response.length - 2;
+
+    uint8_t stored = 0;
+    size_t index = 5;
+    for(uint8_t i = 0; i < found && stored < nCards; i++){
+        if(index + 5 > end) {break;}
+        const uint8_t *target = &response.finalBuffer[index];
+        const uint8_t uidLength = target[4];
+        if(index + 5 + uidLength > end) {break;}
+
+        cards[stored]->setUID(&target[5], uidLength);
+        cards[stored]->setTargetData(&target[1], target[3]);
+        cards[stored]->setTargetNumber(target[0]);
+        stored++;
+
+        // ISO/IEC14443-4 cards also send their ATS, its first byte is its length
+        index += 5 + uidLength;
+        if((target[3] & 0x20) && index < end){ index += response.finalBuffer[index]; }
+    }
+    return stored;
+}
 
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
+uint8_t PN532_chip::detectCards(card* const* cards, const uint8_t nCards, const uint8_t cardtype)
+{
+    if(nCards == 0) {return 0;}
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
-    if(pass != statusCode::pn532StatusOK) {return false;}
+    auto frame = pn532::frames::InListPassiveTarget;
+    frame.set(1, nCards > 2 ? 2 : nCards);
+    frame.set(2, cardtype);
 
-    // 1 card has been found
-    if (response.finalBuffer[4] == 1)
-    {
-        hwlib::cout << "Found 1 card with UID: ";
-        cardinfo.setUID(response);
-        for (int i = 0; i < response.finalBuffer[9]; i++)
+    auto [pass, response] = (nCards == 1 && cardtype == pn532::command::TypeA_ISO_IEC14443)
+        ? sendCommandAndCheckAck(pn532::frames::InListPassiveTarget)
+        : sendCommandAndCheckAck(frame);
+    if(pass != statusCode::pn532StatusOK) {return 0;}
+
+    return parseTargets(response, cards, nCards);
+}
+
+bool PN532_chip::detectCard(card& cardinfo, const uint8_t nCards, const uint8_t cardtype)
+{
+    // only the first card is stored in cardinfo, only the UID of the second one is needed
+    card second;
+    card* cards[] = {&cardinfo, &second};
+    const uint8_t found = detectCards(cards, nCards > 2 ? 2 : nCards, cardtype);
+    if(found == 0) {return false;}
+
+    for(uint8_t i = 0; i < found; i++){
+        hwlib::cout << "Found card " << hwlib::dec << cards[i]->getTargetNumber() << " with UID: ";
+        const auto uid = cards[i]->getUID();
+        for (uint8_t j = 0; j < cards[i]->getUIDsize(); j++)
         {
-            hwlib::cout << hwlib::hex << response.finalBuffer[i + 10] << "  ";
+            hwlib::cout << hwlib::hex << uid[j] << "  ";
         }
         hwlib::cout << hwlib::endl;
     }
@@ -353,20 +533,167 @@ bool PN532_chip::detectCard(card& cardinfo, const uint8_t nCards, const uint8_t
     return true;
 }
 
+statusCode PN532_chip::targetCommand(const uint8_t command, const uint8_t cardNumber)
+{
+    auto frame = pn532::frames::InSelect;
+    frame.set(0, command);
+    frame.set(1, cardNumber);
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+
+    if(response.finalBuffer[3] != command + 1){return statusCode::pn532StatusWrongCommand;}
+    if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
+    return statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::selectCard(const uint8_t cardNumber)
+{
+    return targetCommand(pn532::command::InSelect, cardNumber);
+}
+
+statusCode PN532_chip::deselectCard(const uint8_t cardNumber)
+{
+    return targetCommand(pn532::command::InDeselect, cardNumber);
+}
+
+statusCode PN532_chip::releaseCard(const uint8_t cardNumber)
+{
+    return targetCommand(pn532::command::InRelease, cardNumber);
+}
+
+bool PN532_chip::autoPoll(card& cardinfo, const autoPollOptions& options)
+{
+    if(startAutoPoll(options) != statusCode::pn532StatusOK) {return false;}
+
+    while(inProgress(poll())){
+        waitForChip();
+    }
+    return getAutoPollTarget(cardinfo);
+}
+
+statusCode PN532_chip::startAutoPoll(const autoPollOptions& options, commandListener* listener)
+{
+    namespace cmd = pn532::command;
+
+    if(options.typeCount == 0 || options.typeCount > cmd::autoPoll::maxTypes) {return statusCode::pn532StatusInvalidParameter;}
+
+    statusCode status;
+    if(options.typeCount == 1){
+        auto frame = pn532::frames::InAutoPoll;
+        frame.set(1, options.pollCount);
+        frame.set(2, options.period);
+        frame.set(3, options.types[0]);
+        status = submit(frame, listener);
+    }else{
+        uint8_t commands[3 + cmd::autoPoll::maxTypes] = {cmd::InAutoPoll, options.pollCount, options.period};
+        for(uint8_t i = 0; i < options.typeCount; i++){ commands[3 + i] = options.types[i]; }
+        auto command = setupSendCommand(commands, 3 + options.typeCount);
+        const communication::segment segment{command.finalbuffer, command.length};
+        status = submit(&segment, 1, listener);
+    }
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    // every poll of every type takes period * 150 ms
+    responseTimeout = (options.pollCount == cmd::autoPoll::pollForever)
+        ? 0
+        : options.pollCount * options.typeCount * options.period * 150 + responseTimeout;
+    return statusCode::pn532StatusOK;
+}
+
+bool PN532_chip::getAutoPollTarget(card& cardinfo)
+{
+    namespace cmd = pn532::command;
+
+    auto [pass, response] = fetch();
+    if(pass != statusCode::pn532StatusOK) {return false;}
+
+    // finalBuffer: LEN, LCS, TFI, response code, NbTg, then per target: type, length of the target data and the target data
+    if(response.length < 7 || response.finalBuffer[3] != cmd::InAutoPoll + 1 || response.finalBuffer[4] == 0) {return false;}
+    const size_t end = response.length - 2;
+
+    // the target data of a 106 kbps type A target: Tg, SENS_RES (2), SEL_RES, NFCIDLength, NFCID
+    const uint8_t type = response.finalBuffer[5];
+    const bool typeA = (type == cmd::autoPoll::GenericPassive106kbps || type == cmd::autoPoll::Mifare || type == cmd::autoPoll::Passive106kbpsTypeA4);
+    const size_t index = 7;
+    if(!typeA || index + 5 > end) {return false;}
+
+    const uint8_t *target = &response.finalBuffer[index];
+    const uint8_t uidLength = target[4];
+    if(response.finalBuffer[6] < 5 + uidLength || index + 5 + uidLength > end) {return false;}
+
+    cardinfo.setUID(&target[5], uidLength);
+    cardinfo.setTargetData(&target[1], target[3]);
+    cardinfo.setTargetNumber(target[0]);
+    return true;
+}
+
 statusCode PN532_chip::setSerialBaudrate(const baudRate br)
 {
     hwlib::cout << "Updating Serial Baudrate" << hwlib::endl;
 
-    uint8_t commands[] = {
-        pn532::command::setSerialBaudrate,
-        br
-    };
-    auto command = setupSendCommand(commands, sizeof(commands) / sizeof(uint8_t));
+    auto frame = pn532::frames::setSerialBaudrate;
+    frame.set(1, br);
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if(response.finalBuffer[3] != 0x11){return statusCode::pn532StatusWrongCommand;}
+
+    // spi and i2c: there is no host side to switch
+    const uint32_t oldBaudrate = _protocol.getBaudrate();
+    if(oldBaudrate == 0) {return statusCode::pn532StatusOK;}
+
+    // the pn532 switches after the host has acknowledged the response
+    sendData(pn532::general::Ack_buffer_template, sizeof(pn532::general::Ack_buffer_template));
+    if(_protocol.setBaudrate(baudRateValue(br)) && verifySerialLink() == statusCode::pn532StatusOK){
+        return statusCode::pn532StatusOK;
+    }
+
+    // the pn532 did not switch, or the link does not work at the new baud rate
+    _protocol.setBaudrate(oldBaudrate);
+    const auto status = verifySerialLink();
+    return (status == statusCode::pn532StatusOK) ? statusCode::pn532StatusBaudrateFallback : status;
+}
+
+statusCode PN532_chip::verifySerialLink()
+{
+    // time in ms the communication line test gets, its frames take about 40 ms at 9600 baud
+    const uint_fast64_t verifyTimeout = 100;
+
+    const auto& frame = pn532::frames::performSelftest;
+    const auto status = submit(frame);
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    const auto deadline = hwlib::now_ticks() + verifyTimeout * 1000 * hwlib::ticks_per_us();
+    while(inProgress(poll())){
+        if(hwlib::now_ticks() >= deadline){
+            cancel();
+            return statusCode::pn532StatusTimeout;
+        }
+        waitForChip(1);
+    }
+
+    auto [pass, response] = fetch();
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+    for(uint8_t i = 0; i < 7; i++){
+        if(response.finalBuffer[i + 5] != frame.get(i + 2)) {return statusCode::pn532StatusSelftestFail;}
+    }
+    return statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::powerDown(const uint8_t wakeUpEnable)
+{
+    auto frame = pn532::frames::PowerDown;
+    frame.set(1, wakeUpEnable);
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+
+    if(response.finalBuffer[3] != 0x17){return statusCode::pn532StatusWrongCommand;}
+    if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
+
+    power = powerState::poweredDown;
     return statusCode::pn532StatusOK;
 }
 
@@ -374,20 +701,69 @@ statusCode PN532_chip::setSerialBaudrate(const baudRate br)
 // Mifare specific functions                                                       //
 // ------------------------------------------------------------------------------- //
 
-statusCode PN532_chip::mifareReadPage(card &cardinfo, const uint8_t cardNumber, const uint8_t pageNumber)
+statusCode PN532_chip::readBlock(card &cardinfo, const uint8_t cardNumber, const uint8_t pageNumber, uint8_t* block)
 {
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardNumber,
-        mifareCommands::Read16Bytes,
-        pageNumber,
-    };
+    auto frame = pn532::frames::mifareRead;
+    frame.set(1, cardNumber);
+    frame.set(3, pageNumber);
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+    if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
+
+    cardinfo.addPage(response.finalBuffer, response.length - 2, pageNumber);
+    if(block != nullptr){
+        for(uint8_t i = 0; i < pn532::general::Mifare1kPageSize; i++){ block[i] = response.finalBuffer[5 + i]; }
+    }
+    return statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::authenticateBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pageNumber, const uint8_t* key)
+{
+    const uint8_t sector = cardGeometry::sectorOf(pageNumber);
+    if(cardinfo.hasSession(sessionGeneration, cardNumber, sector, AorB, key)) {return statusCode::pn532StatusOK;}
+
+    auto frame = pn532::frames::mifareAuthenticate;
+    frame.set(1, cardNumber);
+    frame.set(2, AorB);
+    frame.set(3, pageNumber);
+    frame.set(4, key, 6);
+    frame.set(10, cardinfo.authenticationUID(), pn532::general::Mifare1kUIDsize);
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+    if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
+
+    // an authentication of another sector or card ends the old one
+    sessionGeneration++;
+    cardinfo.setSession(sessionGeneration, cardNumber, sector, AorB, key);
+    return statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::reselectCard(const card& cardinfo, uint8_t& cardNumber)
+{
+    card first, second;
+    card* cards[] = {&first, &second};
+    const uint8_t found = detectCards(cards, 2, pn532::command::TypeA_ISO_IEC14443);
+    if(found == 0){return statusCode::pn532StatusTimeout;}
+
+    // the card that has halted may not be the first target anymore, or may have been replaced by another card
+    for(uint8_t i = 0; i < found; i++){
+        if(cards[i]->getUIDsize() == cardinfo.getUIDsize() && cards[i]->getUID() == cardinfo.getUID()){
+            cardNumber = cards[i]->getTargetNumber();
+            return statusCode::pn532StatusOK;
+        }
+    }
+    return statusCode::pn532StatusOtherCard;
+}
 
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t));
+statusCode PN532_chip::mifareReadPage(card &cardinfo, const uint8_t cardNumber, const uint8_t pageNumber)
+{
+    auto frame = pn532::frames::mifareRead;
+    frame.set(1, cardNumber);
+    frame.set(3, pageNumber);
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     if (response.finalBuffer[4] != 0x00)
@@ -403,33 +779,39 @@ statusCode PN532_chip::mifareReadPage(card &cardinfo, const uint8_t cardNumber,
 
 statusCode PN532_chip::mifareAuthenticate(card&cardinfo, uint8_t cardNumber, mifareCommands AorB, uint8_t pagenr, const uint8_t* key)
 {
+    // the sector is still authenticated with this key
+    if(cardinfo.hasSession(sessionGeneration, cardNumber, cardGeometry::sectorOf(pagenr), AorB, key)) {return statusCode::pn532StatusOK;}
+
     hwlib::cout << "authenticate" << hwlib::endl;
-    const std::array<uint8_t, 4> userid = cardinfo.getUID();
-
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardNumber,
-        AorB,
-        pagenr,
-        key[0], key[1], key[2], key[3], key[4], key[5],
-        userid[0], userid[1], userid[2], userid[3]
-    };
-
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t)
-    );
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
-    if(pass != statusCode::pn532StatusOK) {return pass;}
-    if(response.isSucces){
-        pass = statusCode::pn532StatusInternalBufferOverflow;
-    }
-    if (response.finalBuffer[4]!= 0x00)
+    auto status = authenticateBlock(cardinfo, cardNumber, AorB, pagenr, key);
+    if (status != statusCode::pn532StatusOK)
     {
         hwlib::cout << "Authentication error on page: " << pagenr << hwlib::endl;
-        return statusCode::pn532StatusMifareAutError;
     }
+    return status;
+}
+
+statusCode PN532_chip::mifareReadBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key)
+{
+    auto status = authenticateBlock(cardinfo, cardNumber, AorB, pagenr, key);
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    return readBlock(cardinfo, cardNumber, pagenr);
+}
+
+statusCode PN532_chip::mifareWriteBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key, const uint8_t* data)
+{
+    auto status = authenticateBlock(cardinfo, cardNumber, AorB, pagenr, key);
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    auto frame = pn532::frames::mifareWrite;
+    frame.set(1, cardNumber);
+    frame.set(3, pagenr);
+
+    cardinfo.forgetValue(pagenr);
+    auto [pass, response] = sendCommandAndCheckAck(frame, data);
+    if(pass != statusCode::pn532StatusOK) {return pass;}
+    if(response.finalBuffer[4] != 0x00){return static_cast<statusCode>(response.finalBuffer[4] & 0x3F);}
     return statusCode::pn532StatusOK;
 }
 
@@ -437,21 +819,15 @@ statusCode PN532_chip::mifareWritePage(card& cardinfo, uint8_t cardNumber, uint8
 {
     hwlib::cout << "Writing page: " << pageNumber << hwlib::endl;
 
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardNumber,
-        mifareCommands::Write16Bytes,
-        pageNumber,
-        data[0],data[1],data[2],data[3],data[4],data[5],data[6],data[7],
-        data[8],data[9],data[10],data[11],data[12],data[13],data[14],data[15]
-    };
-
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t)
-    );
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    // the 16 data bytes are send straight from data
+    auto frame = pn532::frames::mifareWrite;
+    frame.set(1, cardNumber);
+    frame.set(3, pageNumber);
+
+    // whatever the write does, the value of the block is no longer known
+    cardinfo.forgetValue(pageNumber);
+
+    auto [pass, response] = sendCommandAndCheckAck(frame, reinterpret_cast<const uint8_t*>(data));
     if(pass != statusCode::pn532StatusOK) {return pass;}
     if (response.finalBuffer[4] != 0x00)
     {
@@ -465,39 +841,62 @@ statusCode PN532_chip::mifareWritePage(card& cardinfo, uint8_t cardNumber, uint8
 
 statusCode PN532_chip::mifareReadCard(card& cardInfo, const uint8_t cardNumber, const mifareCommands AorB, const cardKeys& authenticationKeys)
 {
-    hwlib::cout << "Reading entire mifare card" << hwlib::endl;
-    uint8_t j = 0;
-    for(int i = 0; i < 64; i++){
-        // Make sure sector is authenticated first
-        if(i%4 == 0){
-            mifareAuthenticate(cardInfo, cardNumber, AorB, i+3, authenticationKeys.aKeys[j]); \
-            j++;
+    readOptions options;
+    options.keyType = AorB;
+
+    sectorStatus status;
+    return mifareReadSectors(cardInfo, cardNumber, authenticationKeys, options, status);
+}
+
+statusCode PN532_chip::mifareReadSectors(card& cardInfo, uint8_t cardNumber, const cardKeys& authenticationKeys, const readOptions& options, sectorStatus& status)
+{
+    status.fill(statusCode::pn532StatusNotRead);
+    statusCode firstError = statusCode::pn532StatusOK;
+
+    const uint8_t sectors = cardInfo.geometry().sectors;
+    for(uint8_t sector = 0; sector < sectors && sector < status.size(); sector++){
+        if(!(options.sectorMask & (uint64_t(1) << sector))){continue;}
+        const uint16_t trailer = cardGeometry::trailerOf(sector);
+
+        // authenticate the sector once, for all of its blocks
+        mifareCommands keyType = options.keyType;
+        auto keys = (keyType == mifareCommands::authenticateKeyA) ? authenticationKeys.aKeys : authenticationKeys.bKeys;
+        auto result = authenticateBlock(cardInfo, cardNumber, keyType, trailer, keys[sector]);
+
+        if(result != statusCode::pn532StatusOK && options.onAuthFailure == authFailurePolicy::switchKey){
+            keyType = (keyType == mifareCommands::authenticateKeyA) ? mifareCommands::authenticateKeyB : mifareCommands::authenticateKeyA;
+            keys = (keyType == mifareCommands::authenticateKeyA) ? authenticationKeys.aKeys : authenticationKeys.bKeys;
+            result = reselectCard(cardInfo, cardNumber);
+            if(result == statusCode::pn532StatusOK){
+                result = authenticateBlock(cardInfo, cardNumber, keyType, trailer, keys[sector]);
+            }
         }
-        // Read sector pages
-        mifareReadPage(cardInfo, cardNumber, i);  
-    }
-    
-    for(int i = 0; i < 64; i++){
-        if(i%4 == 0){
-                hwlib::cout << hwlib::endl;
+
+        // read the data blocks and, if wanted, the sector trailer
+        const uint16_t end = options.skipTrailers ? trailer : trailer + 1;
+        for(uint16_t page = cardGeometry::firstBlock(sector); page < end && result == statusCode::pn532StatusOK; page++){
+            result = readBlock(cardInfo, cardNumber, page);
         }
-        cardInfo.readPage(i);
-    }
 
- 
-    hwlib::cout << "reading complete" << hwlib::endl;
-    hwlib::cout << hwlib::endl;hwlib::cout << hwlib::endl;hwlib::cout << hwlib::endl;
+        status[sector] = result;
+        if(result == statusCode::pn532StatusOK){continue;}
+        if(firstError == statusCode::pn532StatusOK){firstError = result;}
 
-    return statusCode::pn532StatusOK;
+        // the card has halted. When it can not be selected again, it has left the field
+        if(options.onAuthFailure == authFailurePolicy::abort){return firstError;}
+        if(reselectCard(cardInfo, cardNumber) != statusCode::pn532StatusOK){return firstError;}
+    }
+
+    return firstError;
 }
 
 statusCode PN532_chip::mifareMakeValueBlock(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key)
 {
     hwlib::cout << "Making value block on page: " << pagenr << hwlib::endl;
-    char dataBlockFormat[] = {0x64,0x00,0x00,0x00,0x9B, 0xFF, 0xFF,0xFF,0x64,0x00,0x00,000,0x01,0xFE,0x01,0xFE}; // basic value block format of a mifare classic card
+    const uint8_t dataBlockFormat[] = {0x64,0x00,0x00,0x00,0x9B, 0xFF, 0xFF,0xFF,0x64,0x00,0x00,000,0x01,0xFE,0x01,0xFE}; // basic value block format of a mifare classic card
 
     auto auth_status = mifareAuthenticate(cardinfo, cardnumber, AorB, sector, key);
-    auto status = mifareWritePage(cardinfo, cardnumber, pagenr, dataBlockFormat);
+    auto status = mifareWritePage(cardinfo, cardnumber, pagenr, reinterpret_cast<const char*>(dataBlockFormat));
 
     if(status!= statusCode::pn532StatusOK || auth_status!= statusCode::pn532StatusOK) {return statusCode::pn532StatusWrongCommand;}
 
@@ -506,26 +905,17 @@ statusCode PN532_chip::mifareMakeValueBlock(card&cardinfo, const uint8_t cardnum
 
 statusCode PN532_chip::mifareIncrement(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const uint32_t value)
 {
-  
-    mifareAuthenticate(cardinfo, cardnumber, AorB, sector, key);
-
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardnumber,
-        mifareCommands::Incrementation,
-        pagenr,
-        static_cast<uint8_t>(value & 0xff),
-        static_cast<uint8_t>((value >> 8) & 0xff),
-        static_cast<uint8_t>((value >> 16) & 0xff),
-        static_cast<uint8_t>((value >> 24) & 0xff),
-    };
-    
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t)
-    );
+    // the sector is only authenticated when it is not authenticated with this key already
+    auto auth = authenticateBlock(cardinfo, cardnumber, AorB, sector, key);
+    if(auth != statusCode::pn532StatusOK) {return auth;}
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    auto frame = pn532::frames::mifareValue;
+    frame.set(1, cardnumber);
+    frame.set(2, mifareCommands::Incrementation);
+    frame.set(3, pagenr);
+    for(uint8_t i = 0; i < 4; i++){ frame.set(4 + i, (value >> (8 * i)) & 0xff); }
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
 
     
@@ -537,21 +927,15 @@ statusCode PN532_chip::mifareIncrement(card&cardinfo, const uint8_t cardnumber,
 statusCode PN532_chip::mifareTransfer(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key)
 {
     // make sure the block we want to transfer a value to is authenticated
-    mifareAuthenticate(cardinfo, cardnumber, AorB, 0x07, key);
-
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardnumber,
-        nfc::mifareCommands::Transfare,
-        pagenr
-    };
+    auto auth = authenticateBlock(cardinfo, cardnumber, AorB, sector, key);
+    if(auth != statusCode::pn532StatusOK) {return auth;}
 
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t)
-    );
+    auto frame = pn532::frames::mifareTransfer;
+    frame.set(1, cardnumber);
+    frame.set(3, pagenr);
 
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    cardinfo.forgetValue(pagenr);
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
     
     if(response.finalBuffer[4] != 0x00){return statusCode::pn532StatusWrongCommand;}
@@ -561,30 +945,101 @@ statusCode PN532_chip::mifareTransfer(card&cardinfo, const uint8_t cardnumber, c
 
 statusCode PN532_chip::mifareDecrement(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const uint32_t value)
 {
-    // make sure the block we want to transfer a value to is authenticated
-    mifareAuthenticate(cardinfo, cardnumber, AorB, sector, key);
-
-    uint8_t commands[] = {
-        pn532::command::InDataExchange,
-        cardnumber,
-        mifareCommands::Decrementation,
-        pagenr,
-        static_cast<uint8_t>(value & 0xff),
-        static_cast<uint8_t>((value >> 8) & 0xff),
-        static_cast<uint8_t>((value >> 16) & 0xff),
-        static_cast<uint8_t>((value >> 24) & 0xff)     
-    };
-
-    auto command = setupSendCommand(
-        commands,
-        sizeof(commands) / sizeof(uint8_t)
-    );
-
-    auto [pass, response] = sendCommandAndCheckAck(command);
+    // make sure the block we want to decrement is authenticated
+    auto auth = authenticateBlock(cardinfo, cardnumber, AorB, sector, key);
+    if(auth != statusCode::pn532StatusOK) {return auth;}
+
+    auto frame = pn532::frames::mifareValue;
+    frame.set(1, cardnumber);
+    frame.set(2, mifareCommands::Decrementation);
+    frame.set(3, pagenr);
+    for(uint8_t i = 0; i < 4; i++){ frame.set(4 + i, (value >> (8 * i)) & 0xff); }
+
+    auto [pass, response] = sendCommandAndCheckAck(frame);
     if(pass != statusCode::pn532StatusOK) {return pass;}
     if(response.finalBuffer[4] != 0x00){return statusCode::pn532StatusWrongCommand;}
 
     return statusCode::pn532StatusOK;
 }
 
-} // namespace nfc
\ No newline at end of file
+statusCode PN532_chip::mifareValueTransaction(card&cardinfo, uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const mifareCommands operation, const uint32_t value, uint32_t& newValue)
+{
+    if(operation != mifareCommands::Incrementation && operation != mifareCommands::Decrementation) {return statusCode::pn532StatusInvalidParameter;}
+
+    auto auth = authenticateBlock(cardinfo, cardnumber, AorB, sector, key);
+    if(auth != statusCode::pn532StatusOK) {return auth;}
+
+    // the value before the transaction, to find out afterwards whether a failed transfer has been written
+    uint32_t oldValue = cardinfo.getIdentity().value;
+    if(cardinfo.getIdentity().valueBlock != pagenr){
+        auto status = readValueBlock(cardinfo, cardnumber, pagenr, oldValue);
+        if(status != statusCode::pn532StatusOK) {return status;}
+    }
+    const uint32_t expected = (operation == mifareCommands::Incrementation) ? oldValue + value : oldValue - value;
+
+    auto frame = pn532::frames::mifareValue;
+    frame.set(1, cardnumber);
+    frame.set(2, operation);
+    frame.set(3, pagenr);
+    for(uint8_t i = 0; i < 4; i++){ frame.set(4 + i, (value >> (8 * i)) & 0xff); }
+
+    auto status = dataExchange(frame);
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    auto transfer = pn532::frames::mifareTransfer;
+    transfer.set(1, cardnumber);
+    transfer.set(3, pagenr);
+
+    cardinfo.forgetValue(pagenr);
+    status = dataExchange(transfer);
+    if(status == statusCode::pn532StatusOK){
+        return (readValueBlock(cardinfo, cardnumber, pagenr, newValue) == statusCode::pn532StatusOK) ? statusCode::pn532StatusOK : statusCode::pn532StatusValueNotRead;
+    }
+
+    // the card has halted. Select it again and write the valueblock back with its own value
+    if(reselectCard(cardinfo, cardnumber) != statusCode::pn532StatusOK) {return statusCode::pn532StatusRestoreFailed;}
+
+    auto restore = pn532::frames::mifareValue;
+    restore.set(1, cardnumber);
+    restore.set(2, mifareCommands::Restore);
+    restore.set(3, pagenr);
+    transfer.set(1, cardnumber);
+    uint32_t restored = 0;
+    if(authenticateBlock(cardinfo, cardnumber, AorB, sector, key) != statusCode::pn532StatusOK
+       || dataExchange(restore) != statusCode::pn532StatusOK
+       || dataExchange(transfer) != statusCode::pn532StatusOK
+       || readValueBlock(cardinfo, cardnumber, pagenr, restored) != statusCode::pn532StatusOK){
+        return statusCode::pn532StatusRestoreFailed;
+    }
+
+    // only the answer of the transfer has been lost when the valueblock holds the new value
+    if(restored != oldValue && restored != expected) {return statusCode::pn532StatusRestoreFailed;}
+    newValue = restored;
+    return (restored == oldValue) ? statusCode::pn532StatusValueRestored : statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::readValueBlock(card& cardinfo, const uint8_t cardnumber, const uint8_t pagenr, uint32_t& value)
+{
+    uint8_t block[pn532::general::Mifare1kPageSize];
+    auto status = readBlock(cardinfo, cardnumber, pagenr, block);
+    if(status != statusCode::pn532StatusOK) {return status;}
+
+    // a valueblock holds the value, the inverted value and the value again, least significant byte first
+    uint32_t values[3] = {};
+    for(uint8_t i = 0; i < 12; i++){ values[i / 4] |= static_cast<uint32_t>(block[i]) << (8 * (i % 4)); }
+    if(values[0] != ~values[1] || values[0] != values[2]) {return statusCode::pn532StatusInvalidValueBlock;}
+
+    value = values[0];
+    cardinfo.setValue(pagenr, value);
+    return statusCode::pn532StatusOK;
+}
+
+statusCode PN532_chip::mifareReadValue(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, uint32_t& value)
+{
+    auto auth = authenticateBlock(cardinfo, cardnumber, AorB, sector, key);
+    if(auth != statusCode::pn532StatusOK) {return auth;}
+
+    return readValueBlock(cardinfo, cardnumber, pagenr, value);
+}
+
+} // namespace nfc
@@ -9,28 +9,45 @@
 
 #include "../headers/pn532Command.h"
 
-setupSendCommand::setupSendCommand(const uint8_t *commandsToSend, uint8_t commandSize)
+setupSendCommand::setupSendCommand(const uint8_t *commandsToSend, uint16_t commandSize)
 {
+    using nfc::pn532::general::maxFrameLength;
+
+    // a command that does not fit in a frame is not build, a part of it would be another command
+    length = 0;
+    if(commandSize > maxFrameLength - 1){ return; }
+
+    const uint16_t frameLength = commandSize + static_cast<uint16_t>(1);
     finalbuffer[0] = nfc::pn532::general::Preamble1;
     finalbuffer[1] = nfc::pn532::general::Preamble2;
-    finalbuffer[2] = commandSize + static_cast<uint8_t>(1);
-    finalbuffer[3] = calculateChecksum(finalbuffer, 2, 1);
-    finalbuffer[4] = nfc::pn532::general::HostToPn532;
-    uint8_t commandBufferIndex = 5;
+    if(frameLength < 0xFF){
+        finalbuffer[2] = frameLength;
+        finalbuffer[3] = calculateChecksum(finalbuffer, 2, 1);
+        startCommand = 4;
+    }else{
+        // extended frame. User manual p.29
+        finalbuffer[2] = 0xFF;
+        finalbuffer[3] = 0xFF;
+        finalbuffer[4] = frameLength >> 8;
+        finalbuffer[5] = frameLength & 0xFF;
+        finalbuffer[6] = calculateChecksum(finalbuffer, 4, 2);
+        startCommand = 7;
+    }
+    finalbuffer[startCommand] = nfc::pn532::general::HostToPn532;
+    uint16_t commandBufferIndex = startCommand + 1;
     for (int i = 0; i < commandSize; i++)
     {
         finalbuffer[commandBufferIndex] = commandsToSend[i];
         commandBufferIndex++;
     }
-    finalbuffer[commandBufferIndex] = calculateChecksum(finalbuffer, startCommand, commandSize + static_cast<uint8_t>(1));
-    length = commandBufferIndex + static_cast<uint8_t>(1);
-    ;
+    finalbuffer[commandBufferIndex] = calculateChecksum(finalbuffer, startCommand, frameLength);
+    length = commandBufferIndex + static_cast<uint16_t>(1);
 }
 
-uint8_t setupSendCommand::calculateChecksum(const uint8_t *buffer, int index, uint8_t n)
+uint8_t setupSendCommand::calculateChecksum(const uint8_t *buffer, int index, uint16_t n)
 {
     uint8_t som = 0x00;
-    for (uint8_t i = 0; i < n; i++)
+    for (uint16_t i = 0; i < n; i++)
     {
         som += buffer[index + i];
     }
@@ -39,24 +56,31 @@ uint8_t setupSendCommand::calculateChecksum(const uint8_t *buffer, int index, ui
 }
 
 
-// TODO ::Remove or do something with isSucces
-receivedCommand::receivedCommand(const uint8_t *receiveBufferP, uint8_t bufferSize)
+namespace {
+    // frame that is returned when nothing has been received
+    const uint8_t emptyFrame[nfc::pn532::general::frameBufferSize] = {};
+}
+
+receivedCommand::receivedCommand():
+    length(0),
+    isSucces(false),
+    finalBuffer(emptyFrame)
+{}
+
+receivedCommand::receivedCommand(const uint8_t *frame, size_t length):
+    length(length),
+    isSucces(false),
+    finalBuffer(frame)
 {
-    isSucces = true;
-    if (receiveBufferP[0] == 0x00 && receiveBufferP[1]==0xff)
-    {   
-        length = receiveBufferP[2] + static_cast<uint8_t>(4);
-        for (uint8_t i = 0; i < length; i++)
-        {
-            finalBuffer[i] = receiveBufferP[i + 2];
-        }
-    }
-    else if(receiveBufferP[0]==1 && receiveBufferP[1]==0){
-        isSucces = true;
-        length = receiveBufferP[4] + static_cast<uint8_t>(4);
-        for (uint8_t i = 0; i < length; i++)
-        {
-            finalBuffer[i] = receiveBufferP[i + 4];
-        }
-    }
-}
\ No newline at end of file
+    // LEN, LCS, TFI, data, DCS and the postamble
+    if(length < 5){ return; }
+
+    // the LCS of an extended frame covers LENM and LENL, it has already been checked when the frame was read
+    const size_t len = length - 4;
+    if(len < 0xFF && static_cast<uint8_t>(frame[0] + frame[1]) != 0x00){ return; }
+
+    // TFI + data + DCS adds up to 0
+    uint8_t sum = 0;
+    for(size_t i = 2; i < length - 1; i++){ sum += frame[i]; }
+    isSucces = (sum == 0x00);
+}
@@ -0,0 +1,510 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in pn532Emulator.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/pn532Emulator.h"
+
+namespace communication{
+
+namespace {
+    const uint8_t ackFrame[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    const uint8_t errorFrame[] = {0x00, 0x00, 0xFF, 0x01, 0xFF, 0x7F, 0x81, 0x00};  // syntax error frame. User manual p.30
+
+    uint8_t checksum(const uint8_t *buffer, uint16_t n)
+    {
+        uint8_t sum = 0;
+        for(uint16_t i = 0; i < n; i++){ sum += buffer[i]; }
+        return ~sum + 1;
+    }
+}
+
+void pn532Emulator::emulatedCard::format(const uint8_t *newUid, uint8_t length, const cardGeometry& geometry)
+{
+    using nfc::pn532::general::Mifare1kPageSize;
+
+    for(auto &byte : memory){ byte = 0x00; }
+    uidLength = (length > sizeof(uid)) ? sizeof(uid) : length;
+    for(uint8_t i = 0; i < uidLength; i++){ uid[i] = newUid[i]; }
+    sectors = geometry.sectors;
+
+    // SAK and ATQA tell the size of the card and of its UID
+    sak = (sectors > 16) ? 0x18 : (sectors < 16) ? 0x09 : 0x08;
+    atqa = ((sectors > 16) ? 0x02 : 0x04) | ((uidLength == 7) ? 0x40 : (uidLength == 10) ? 0x80 : 0x00);
+
+    // manufacturer block: UID, BCC (only for 4 byte UIDs), SAK and ATQA
+    uint8_t n = 0;
+    for(; n < uidLength && n < Mifare1kPageSize - 3; n++){ memory[n] = uid[n]; }
+    if(uidLength == 4){ memory[n++] = uid[0] ^ uid[1] ^ uid[2] ^ uid[3]; }
+    memory[n++] = sak;
+    memory[n++] = atqa;
+    memory[n++] = 0x00;
+
+    // sector trailers: key A, access bits, key B
+    const uint8_t trailer[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    for(uint8_t sector = 0; sector < sectors; sector++){
+        const uint16_t block = cardGeometry::trailerOf(sector);
+        for(uint8_t i = 0; i < Mifare1kPageSize; i++){
+            memory[block * Mifare1kPageSize + i] = trailer[i];
+        }
+    }
+}
+
+pn532Emulator::pn532Emulator(): irq(*this)
+{
+    const uint8_t firstUid[]    = {0xDE, 0xAD, 0xBE, 0xEF};
+    const uint8_t secondUid[]   = {0x12, 0x34, 0x56, 0x78};
+    cards[0].format(firstUid);
+    cards[1].format(secondUid);
+    cards[0].present = true;
+}
+
+void pn532Emulator::wakeUp()
+{
+    stats.wakeUps++;
+    hwlib::wait_us(wakeUpDelay);
+    poweredDown = false;
+}
+
+void pn532Emulator::presentCardAfter(uint_fast32_t us)
+{
+    cards[0].present = false;
+    cardArrivesAt = hwlib::now_us() + us;
+}
+
+bool pn532Emulator::cardInField()
+{
+    if(!cards[0].present && cardArrivesAt != 0 && hwlib::now_us() >= cardArrivesAt){
+        cards[0].present = true;
+        cardArrivesAt = 0;
+    }
+    return cards[0].present;
+}
+
+pn532Emulator::emulatedCard* pn532Emulator::target(uint8_t tg)
+{
+    if(tg == 0 || tg > targetCount || targets[tg - 1] == 0xFF){ return nullptr; }
+
+    auto &card = cards[targets[tg - 1]];
+    if(tg != selectedTarget){
+        if(selectedTarget != 0 && targets[selectedTarget - 1] != 0xFF){
+            cards[targets[selectedTarget - 1]].authenticatedSector = 0xFF;
+        }
+        card.authenticatedSector = 0xFF;
+        card.halted = false;
+        selectedTarget = tg;
+    }
+    return &card;
+}
+
+uint16_t pn532Emulator::listTargets(uint8_t maxTargets, uint8_t *out)
+{
+    targetCount = 0;
+    selectedTarget = 0;
+    uint16_t length = 1;
+    for(uint8_t i = 0; i < maxCards && targetCount < maxTargets; i++){
+        if(!cards[i].present){ continue; }
+        cards[i].authenticatedSector = 0xFF;
+        cards[i].halted = false;
+        targets[targetCount++] = i;
+        length += targetData(targetCount, cards[i], &out[length]);
+    }
+
+    // the last card that has been activated is the selected one
+    selectedTarget = targetCount;
+    out[0] = targetCount;
+    return length;
+}
+
+bool pn532Emulator::frameReady() const
+{
+    const auto now = hwlib::now_us();
+    if(ackPending){ return now >= ackReadyAt; }
+    return responsePending && now >= responseReadyAt;
+}
+
+uint_fast64_t pn532Emulator::nextFrameAt() const
+{
+    if(ackPending){ return ackReadyAt; }
+    return responsePending ? responseReadyAt : 0;
+}
+
+bool pn532Emulator::isReady()
+{
+    stats.statusReads++;
+    return frameReady();
+}
+
+void pn532Emulator::sendData(const uint8_t *commandBuffer, size_t nBytes)
+{
+    stats.bytesSent += nBytes;
+    if(poweredDown){ return; }
+
+    // find the start of the frame
+    size_t start = 0;
+    while(start + 1 < nBytes && !(commandBuffer[start] == 0x00 && commandBuffer[start + 1] == 0xFF)){ start++; }
+    if(start + 3 >= nBytes){ return; }
+
+    uint16_t len = commandBuffer[start + 2];
+
+    // an ACK frame from the host aborts the running command, or acknowledges the response of SetSerialBaudrate
+    if(len == 0x00 && commandBuffer[start + 3] == 0xFF){
+        ackPending = false;
+        responsePending = false;
+        if(pendingBaudrate != 0 && !failBaudrateSwitch){ serialBaudrate = pendingBaudrate; }
+        failBaudrateSwitch = failBaudrateSwitch && pendingBaudrate == 0;
+        pendingBaudrate = 0;
+        return;
+    }
+
+    // a NACK frame from the host asks for the last response again
+    if(len == 0xFF && commandBuffer[start + 3] == 0x00){
+        stats.nacks++;
+        if(responseLength == 0 || responsePending){ return; }
+        if(damagedByte != 0){
+            response[damagedByte] ^= 0x01;
+            damagedByte = 0;
+        }
+        responsePending = true;
+        responseReadyAt = hwlib::now_us() + ackDelay;
+        return;
+    }
+
+    // extended frame: the length follows in LENM and LENL
+    size_t body = start + 4;
+    if(len == 0xFF && commandBuffer[start + 3] == 0xFF){
+        if(start + 8 >= nBytes){ return; }
+        len = (commandBuffer[start + 4] << 8) | commandBuffer[start + 5];
+        body = start + 7;
+    }
+
+    stats.commands++;
+    const auto now = hwlib::now_us();
+    ackPending = true;
+    ackReadyAt = now + ackDelay;
+    responsePending = true;
+    responseReadyAt = ackReadyAt + responseDelay;
+
+    const uint8_t *command = &commandBuffer[body + 1];
+    if(commandBuffer[body] != nfc::pn532::general::HostToPn532 || len < 2 || body + len >= nBytes){
+        for(uint8_t i = 0; i < sizeof(errorFrame); i++){ response[i] = errorFrame[i]; }
+        responseLength = sizeof(errorFrame);
+        return;
+    }
+
+    if(command[0] == nfc::pn532::command::InListPassiveTarget || command[0] == nfc::pn532::command::InDataExchange
+       || command[0] == nfc::pn532::command::InAutoPoll){
+        responseReadyAt += rfDelay;
+    }
+
+    uint8_t data[nfc::pn532::general::maxFrameLength] = {};
+    const uint16_t n = execute(command, len - 1, data);
+    buildResponse(command[0] + 1, data, n);
+}
+
+void pn532Emulator::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    readFrame = nullptr;
+    readLength = 0;
+    readOffset = 0;
+
+    if(nBytes > 0 && frameReady()){
+        if(ackPending){
+            readFrame = ackFrame;
+            readLength = sizeof(ackFrame);
+            ackPending = false;
+        }else{
+            // flip a bit of the last data byte, so the DCS of the response no longer matches
+            if(damageResponses > 0 && responseLength > 8){
+                damageResponses--;
+                damagedByte = responseLength - 3;
+                response[damagedByte] ^= 0x01;
+            }
+            readFrame = response;
+            readLength = responseLength;
+            responsePending = false;
+            poweredDown = powerDownPending;
+            powerDownPending = false;
+        }
+    }
+    receiveMore(receiveBuffer, nBytes);
+}
+
+void pn532Emulator::receiveMore(uint8_t *receiveBuffer, size_t nBytes)
+{
+    stats.bytesReceived += nBytes;
+    for(size_t i = 0; i < nBytes; i++){
+        receiveBuffer[i] = (readOffset < readLength) ? readFrame[readOffset] : 0x00;
+        readOffset++;
+    }
+}
+
+void pn532Emulator::buildResponse(const uint8_t responseCode, const uint8_t *data, uint16_t n)
+{
+    damagedByte = 0;
+    const uint16_t len = n + 2;
+    response[0] = nfc::pn532::general::Preamble1;
+    response[1] = nfc::pn532::general::Preamble1;
+    response[2] = nfc::pn532::general::Preamble2;
+    uint16_t body = 5;
+    if(len < 0xFF){
+        response[3] = len;
+        response[4] = checksum(&response[3], 1);
+    }else{
+        response[3] = 0xFF;
+        response[4] = 0xFF;
+        response[5] = len >> 8;
+        response[6] = len & 0xFF;
+        response[7] = checksum(&response[5], 2);
+        body = 8;
+    }
+    response[body] = nfc::pn532::general::Pn542ToHost;
+    response[body + 1] = responseCode;
+    for(uint16_t i = 0; i < n; i++){ response[body + 2 + i] = data[i]; }
+    response[body + len] = checksum(&response[body], len);
+    response[body + len + 1] = 0x00;
+    responseLength = body + len + 2;
+}
+
+uint16_t pn532Emulator::execute(const uint8_t *command, uint16_t n, uint8_t *out)
+{
+    namespace cmd = nfc::pn532::command;
+
+    switch(command[0]){
+    case cmd::PerformSelftest:
+        // echo the test number and its parameters
+        for(uint16_t i = 1; i < n; i++){ out[i - 1] = command[i]; }
+        return n - 1;
+
+    case cmd::GetFirmwareVersion:
+        out[0] = 0x32; out[1] = 0x01; out[2] = 0x06; out[3] = 0x07;
+        return 4;
+
+    case cmd::getGeneralStatus: {
+        uint8_t listed = 0;
+        for(uint8_t i = 0; i < targetCount; i++){ if(targets[i] != 0xFF){ listed++; } }
+        out[0] = 0x00;                                  // last error
+        out[1] = 0x00;                                  // external field
+        out[2] = listed;                                // targets
+        out[3] = 0x00;                                  // SAM status
+        return 4;
+    }
+
+    case cmd::readRegister:
+        for(uint16_t i = 1; i + 1 < n; i += 2){ out[i / 2] = 0x00; }
+        return (n - 1) / 2;
+
+    case cmd::readGPIO:
+        out[0] = 0x3F; out[1] = 0x03; out[2] = 0x00;
+        return 3;
+
+    case cmd::InListPassiveTarget: {
+        if(!cardInField() && cardArrivesAt != 0){
+            // the pn532 keeps on trying until the card enters the field
+            if(cardArrivesAt + rfDelay > responseReadyAt){ responseReadyAt = cardArrivesAt + rfDelay; }
+            cards[0].present = true;
+            cardArrivesAt = 0;
+        }
+        const uint8_t maxTargets = (n > 1 && command[1] > 1) ? maxCards : 1;
+        return listTargets(maxTargets, out);
+    }
+
+    case cmd::InAutoPoll:
+        return autoPoll(command, n, out);
+
+    case cmd::InDataExchange: {
+        cardInField();
+        auto card = (n > 1) ? target(command[1] & 0x0F) : nullptr;
+        if(card == nullptr){ out[0] = nfc::statusCode::pn532StatusWrongCommand; return 1; }
+
+        // a Mifare card halts after an error and only answers again after it has been selected
+        if(card->halted){ out[0] = nfc::statusCode::pn532StatusTimeout; return 1; }
+        const uint16_t length = mifareExchange(*card, command, n, out);
+        if(out[0] != 0x00){ card->halted = true; card->authenticatedSector = 0xFF; }
+        return length;
+    }
+
+    case cmd::InSelect:
+        out[0] = (n > 1 && target(command[1]) != nullptr) ? 0x00 : nfc::statusCode::pn532StatusWrongCommand;
+        return 1;
+
+    case cmd::InDeselect:
+    case cmd::InRelease: {
+        // target 0 means all targets
+        out[0] = 0x00;
+        const uint8_t tg = (n > 1) ? command[1] : 0;
+        for(uint8_t i = 1; i <= targetCount; i++){
+            if(targets[i - 1] == 0xFF || (tg != 0 && tg != i)){ continue; }
+            cards[targets[i - 1]].authenticatedSector = 0xFF;
+            if(command[0] == cmd::InRelease){ targets[i - 1] = 0xFF; }
+            if(selectedTarget == i){ selectedTarget = 0; }
+        }
+        if(tg > targetCount){ out[0] = nfc::statusCode::pn532StatusWrongCommand; }
+        return 1;
+    }
+
+    case cmd::PowerDown:
+        // the chip goes to power down after the response has been send, and forgets its targets
+        powerDownPending = true;
+        for(auto &card : cards){ card.authenticatedSector = 0xFF; }
+        targetCount = 0;
+        selectedTarget = 0;
+        out[0] = 0x00;
+        return 1;
+
+    case cmd::setSerialBaudrate:
+        // the new baudrate is used after the host has acknowledged the response
+        pendingBaudrate = (n > 1) ? nfc::baudRateValue(static_cast<nfc::baudRate>(command[1])) : 0;
+        return 0;
+
+    case cmd::writeRegister:
+    case cmd::writeGPIO:
+    case cmd::SAMConfiguration:
+    case cmd::RFConfiguration:
+    default:
+        return 0;
+    }
+}
+
+uint16_t pn532Emulator::targetData(uint8_t tg, const emulatedCard& card, uint8_t *out) const
+{
+    out[0] = tg;                // target number
+    out[1] = 0x00;              // SENS_RES
+    out[2] = card.atqa;
+    out[3] = card.sak;          // SEL_RES
+    out[4] = card.uidLength;
+    for(uint8_t i = 0; i < card.uidLength; i++){ out[5 + i] = card.uid[i]; }
+    return 5 + card.uidLength;
+}
+
+uint16_t pn532Emulator::autoPoll(const uint8_t *command, uint16_t n, uint8_t *out)
+{
+    namespace cmd = nfc::pn532::command;
+
+    if(n < 4){ out[0] = 0x00; return 1; }
+    const uint8_t pollCount = command[1];
+    const uint8_t types = n - 3;
+
+    // the emulated card answers to the polls for a Mifare card
+    uint8_t type = 0xFF;
+    for(uint8_t i = 0; i < types; i++){
+        const uint8_t t = command[3 + i];
+        if(t == cmd::autoPoll::GenericPassive106kbps || t == cmd::autoPoll::Mifare || t == cmd::autoPoll::Passive106kbpsTypeA4){ type = t; break; }
+    }
+
+    // one round of polls over all types takes period * 150 ms per type
+    const uint_fast64_t round = static_cast<uint_fast64_t>(command[2]) * 150'000 * types;
+    const uint_fast64_t start = responseReadyAt - rfDelay;
+    const uint_fast64_t end = start + pollCount * round;
+
+    bool found = cardInField() || cards[1].present;
+    if(!found && cardArrivesAt != 0 && (pollCount == cmd::autoPoll::pollForever || cardArrivesAt < end)){
+        // answer at the first round after the card has entered the field
+        const uint_fast64_t rounds = round == 0 ? 0 : (cardArrivesAt - start + round - 1) / round;
+        responseReadyAt = start + rounds * round + rfDelay;
+        cards[0].present = true;
+        cardArrivesAt = 0;
+        found = true;
+    }
+
+    if(!found || type == 0xFF){
+        // no target: never answer when polling forever, otherwise answer after the last poll
+        responseReadyAt = (pollCount == cmd::autoPoll::pollForever) ? ~static_cast<uint_fast64_t>(0) : end;
+        out[0] = 0x00;
+        return 1;
+    }
+
+    // only the first card is reported, as one target
+    uint8_t list[1 + 5 + card::maxUIDsize];
+    const uint8_t length = listTargets(1, list) - 1;
+    out[0] = 0x01;              // amount of targets
+    out[1] = type;
+    out[2] = length;
+    for(uint8_t i = 0; i < length; i++){ out[3 + i] = list[1 + i]; }
+    return 3 + out[2];
+}
+
+uint16_t pn532Emulator::mifareExchange(emulatedCard& card, const uint8_t *command, uint16_t n, uint8_t *out)
+{
+    using nfc::pn532::general::Mifare1kPageSize;
+
+    const uint8_t timeoutError  = nfc::statusCode::pn532StatusTimeout;
+    const uint8_t authError     = nfc::statusCode::pn532StatusMifareAutError;
+    const uint8_t rfError       = nfc::statusCode::pn532StatusRFProtocolError;
+
+    if(!card.present || n < 4){ out[0] = timeoutError; return 1; }
+
+    const uint8_t block = command[3];
+    const uint8_t sector = cardGeometry::sectorOf(block);
+    if(sector >= card.sectors){ out[0] = rfError; return 1; }
+    uint8_t *blockData = &card.memory[block * Mifare1kPageSize];
+    const uint8_t *trailer = &card.memory[cardGeometry::trailerOf(sector) * Mifare1kPageSize];
+    out[0] = 0x00;
+
+    switch(command[2]){
+    case nfc::mifareCommands::authenticateKeyA:
+    case nfc::mifareCommands::authenticateKeyB: {
+        stats.authentications++;
+        if(n < 14){ out[0] = rfError; return 1; }
+        const uint8_t *key = (command[2] == nfc::mifareCommands::authenticateKeyA) ? &trailer[0] : &trailer[10];
+        for(uint8_t i = 0; i < 6; i++){
+            if(command[4 + i] != key[i]){ card.authenticatedSector = 0xFF; out[0] = authError; return 1; }
+        }
+        card.authenticatedSector = sector;
+        return 1;
+    }
+
+    case nfc::mifareCommands::Read16Bytes:
+        if(card.authenticatedSector != sector){ out[0] = authError; return 1; }
+        for(uint8_t i = 0; i < Mifare1kPageSize; i++){ out[1 + i] = blockData[i]; }
+        return 1 + Mifare1kPageSize;
+
+    case nfc::mifareCommands::Write16Bytes:
+        if(card.authenticatedSector != sector || n < 4 + Mifare1kPageSize){ out[0] = authError; return 1; }
+        for(uint8_t i = 0; i < Mifare1kPageSize; i++){ blockData[i] = command[4 + i]; }
+        return 1;
+
+    case nfc::mifareCommands::Incrementation:
+    case nfc::mifareCommands::Decrementation:
+    case nfc::mifareCommands::Restore: {
+        if(card.authenticatedSector != sector){ out[0] = authError; return 1; }
+
+        // a value block stores the value, its inverse and the value again
+        uint32_t value = 0, inverse = 0, copy = 0;
+        for(uint8_t i = 0; i < 4; i++){
+            value   |= static_cast<uint32_t>(blockData[i])      << (8 * i);
+            inverse |= static_cast<uint32_t>(blockData[4 + i])  << (8 * i);
+            copy    |= static_cast<uint32_t>(blockData[8 + i])  << (8 * i);
+        }
+        if(value != ~inverse || value != copy){ out[0] = rfError; return 1; }
+
+        uint32_t operand = 0;
+        for(uint8_t i = 0; i < 4 && 4 + i < n; i++){ operand |= static_cast<uint32_t>(command[4 + i]) << (8 * i); }
+
+        if(command[2] == nfc::mifareCommands::Incrementation){ card.valueRegister = value + operand; }
+        else if(command[2] == nfc::mifareCommands::Decrementation){ card.valueRegister = value - operand; }
+        else{ card.valueRegister = value; }
+        return 1;
+    }
+
+    case nfc::mifareCommands::Transfare:
+        if(card.authenticatedSector != sector){ out[0] = authError; return 1; }
+        if(failTransfer){ failTransfer = false; out[0] = timeoutError; return 1; }
+        for(uint8_t i = 0; i < 4; i++){
+            blockData[i]     = static_cast<uint8_t>(card.valueRegister >> (8 * i));
+            blockData[4 + i] = static_cast<uint8_t>(~card.valueRegister >> (8 * i));
+            blockData[8 + i] = static_cast<uint8_t>(card.valueRegister >> (8 * i));
+        }
+        if(loseTransferAnswer){ loseTransferAnswer = false; out[0] = timeoutError; }
+        return 1;
+
+    default:
+        out[0] = rfError;
+        return 1;
+    }
+}
+
+} // namespace communication
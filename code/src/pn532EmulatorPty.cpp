@@ -0,0 +1,169 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in pn532EmulatorPty.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/pn532EmulatorPty.h"
+
+// termios2 (asm/termbits.h) instead of termios.h, so the baudrate of the host can be read as a number
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace communication{
+
+namespace {
+    const uint8_t hsuWakeUp = 0x55;
+
+    // longest time the thread sleeps, so stop() is noticed
+    const uint_fast64_t maxSleep = 10'000;
+
+    void writeAll(int fd, const uint8_t *data, size_t nBytes)
+    {
+        while(nBytes > 0){
+            const auto n = write(fd, data, nBytes);
+            if(n > 0){
+                data += n;
+                nBytes -= n;
+            }else if(n < 0 && errno != EAGAIN && errno != EINTR){
+                return;
+            }
+        }
+    }
+}
+
+pn532EmulatorPty::pn532EmulatorPty(pn532Emulator &emulator):
+    emulator(emulator)
+{
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+        hwlib::cout << "cannot open a pseudo-terminal" << hwlib::endl;
+    }
+}
+
+pn532EmulatorPty::~pn532EmulatorPty()
+{
+    stop();
+    if(master >= 0){ close(master); }
+}
+
+const char* pn532EmulatorPty::slaveName() const
+{
+    return ptsname(master);
+}
+
+void pn532EmulatorPty::start()
+{
+    if(running){ return; }
+    running = true;
+    worker = std::thread([this]{ run(); });
+}
+
+void pn532EmulatorPty::stop()
+{
+    running = false;
+    if(worker.joinable()){ worker.join(); }
+}
+
+void pn532EmulatorPty::run()
+{
+    while(running){
+        // sleep until the host sends a byte or until the emulator has its next frame ready
+        uint_fast64_t sleep = maxSleep;
+        const auto next = emulator.nextFrameAt();
+        if(next != 0){
+            const auto now = hwlib::now_us();
+            sleep = (next > now) ? ((next - now < maxSleep) ? next - now : maxSleep) : 0;
+        }
+
+        pollfd request = {master, POLLIN, 0};
+        const timespec time = {0, static_cast<long>(sleep * 1'000)};
+        if(ppoll(&request, 1, &time, nullptr) > 0 && (request.revents & POLLIN)){
+            const auto free = input.writable();
+            const auto n = read(master, free.data, free.length);
+            if(n > 0){ input.commit(n); }
+            receive();
+        }
+
+        while(emulator.frameReady()){ transmit(); }
+    }
+}
+
+void pn532EmulatorPty::receive()
+{
+    using nfc::pn532::general::Preamble1;
+
+    uint8_t command[nfc::pn532::general::commandBufferSize + 2] = {Preamble1};
+    while(true){
+        // with another baudrate the chip only receives garbage
+        if(hostBaudrate() != emulator.serialBaudrate && !emulator.baudrateSwitchPending()){
+            input.clear();
+            return;
+        }
+
+        // 0x55 outside a frame is the HSU wake up
+        while(input.returnSize() > 0 && input.peek(0) == hsuWakeUp){
+            input.consume(1);
+            emulator.wakeUp();
+        }
+
+        // the emulator expects a complete frame, with preamble and postamble
+        const auto length = input.popFrame(&command[1], sizeof(command) - 2);
+        if(length == 0){ return; }
+        command[length + 1] = Preamble1;
+        waitWireTime(length + 2);
+        emulator.sendData(command, length + 2);
+    }
+}
+
+void pn532EmulatorPty::transmit()
+{
+    uint8_t response[nfc::pn532::general::frameBufferSize + 6] = {};
+
+    // preamble, start code, LEN and LCS
+    emulator.receiveData(response, 5);
+    const uint8_t len = response[3];
+    const uint8_t lcs = response[4];
+    size_t total = 5;
+
+    if((len == 0x00 && lcs == 0xFF) || (len == 0xFF && lcs == 0x00)){
+        emulator.receiveMore(&response[total], 1);
+        total += 1;
+    }else if(len == 0xFF && lcs == 0xFF){
+        emulator.receiveMore(&response[total], 3);
+        uint16_t length = (response[5] << 8) | response[6];
+        if(length > nfc::pn532::general::maxFrameLength){ length = nfc::pn532::general::maxFrameLength; }
+        emulator.receiveMore(&response[total + 3], length + 2);
+        total += 3 + length + 2;
+    }else{
+        emulator.receiveMore(&response[total], len + 2);
+        total += len + 2;
+    }
+    emulator.endTransaction();
+
+    waitWireTime(total);
+    writeAll(master, response, total);
+}
+
+uint32_t pn532EmulatorPty::hostBaudrate() const
+{
+    // the termios of the master side are the ones of the slave side
+    termios2 settings;
+    if(ioctl(master, TCGETS2, &settings) != 0){ return 0; }
+    return settings.c_ospeed;
+}
+
+void pn532EmulatorPty::waitWireTime(size_t nBytes) const
+{
+    if(emulator.serialBaudrate == 0){ return; }
+    hwlib::wait_us(static_cast<int_fast32_t>(nBytes * 10 * 1'000'000ULL / emulator.serialBaudrate));
+}
+
+} // namespace communication
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in pn532EmulatorSpi.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/pn532EmulatorSpi.h"
+
+namespace communication{
+
+namespace {
+    const uint8_t dataWrite     = 0x01;
+    const uint8_t statusRead    = 0x02;
+    const uint8_t dataRead      = 0x03;
+}
+
+void pn532EmulatorSpi::selPin::write(bool x)
+{
+    if(bus == nullptr){ return; }
+    bus->stats.selWrites++;
+    if(x == level){ return; }
+    level = x;
+    bus->select(slave, !x);
+}
+
+pn532EmulatorSpi::selPin& pn532EmulatorSpi::attach(pn532Emulator &emulator)
+{
+    if(slaveCount == maxSlaves){ return pins[maxSlaves - 1]; }
+
+    slaves[slaveCount].emulator = &emulator;
+    auto &pin = pins[slaveCount];
+    pin.bus = this;
+    pin.slave = slaveCount;
+    slaveCount++;
+    return pin;
+}
+
+void pn532EmulatorSpi::select(uint8_t slave, bool active)
+{
+    auto &state = slaves[slave];
+    if(active){
+        stats.transactions++;
+        selected = slave;
+        state.operation = 0;
+        state.commandLength = 0;
+        state.reading = false;
+        return;
+    }
+
+    if(state.operation == dataWrite && state.commandLength > 0){
+        state.emulator->sendData(state.command, state.commandLength);
+    }
+    if(state.operation == dataRead && state.reading){
+        state.emulator->endTransaction();
+    }
+    state.operation = 0;
+    if(selected == slave){ selected = maxSlaves; }
+}
+
+void pn532EmulatorSpi::write_and_read(const size_t n, const uint8_t data_out[], uint8_t data_in[])
+{
+    stats.calls++;
+    stats.bytes += n;
+    if(byteTime > 0){ hwlib::wait_ns(static_cast<int_fast32_t>(n * byteTime)); }
+
+    if(selected == maxSlaves){
+        // nobody listens, miso stays low
+        for(size_t i = 0; data_in != nullptr && i < n; i++){ data_in[i] = 0x00; }
+        return;
+    }
+
+    auto &state = slaves[selected];
+    size_t i = 0;
+    if(state.operation == 0 && n > 0){
+        state.operation = (data_out != nullptr) ? data_out[0] : 0x00;
+        if(data_in != nullptr){ data_in[0] = 0x00; }
+        i = 1;
+    }
+
+    switch(state.operation){
+    case dataWrite:
+        for(; i < n && data_out != nullptr && state.commandLength < sizeof(state.command); i++){
+            state.command[state.commandLength++] = data_out[i];
+        }
+        break;
+    case statusRead:
+        for(; i < n && data_in != nullptr; i++){ data_in[i] = state.emulator->isReady() ? 0x01 : 0x00; }
+        break;
+    case dataRead:
+        if(i < n && data_in != nullptr){
+            if(state.reading){ state.emulator->receiveMore(&data_in[i], n - i); }
+            else{ state.emulator->receiveData(&data_in[i], n - i); }
+            state.reading = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace communication
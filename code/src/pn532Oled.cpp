@@ -38,12 +38,12 @@ void NfcOled::init()
         hwlib::wait_ms(500);
 }
 
-void NfcOled::sendData(uint8_t *commandBuffer, const uint8_t nBytes)
+void NfcOled::sendData(const uint8_t *commandBuffer, const size_t nBytes)
 {
     slave.sendData(commandBuffer, nBytes);
 }   
 
-void NfcOled::getData(uint8_t *buffer, const uint8_t nBytes) 
+void NfcOled::getData(uint8_t *buffer, const size_t nBytes) 
 {
     slave.getData(buffer, nBytes);
 } 
@@ -88,6 +88,42 @@ Result NfcOled::sendCommandAndCheckAck(setupSendCommand &command)
     return slave.sendCommandAndCheckAck(command);
 }
 
+Result NfcOled::sendCommandAndCheckAck(const communication::segment* segments, const size_t count)
+{
+    return slave.sendCommandAndCheckAck(segments, count);
+}
+
+
+// ------------------------------------------------------------------------------- //
+// Asynchronous command functions                                                  //
+// ------------------------------------------------------------------------------- //
+
+statusCode NfcOled::submit(const communication::segment* segments, const size_t count, commandListener* listener)
+{
+    return slave.submit(segments, count, listener);
+}
+
+commandState NfcOled::poll()
+{
+    const auto state = slave.poll();
+    if(state == commandState::failed && lastState != commandState::failed){
+        // no wait here, poll() may not block
+        display << "\v\n\n\n\n\n\n" << "NFC error..." << hwlib::flush;
+    }
+    lastState = state;
+    return state;
+}
+
+Result NfcOled::fetch()
+{
+    return slave.fetch();
+}
+
+void NfcOled::cancel()
+{
+    slave.cancel();
+}
+
 
 // ------------------------------------------------------------------------------- //   
 // More advanced functions                                                         //
@@ -175,9 +211,42 @@ bool NfcOled::detectCard(card& cardinfo, const uint8_t nCards, const uint8_t car
     return slave.detectCard(cardinfo, nCards, cardtype);
 }
 
-statusCode NfcOled::selectCard()
+bool NfcOled::autoPoll(card& cardinfo, const autoPollOptions& options)
+{
+    display << "\v\n\n" << " "<<"\n" << "Present card" << hwlib::flush;
+    return slave.autoPoll(cardinfo, options);
+}
+
+statusCode NfcOled::startAutoPoll(const autoPollOptions& options, commandListener* listener)
+{
+    display << "\v\n\n" << " "<<"\n" << "Present card" << hwlib::flush;
+    return slave.startAutoPoll(options, listener);
+}
+
+bool NfcOled::getAutoPollTarget(card& cardinfo)
+{
+    return slave.getAutoPollTarget(cardinfo);
+}
+
+uint8_t NfcOled::detectCards(card* const* cards, const uint8_t nCards, const uint8_t cardtype)
 {
-    return statusCode::pn532StatusOK;
+    display << "\v\n\n" << " "<<"\n" << "Present card" << hwlib::flush;
+    return slave.detectCards(cards, nCards, cardtype);
+}
+
+statusCode NfcOled::selectCard(const uint8_t cardNumber)
+{
+    return slave.selectCard(cardNumber);
+}
+
+statusCode NfcOled::deselectCard(const uint8_t cardNumber)
+{
+    return slave.deselectCard(cardNumber);
+}
+
+statusCode NfcOled::releaseCard(const uint8_t cardNumber)
+{
+    return slave.releaseCard(cardNumber);
 }
 
 statusCode NfcOled::setSerialBaudrate(const baudRate br)
@@ -185,6 +254,11 @@ statusCode NfcOled::setSerialBaudrate(const baudRate br)
     return slave.setSerialBaudrate(br);
 }
 
+statusCode NfcOled::powerDown(const uint8_t wakeUpEnable)
+{
+    return slave.powerDown(wakeUpEnable);
+}
+
 
 // ------------------------------------------------------------------------------- //
 // Mifare specific functions                                                       //
@@ -204,6 +278,16 @@ statusCode NfcOled::mifareAuthenticate(card&cardinfo, uint8_t cardNumber, mifare
     return status;
 }
 
+statusCode NfcOled::mifareReadBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key)
+{
+    return slave.mifareReadBlock(cardinfo, cardNumber, AorB, pagenr, key);
+}
+
+statusCode NfcOled::mifareWriteBlock(card& cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t* key, const uint8_t* data)
+{
+    return slave.mifareWriteBlock(cardinfo, cardNumber, AorB, pagenr, key, data);
+}
+
 statusCode NfcOled::mifareWritePage(card& cardinfo, uint8_t cardNumber, uint8_t pageNumber,const  char* data)
 {
     return slave.mifareWritePage(cardinfo, cardNumber, pageNumber, data);
@@ -218,6 +302,19 @@ statusCode NfcOled::mifareReadCard(card& cardInfo, const uint8_t cardNumber, con
     return status;
 }
 
+statusCode NfcOled::mifareReadSectors(card& cardInfo, const uint8_t cardNumber, const cardKeys& authenticationKeys, const readOptions& options, sectorStatus& status)
+{
+    display << "\v\n\n\n\n\n\n" << "Reading sectors" << hwlib::flush;
+    auto result = slave.mifareReadSectors(cardInfo, cardNumber, authenticationKeys, options, status);
+
+    if(result != statusCode::pn532StatusOK){
+        display << "\v\n\n\n\n\n\n" << "Read error..." << hwlib::flush;
+    }else{
+        display << "\v\n\n\n\n\n\n" << "Reading complete" << hwlib::flush;
+    }
+    return result;
+}
+
 statusCode NfcOled::mifareMakeValueBlock(card&cardinfo, const uint8_t cardNumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key)
 {
     auto status = slave.mifareMakeValueBlock(cardinfo, cardNumber, AorB, pagenr, sector,key);
@@ -245,4 +342,14 @@ statusCode NfcOled::mifareDecrement(card&cardinfo, const uint8_t cardnumber, con
     return slave.mifareDecrement(cardinfo, cardnumber, AorB, pagenr, sector, key, value);
 }
 
+statusCode NfcOled::mifareValueTransaction(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, const mifareCommands operation, const uint32_t value, uint32_t& newValue)
+{
+    return slave.mifareValueTransaction(cardinfo, cardnumber, AorB, pagenr, sector, key, operation, value, newValue);
+}
+
+statusCode NfcOled::mifareReadValue(card&cardinfo, const uint8_t cardnumber, const mifareCommands AorB, const uint8_t pagenr, const uint8_t sector, const uint8_t* key, uint32_t& value)
+{
+    return slave.mifareReadValue(cardinfo, cardnumber, AorB, pagenr, sector, key, value);
+}
+
 } // namespace n{
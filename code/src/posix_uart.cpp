@@ -0,0 +1,172 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in posix_uart.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/posix_uart.h"
+
+// termios2 (asm/termbits.h) instead of termios.h, so any baudrate can be set with BOTHER
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace hwuart
+{
+
+PosixUart::PosixUart(const char *device, unsigned int baudrate):
+    baudrate(baudrate)
+{
+    fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0){
+        hwlib::cout << "cannot open " << device << hwlib::endl;
+        return;
+    }
+    uart_init();
+}
+
+PosixUart::~PosixUart()
+{
+    if(fd >= 0){ close(fd); }
+}
+
+void PosixUart::uart_init()
+{
+    termios2 settings;
+    if(ioctl(fd, TCGETS2, &settings) != 0){ return; }
+
+    // raw mode, the same as cfmakeraw
+    settings.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+    settings.c_oflag &= ~OPOST;
+    settings.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+
+    // 8 data bits, no parity, one stop bit, no flow control
+    settings.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    settings.c_cflag |= CS8 | CREAD | CLOCAL | BOTHER | (BOTHER << IBSHIFT);
+    settings.c_ispeed = baudrate;
+    settings.c_ospeed = baudrate;
+
+    // reads never block, waiting is done with poll()
+    settings.c_cc[VMIN] = 0;
+    settings.c_cc[VTIME] = 0;
+
+    ioctl(fd, TCSETS2, &settings);
+    ioctl(fd, TCFLSH, TCIOFLUSH);
+    rxBuffer.clear();
+}
+
+bool PosixUart::setBaudrate(const uint32_t newBaudrate)
+{
+    termios2 settings;
+    if(ioctl(fd, TCGETS2, &settings) != 0){ return false; }
+
+    // wait till the output buffer is empty
+    ioctl(fd, TCSBRK, 1);
+
+    settings.c_ispeed = newBaudrate;
+    settings.c_ospeed = newBaudrate;
+    if(ioctl(fd, TCSETS2, &settings) != 0){ return false; }
+    baudrate = newBaudrate;
+    return true;
+}
+
+int PosixUart::avialable()
+{
+    return rxBuffer.returnSize();
+}
+
+void PosixUart::storeByte(const char c)
+{
+    rxBuffer.push_back(c);
+}
+
+bool PosixUart::uart_has_overrun()
+{
+    serial_icounter_struct counters;
+    if(ioctl(fd, TIOCGICOUNT, &counters) != 0){ return false; }
+
+    const int total = counters.overrun + counters.buf_overrun;
+    const bool overrun = total != overruns;
+    overruns = total;
+    return overrun;
+}
+
+uint8_t PosixUart::receiveByte()
+{
+    uint8_t c = 0;
+    if(read(fd, &c, 1) != 1){ return 0; }
+    return c;
+}
+
+bool PosixUart::rxReady()
+{
+    pollfd request = {fd, POLLIN, 0};
+    return poll(&request, 1, 0) > 0 && (request.revents & POLLIN);
+}
+
+uint8_t PosixUart::getC()
+{
+    if(rxBuffer.returnSize() > 0){
+        return rxBuffer.pop();
+    }
+    return 0;
+}
+
+void PosixUart::sendByte(const uint8_t c)
+{
+    sendBytes(&c, 1);
+}
+
+void PosixUart::sendBytes(const uint8_t *data, const size_t nBytes)
+{
+    size_t sent = 0;
+    while(sent < nBytes){
+        const auto n = write(fd, data + sent, nBytes - sent);
+        if(n > 0){
+            sent += n;
+        }else if(n < 0 && (errno == EAGAIN || errno == EINTR)){
+            // the output buffer of the driver is full, sleep until there is room again
+            pollfd request = {fd, POLLOUT, 0};
+            poll(&request, 1, -1);
+        }else{
+            return;
+        }
+    }
+}
+
+bool PosixUart::waitReadable(const uint_fast32_t timeout)
+{
+    if(rxBuffer.returnSize() > 0){ return true; }
+
+    pollfd request = {fd, POLLIN, 0};
+    const timespec time = {static_cast<time_t>(timeout / 1'000'000), static_cast<long>((timeout % 1'000'000) * 1'000)};
+    return ppoll(&request, 1, &time, nullptr) > 0 && (request.revents & POLLIN);
+}
+
+size_t PosixUart::receiveBytes(uint8_t *data, const size_t nBytes, const uint_fast32_t timeout)
+{
+    size_t n = 0;
+    while(n < nBytes && rxBuffer.returnSize() > 0){
+        data[n++] = rxBuffer.pop();
+    }
+
+    while(n < nBytes){
+        const auto received = read(fd, data + n, nBytes - n);
+        if(received > 0){
+            n += received;
+        }else if(received == 0 || errno == EAGAIN || errno == EINTR){
+            if(!waitReadable(timeout)){ break; }
+        }else{
+            break;
+        }
+    }
+    return n;
+}
+
+} // namespace hwuart
@@ -0,0 +1,294 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in protocolTrace.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/protocolTrace.h"
+
+namespace communication{
+
+namespace {
+
+const uint8_t traceHeader[] = {'P', 'T', 0x02};
+
+size_t varintSize(uint_fast64_t value)
+{
+    size_t n = 1;
+    while(value >= 0x80){ value >>= 7; n++; }
+    return n;
+}
+
+size_t writeVarint(uint8_t *out, uint_fast64_t value)
+{
+    size_t n = 0;
+    while(value >= 0x80){
+        out[n++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+// returns the position after the varint, 0 when the varint runs past the end of the trace
+size_t readVarint(const uint8_t *trace, size_t position, size_t size, uint_fast64_t &value)
+{
+    value = 0;
+    for(uint8_t shift = 0; position < size && shift < 64; shift += 7){
+        const uint8_t byte = trace[position++];
+        value |= static_cast<uint_fast64_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)){ return position; }
+    }
+    return 0;
+}
+
+} // namespace
+
+
+// traceRecorder
+
+traceRecorder::traceRecorder(protocol &bus, uint8_t *trace, size_t capacity):
+    bus(bus),
+    trace(trace),
+    capacity(capacity)
+{
+    clear();
+}
+
+void traceRecorder::clear()
+{
+    length = 0;
+    full = capacity < sizeof(traceHeader);
+    if(!full){
+        for(const auto byte : traceHeader){ trace[length++] = byte; }
+    }
+    lastEvent = hwlib::now_us();
+}
+
+bool traceRecorder::beginEvent(traceEvent type, size_t nBytes)
+{
+    const auto now = hwlib::now_us();
+    const auto delay = now - lastEvent;
+    lastEvent = now;
+    if(full){ return false; }
+
+    if(length + 1 + varintSize(delay) + varintSize(nBytes) + nBytes > capacity){
+        full = true;
+        return false;
+    }
+    trace[length++] = static_cast<uint8_t>(type);
+    length += writeVarint(&trace[length], delay);
+    length += writeVarint(&trace[length], nBytes);
+    return true;
+}
+
+void traceRecorder::appendData(const uint8_t *data, size_t nBytes)
+{
+    for(size_t i = 0; i < nBytes; i++){ trace[length++] = data[i]; }
+}
+
+void traceRecorder::wakeUp()
+{
+    beginEvent(traceEvent::wakeUp, 0);
+    bus.wakeUp();
+}
+
+void traceRecorder::sendData(const uint8_t *commandBuffer, size_t nBytes)
+{
+    if(beginEvent(traceEvent::send, nBytes)){ appendData(commandBuffer, nBytes); }
+    bus.sendData(commandBuffer, nBytes);
+}
+
+void traceRecorder::sendData(const segment *segments, size_t count)
+{
+    size_t nBytes = 0;
+    for(size_t i = 0; i < count; i++){ nBytes += segments[i].length; }
+    if(beginEvent(traceEvent::send, nBytes)){
+        for(size_t i = 0; i < count; i++){ appendData(segments[i].data, segments[i].length); }
+    }
+    bus.sendData(segments, count);
+}
+
+void traceRecorder::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    // the time is taken before the read, the data is only known after it
+    const bool stored = beginEvent(traceEvent::receive, nBytes);
+    bus.receiveData(receiveBuffer, nBytes);
+    if(stored){ appendData(receiveBuffer, nBytes); }
+}
+
+void traceRecorder::receiveMore(uint8_t *receiveBuffer, size_t nBytes)
+{
+    const bool stored = beginEvent(traceEvent::receiveMore, nBytes);
+    bus.receiveMore(receiveBuffer, nBytes);
+    if(stored){ appendData(receiveBuffer, nBytes); }
+}
+
+void traceRecorder::endTransaction()
+{
+    beginEvent(traceEvent::endTransaction, 0);
+    bus.endTransaction();
+}
+
+bool traceRecorder::isReady()
+{
+    return bus.isReady();
+}
+
+bool traceRecorder::setBaudrate(const uint32_t baudrate)
+{
+    // the time is taken before the switch, the result is only known after it
+    const bool stored = beginEvent(traceEvent::baudrate, 5);
+    const bool switched = bus.setBaudrate(baudrate);
+    if(stored){
+        const uint8_t bytes[5] = {
+            static_cast<uint8_t>(baudrate), static_cast<uint8_t>(baudrate >> 8),
+            static_cast<uint8_t>(baudrate >> 16), static_cast<uint8_t>(baudrate >> 24),
+            static_cast<uint8_t>(switched)
+        };
+        appendData(bytes, sizeof(bytes));
+    }
+    return switched;
+}
+
+uint32_t traceRecorder::getBaudrate() const
+{
+    return bus.getBaudrate();
+}
+
+
+// traceReplay
+
+traceReplay::traceReplay(const uint8_t *trace, size_t size, bool originalTiming):
+    irq(*this),
+    trace(trace),
+    size(size),
+    originalTiming(originalTiming)
+{
+    if(size >= sizeof(traceHeader) && trace[0] == traceHeader[0] && trace[1] == traceHeader[1] && trace[2] == traceHeader[2]){
+        start = sizeof(traceHeader);
+    }
+    rewind();
+}
+
+void traceReplay::rewind()
+{
+    position = valid() ? start : size;
+    stats = statistics();
+    lastEvent = hwlib::now_us();
+}
+
+bool traceReplay::peek(event &e) const
+{
+    if(position >= size){ return false; }
+
+    uint_fast64_t delay = 0, length = 0;
+    e.type = static_cast<traceEvent>(trace[position]);
+    auto next = readVarint(trace, position + 1, size, delay);
+    if(next == 0){ return false; }
+    next = readVarint(trace, next, size, length);
+    if(next == 0 || length > size - next){ return false; }
+
+    e.delay = delay;
+    e.length = length;
+    e.data = &trace[next];
+    e.next = next + length;
+    return true;
+}
+
+bool traceReplay::frameReady() const
+{
+    event e;
+    if(!originalTiming || !peek(e)){ return true; }
+    if(e.type != traceEvent::receive && e.type != traceEvent::receiveMore){ return true; }
+    return hwlib::now_us() >= lastEvent + e.delay;
+}
+
+const uint8_t* traceReplay::take(traceEvent type, size_t &length)
+{
+    event e;
+    if(!peek(e) || e.type != type){
+        // an extra call of the driver does not use up the event, so the rest of the trace still lines up
+        stats.mismatches++;
+        return nullptr;
+    }
+
+    if(originalTiming && (type == traceEvent::receive || type == traceEvent::receiveMore)){
+        const auto due = lastEvent + e.delay;
+        const auto now = hwlib::now_us();
+        if(now < due){ hwlib::wait_us(due - now); }
+    }
+
+    lastEvent = hwlib::now_us();
+    position = e.next;
+    stats.events++;
+    length = e.length;
+    return e.data;
+}
+
+void traceReplay::wakeUp()
+{
+    size_t length;
+    take(traceEvent::wakeUp, length);
+}
+
+void traceReplay::sendData(const uint8_t *commandBuffer, size_t nBytes)
+{
+    size_t length;
+    const auto data = take(traceEvent::send, length);
+    if(data == nullptr){ return; }
+
+    bool same = length == nBytes;
+    for(size_t i = 0; same && i < nBytes; i++){ same = data[i] == commandBuffer[i]; }
+    if(!same){ stats.mismatches++; }
+}
+
+void traceReplay::read(traceEvent type, uint8_t *receiveBuffer, size_t nBytes)
+{
+    size_t length = 0;
+    const auto data = take(type, length);
+    if(data != nullptr && length != nBytes){ stats.mismatches++; }
+    for(size_t i = 0; i < nBytes; i++){
+        receiveBuffer[i] = (data != nullptr && i < length) ? data[i] : 0x00;
+    }
+}
+
+void traceReplay::receiveData(uint8_t *receiveBuffer, size_t nBytes)
+{
+    read(traceEvent::receive, receiveBuffer, nBytes);
+}
+
+void traceReplay::receiveMore(uint8_t *receiveBuffer, size_t nBytes)
+{
+    read(traceEvent::receiveMore, receiveBuffer, nBytes);
+}
+
+void traceReplay::endTransaction()
+{
+    size_t length;
+    take(traceEvent::endTransaction, length);
+}
+
+bool traceReplay::isReady()
+{
+    return frameReady();
+}
+
+bool traceReplay::setBaudrate(const uint32_t newBaudrate)
+{
+    size_t length;
+    const auto data = take(traceEvent::baudrate, length);
+    if(data == nullptr || length != 5){ return false; }
+
+    const uint32_t recorded = data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    if(recorded != newBaudrate){ stats.mismatches++; }
+
+    // the bus of the recording only runs at the new baudrate when the switch succeeded there
+    const bool switched = data[4] != 0;
+    if(switched){ baudrate = recorded; }
+    return switched;
+}
+
+} // namespace communication
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @brief     This file implements the functions declared in readerPool.h
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../headers/readerPool.h"
+
+namespace nfc{
+
+uint8_t readerPool::addReader(NFC& reader)
+{
+    if(readerCount == maxReaders){ return maxReaders; }
+    readers[readerCount].nfc = &reader;
+    return readerCount++;
+}
+
+statusCode readerPool::enqueue(uint8_t reader, const communication::segment* segments, size_t count, commandListener* listener)
+{
+    if(reader >= readerCount || count == 0 || count > maxSegments){ return statusCode::pn532StatusInvalidParameter; }
+
+    auto &state = readers[reader];
+    if(state.count == queueSize){ return statusCode::pn532StatusBusy; }
+
+    auto &entry = state.queue[(state.head + state.count) % queueSize];
+    for(size_t i = 0; i < count; i++){ entry.segments[i] = segments[i]; }
+    entry.count = count;
+    entry.listener = listener;
+    state.count++;
+    return statusCode::pn532StatusOK;
+}
+
+bool readerPool::turn(readerState& reader)
+{
+    if(reader.busy){
+        const auto state = reader.nfc->poll();
+        if(NFC::inProgress(state)){ return true; }
+
+        reader.busy = false;
+        if(state == commandState::done){ reader.stats.completed++; }
+        else{ reader.stats.failed++; }
+    }
+
+    if(reader.count == 0){ return false; }
+
+    // the chip can be busy with a command that has not been send by the pool, then the job waits
+    const auto &next = reader.queue[reader.head];
+    if(reader.nfc->submit(next.segments, next.count, next.listener) != statusCode::pn532StatusOK){ return true; }
+
+    reader.head = (reader.head + 1) % queueSize;
+    reader.count--;
+    reader.busy = true;
+    reader.stats.submitted++;
+    return true;
+}
+
+bool readerPool::step()
+{
+    bool work = false;
+    for(uint8_t i = 0; i < readerCount; i++){
+        work |= turn(readers[(first + i) % readerCount]);
+    }
+    if(readerCount > 0){ first = (first + 1) % readerCount; }
+    return work;
+}
+
+void readerPool::run()
+{
+    while(step()){}
+}
+
+uint8_t readerPool::pending(uint8_t reader) const
+{
+    if(reader >= readerCount){ return 0; }
+    return readers[reader].count + (readers[reader].busy ? 1 : 0);
+}
+
+} // namespace nfc
@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @brief     Host benchmark of the asynchronous command functions
+ *
+ * A gate detects a card and reads one block of it, over and over again. Next to that it has other work to do,
+ * like refreshing the display and scanning the station pins, which is simulated by 100 us of busy waiting.
+ *
+ *      - blocking:     the work is done after every command
+ *      - asynchronous: the work is done while the command is in flight, between two calls of poll()
+ *
+ * After that a listener and cancel() are shown.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 20;
+
+// display refresh, pin scan, journal, ...
+void otherWork()
+{
+    hwlib::wait_us(100);
+}
+
+class printingListener : public nfc::commandListener {
+public:
+    void acknowledged() override
+    {
+        hwlib::cout << "    listener: acknowledged" << hwlib::endl;
+    }
+
+    void finished(const nfc::Result& result) override
+    {
+        hwlib::cout << "    listener: finished, status " << hwlib::hex << static_cast<int>(result.status)
+                    << ", response code " << static_cast<int>(result.response.finalBuffer[3]) << hwlib::endl;
+    }
+};
+
+} // namespace
+
+int main() {
+    namespace frames = nfc::pn532::frames;
+
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    auto read = frames::mifareRead;
+    read.set(3, 0x00);
+
+    // blocking
+    int work = 0;
+    auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        nfc->sendCommandAndCheckAck(frames::InListPassiveTarget);
+        otherWork(); work++;
+        nfc->sendCommandAndCheckAck(read);
+        otherWork(); work++;
+    }
+    auto elapsed = hwlib::now_us() - start;
+    hwlib::cout << "blocking" << hwlib::endl
+                << "    time:       " << hwlib::dec << static_cast<int>(elapsed) << " us" << hwlib::endl
+                << "    work done:  " << work << hwlib::endl << hwlib::endl;
+
+    // asynchronous
+    work = 0;
+    start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        nfc->submit(frames::InListPassiveTarget);
+        while(nfc::NFC::inProgress(nfc->poll())){ otherWork(); work++; }
+
+        nfc->submit(read);
+        while(nfc::NFC::inProgress(nfc->poll())){ otherWork(); work++; }
+    }
+    elapsed = hwlib::now_us() - start;
+    hwlib::cout << "asynchronous" << hwlib::endl
+                << "    time:       " << static_cast<int>(elapsed) << " us" << hwlib::endl
+                << "    work done:  " << work << hwlib::endl << hwlib::endl;
+
+    // listener
+    hwlib::cout << "listener" << hwlib::endl;
+    auto listener = printingListener();
+    nfc->submit(frames::GetFirmwareVersion, &listener);
+    while(nfc::NFC::inProgress(nfc->poll())){ otherWork(); }
+    hwlib::cout << hwlib::endl;
+
+    // cancel
+    hwlib::cout << "cancel" << hwlib::endl;
+    nfc->submit(frames::InListPassiveTarget);
+    hwlib::cout << "    submit while busy: " << hwlib::hex << static_cast<int>(nfc->submit(frames::GetFirmwareVersion)) << hwlib::endl;
+    nfc->cancel();
+    hwlib::cout << "    after cancel:      " << static_cast<int>(nfc->fetch().status) << hwlib::endl;
+    const auto firmware = nfc->getFirmwareVersion();
+    hwlib::cout << "    next command:      " << static_cast<int>(firmware[0]) << ", PN5" << firmware[1] << hwlib::endl;
+}
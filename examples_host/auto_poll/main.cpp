@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief     Host benchmark of card detection with InAutoPoll
+ *
+ * Every time, the card enters the RF field 300 ms after the host starts to look for it.
+ *
+ *      - detectCard:           blocking InListPassiveTarget with MaxRetries 0xFF, the host is stuck in the call
+ *      - autoPoll (one shot):  the pn532 polls once (150 ms) and gives up, so the host can check its pins and try again
+ *      - startAutoPoll:        the pn532 polls until the card is found, the host does other work and calls poll()
+ *
+ * For every way the time the card was found after entering the field, the amount of commands and the
+ * amount of other work the host could do (1 ms each) are printed.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const uint_fast32_t cardDelay = 300'000;
+
+// display refresh, pin scan, journal, ...
+void otherWork()
+{
+    hwlib::wait_us(1000);
+}
+
+void print(const char* name, communication::pn532Emulator& emulator, bool found, uint_fast64_t start, int work)
+{
+    const auto latency = static_cast<int>(hwlib::now_us() - start) - static_cast<int>(cardDelay);
+    hwlib::cout
+        << name << hwlib::endl
+        << "    card found:         " << found << hwlib::endl
+        << "    found after:        " << hwlib::dec << latency << " us" << hwlib::endl
+        << "    commands:           " << static_cast<int>(emulator.stats.commands) << hwlib::endl
+        << "    other work done:    " << work << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    namespace autoPoll = nfc::pn532::command::autoPoll;
+
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    auto cardInfo = mifare1k();
+
+    // blocking InListPassiveTarget
+    emulator.resetStatistics();
+    emulator.presentCardAfter(cardDelay);
+    auto start = hwlib::now_us();
+    bool found = nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    print("detectCard", emulator, found, start, 0);
+
+    // one shot InAutoPoll, tried again until the card is there
+    nfc::autoPollOptions options;
+    options.pollCount = 1;
+    options.period = 1;
+    emulator.resetStatistics();
+    emulator.presentCardAfter(cardDelay);
+    start = hwlib::now_us();
+    int work = 0;
+    found = false;
+    while(!found){
+        found = nfc->autoPoll(cardInfo, options);
+        if(!found){ otherWork(); work++; }
+    }
+    print("autoPoll (one shot, 1 poll)", emulator, found, start, work);
+
+    // continuous InAutoPoll for a Mifare card or a FeliCa card
+    options.pollCount = autoPoll::pollForever;
+    options.types[0] = autoPoll::FeliCa212kbps;
+    options.types[1] = autoPoll::Mifare;
+    options.typeCount = 2;
+    emulator.resetStatistics();
+    emulator.presentCardAfter(cardDelay);
+    start = hwlib::now_us();
+    work = 0;
+    nfc->startAutoPoll(options);
+    while(nfc::NFC::inProgress(nfc->poll())){ otherWork(); work++; }
+    found = nfc->getAutoPollTarget(cardInfo);
+    print("startAutoPoll (continuous, 2 types)", emulator, found, start, work);
+
+    const auto uid = cardInfo.getUID();
+    hwlib::cout << "UID: " << hwlib::hex << uid[0] << " " << uid[1] << " " << uid[2] << " " << uid[3] << hwlib::endl;
+
+    // stop polling when no card comes
+    emulator.presentCardAfter(10'000'000);
+    nfc->startAutoPoll(options);
+    for(int i = 0; i < 10; i++){ nfc->poll(); otherWork(); }
+    nfc->cancel();
+    const auto firmware = nfc->getFirmwareVersion();
+    hwlib::cout << "after cancel: " << static_cast<int>(firmware[0]) << ", PN5" << firmware[1] << hwlib::endl;
+}
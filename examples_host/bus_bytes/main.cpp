@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @brief     Host benchmark of the amount of bytes that are read over the bus per command
+ *
+ * The driver reads the header of every frame first and then exactly the amount of bytes the header announces.
+ * For every command the amount of bytes that have been send to and read from the chip is printed, next to
+ * the 47 bytes (7 for the ACK frame and 40 for the response) that were always read before.
+ *
+ * The last command echoes 260 bytes, so both the command and the response are send as an extended frame.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int fixedReadBytes = 7 + 40;
+
+void print(const char* name, communication::pn532Emulator& emulator, nfc::statusCode status)
+{
+    hwlib::cout
+        << name << hwlib::endl
+        << "    status:         " << hwlib::hex << static_cast<int>(status) << hwlib::endl
+        << "    bytes send:     " << hwlib::dec << static_cast<int>(emulator.stats.bytesSent) << hwlib::endl
+        << "    bytes read:     " << static_cast<int>(emulator.stats.bytesReceived) << hwlib::endl
+        << "    fixed read:     " << fixedReadBytes << hwlib::endl
+        << hwlib::endl;
+    emulator.resetStatistics();
+}
+
+nfc::statusCode first(const std::array<uint8_t, 5>& result){ return static_cast<nfc::statusCode>(result[0]); }
+nfc::statusCode first(const std::array<uint8_t, 2>& result){ return static_cast<nfc::statusCode>(result[0]); }
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    auto cardInfo = mifare1k();
+
+    emulator.resetStatistics();
+    print("GetFirmwareVersion", emulator, first(nfc->getFirmwareVersion()));
+    print("SAMConfiguration", emulator, nfc->SAMConfiguration(nfc::pn532::command::SAMmode::Normal_mode));
+    print("RFConfiguration", emulator, nfc->RFField(true));
+    print("ReadRegister", emulator, first(nfc->readRegister(0x6309)));
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    print("InListPassiveTarget", emulator, nfc::statusCode::pn532StatusOK);
+    print("Authenticate", emulator, nfc->mifareAuthenticate(cardInfo, 1, nfc::authenticateKeyA, 3, nfc::pn532::general::DefaultKey));
+    print("Read 16 bytes", emulator, nfc->mifareReadPage(cardInfo, 1, 1));
+
+    // communication line test with 260 bytes of data
+    uint8_t commands[262] = {nfc::pn532::command::PerformSelftest, nfc::pn532::command::diagnose::CommunicationLineTest};
+    for(uint16_t i = 2; i < sizeof(commands); i++){ commands[i] = static_cast<uint8_t>(i); }
+    auto command = setupSendCommand(commands, sizeof(commands));
+    auto [status, response] = nfc->sendCommandAndCheckAck(command);
+
+    bool echoed = status == nfc::statusCode::pn532StatusOK && response.length == sizeof(commands) + 5;
+    for(uint16_t i = 2; echoed && i < sizeof(commands); i++){ echoed = response.finalBuffer[i + 3] == commands[i]; }
+    print(echoed ? "Extended frame echo (ok)" : "Extended frame echo (FAILED)", emulator, status);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief     Host example of writing the changed blocks of a card image with commit()
+ *
+ * A card is personalised with 12 blocks in sector 1 - 4. The program sets the blocks in the order of its fields,
+ * which runs through the sectors: block 4, 8, 12, 16, 5, 9, ...
+ *
+ *      - by hand:      every block is authenticated, written with mifareWritePage() and read back with mifareReadPage()
+ *      - commit:       the blocks are set in a cardImage and written with commit(), sector by sector
+ *      - again:        the same blocks are set again after the commit, nothing has changed so nothing is written
+ *
+ * At last a new key B is written to the trailer of sector 5.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+#include "../../code/headers/cardImage.h"
+
+namespace {
+
+// the blocks of the personalisation, in the order of the fields
+const uint8_t fieldBlocks[] = {4, 8, 12, 16, 5, 9, 13, 17, 6, 10, 14, 18};
+const uint8_t* key = nfc::pn532::general::DefaultKey;
+
+nfc::cardImage::block personalisation(uint8_t page, uint8_t version)
+{
+    nfc::cardImage::block data;
+    for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ data[i] = version + page + i; }
+    return data;
+}
+
+// whether the emulated card holds the personalisation
+int blocksOnCard(communication::pn532Emulator& emulator, uint8_t version)
+{
+    int correct = 0;
+    for(const auto page : fieldBlocks){
+        const auto data = personalisation(page, version);
+        bool same = true;
+        for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ same &= emulator.cards[0].memory[page * cardGeometry::blockSize + i] == data[i]; }
+        correct += same;
+    }
+    return correct;
+}
+
+void print(const char* name, communication::pn532Emulator& emulator, nfc::statusCode status, int correct)
+{
+    hwlib::cout
+        << name << hwlib::endl
+        << "    status:             " << hwlib::hex << static_cast<int>(status) << hwlib::endl
+        << "    commands:           " << hwlib::dec << static_cast<int>(emulator.stats.commands) << hwlib::endl
+        << "    authentications:    " << static_cast<int>(emulator.stats.authentications) << hwlib::endl
+        << "    blocks on the card: " << correct << " of " << static_cast<int>(sizeof(fieldBlocks)) << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    nfc::cardKeys keys;
+
+    // by hand
+    {
+        auto cardInfo = mifare1k();
+        nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+        emulator.resetStatistics();
+
+        auto status = nfc::statusCode::pn532StatusOK;
+        for(const auto page : fieldBlocks){
+            const auto data = personalisation(page, 0x10);
+            nfc->mifareAuthenticate(cardInfo, 1, nfc::authenticateKeyA, page, key);
+            nfc->mifareWritePage(cardInfo, 1, page, reinterpret_cast<const char*>(data.data()));
+            nfc->mifareReadPage(cardInfo, 1, page);
+            if(cardInfo.getPage(page) != data){ status = nfc::statusCode::pn532StatusVerifyError; }
+        }
+        hwlib::cout << hwlib::endl;
+        print("by hand", emulator, status, blocksOnCard(emulator, 0x10));
+    }
+
+    // commit
+    auto cardInfo = mifare1k();
+    auto image = nfc::cardImage(*nfc, cardInfo, keys);
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    emulator.resetStatistics();
+
+    for(const auto page : fieldBlocks){ image.setPage(page, personalisation(page, 0x20)); }
+    const auto dirty = cardInfo.pagesDirty();
+    auto status = image.commit();
+    print("commit", emulator, status, blocksOnCard(emulator, 0x20));
+    hwlib::cout
+        << "    changed blocks:     " << static_cast<int>(dirty) << hwlib::endl
+        << "    written blocks:     " << static_cast<int>(image.stats.writes) << hwlib::endl
+        << hwlib::endl;
+
+    // again, with the same content
+    emulator.resetStatistics();
+    for(const auto page : fieldBlocks){ image.setPage(page, personalisation(page, 0x20)); }
+    status = image.commit();
+    print("again", emulator, status, blocksOnCard(emulator, 0x20));
+
+    // a new key B for sector 5, the access bits stay the transport configuration
+    const uint16_t trailer = cardGeometry::trailerOf(5);
+    nfc::cardImage::block trailerData;
+    image.getPage(trailer, trailerData);
+    for(uint8_t i = 0; i < 6; i++){
+        trailerData[i] = key[i];           // a real card reads key A as 0's, so it is set again
+        trailerData[10 + i] = 0xB0 + i;
+    }
+    image.setPage(trailer, trailerData);
+    status = image.commit();
+
+    bool keyWritten = true;
+    for(uint8_t i = 0; i < 6; i++){ keyWritten &= emulator.cards[0].memory[trailer * cardGeometry::blockSize + 10 + i] == 0xB0 + i; }
+    hwlib::cout
+        << "new trailer" << hwlib::endl
+        << "    status:             " << hwlib::hex << static_cast<int>(status) << hwlib::endl
+        << "    key B on the card:  " << (keyWritten ? "new" : "old") << hwlib::endl;
+}
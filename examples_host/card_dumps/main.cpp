@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief     Host example of the binary card dump format
+ *
+ *      - one dump:     a 1k card is read completely and its record is made. The first 1024 bytes of the record must be
+ *                      the memory of the card, the .mfd layout
+ *      - archive:      the dumps of many cards are appended to a file with dumpWriter
+ *      - scan:         the file is mapped with dumpFile and the value block of every dump is checked, in place
+ *
+ * The archive is written to /tmp and removed at the end.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+#include "../../code/headers/cardDumpFile.h"
+
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+const char* archive = "/tmp/card_dumps.mcdr";
+const uint32_t dumps = 100'000;
+const uint8_t valueBlock = 0x05;
+
+const uint8_t uid[] = {0x04, 0x5A, 0x31, 0x92, 0x6C, 0x48, 0x80};
+
+// every data byte holds the number of its block
+void fill(communication::pn532Emulator& emulator)
+{
+    for(uint16_t block = 1; block < mifare1kGeometry.blocks(); block++){
+        if(cardGeometry::isTrailer(block)){ continue; }
+        for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ emulator.cards[0].memory[block * cardGeometry::blockSize + i] = block; }
+    }
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    emulator.cards[0].format(uid, sizeof(uid));
+    fill(emulator);
+
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    // one dump
+    auto cardInfo = mifare1k();
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    nfc::cardKeys keys;
+    nfc::readOptions options;
+    nfc::sectorStatus status;
+    nfc->mifareReadSectors(cardInfo, 1, keys, options, status);
+    const uint64_t readTime = std::time(nullptr);
+
+    uint8_t record[dumpFormat::recordSize(mifare1kGeometry)];
+    const auto size = writeDump(cardInfo, readTime, readTime, record, sizeof(record));
+    bool sameAsCard = true;
+    for(uint16_t i = 0; i < mifare1kGeometry.size(); i++){ sameAsCard &= record[i] == emulator.cards[0].memory[i]; }
+
+    const auto dump = dumpRecord(record, dumpGeometry(record, size));
+    const auto identity = dump.identity();
+    hwlib::cout
+        << "one dump" << hwlib::endl
+        << "    record size:        " << hwlib::dec << static_cast<int>(size) << " bytes" << hwlib::endl
+        << "    valid:              " << (dump.valid() ? "yes" : "no") << hwlib::endl
+        << "    sectors:            " << static_cast<int>(dump.geometry().sectors) << hwlib::endl
+        << "    UID:                " << hwlib::hex;
+    for(uint8_t i = 0; i < identity.uidSize; i++){ hwlib::cout << hwlib::setw(2) << hwlib::setfill('0') << identity.uid[i] << " "; }
+    hwlib::cout
+        << hwlib::endl
+        << "    SAK:                " << hwlib::setw(2) << identity.sak << hwlib::endl
+        << "    ATQA:               " << hwlib::setw(2) << identity.atqa[0] << " " << hwlib::setw(2) << identity.atqa[1] << hwlib::endl
+        << "    first 1024 bytes:   " << (sameAsCard ? "the same as the card (.mfd)" : "different") << hwlib::endl
+        << hwlib::endl;
+
+    // archive: the same card over and over, with another UID and balance every time
+    unlink(archive);
+    auto start = hwlib::now_us();
+    {
+        auto writer = dumpWriter(archive);
+        for(uint32_t i = 0; i < dumps; i++){
+            const uint8_t newUid[] = {0x04, static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i >> 16), 0x6C, 0x48, 0x80};
+            auto copy = cardInfo.getPage(valueBlock);
+            copy[0] = static_cast<uint8_t>(i % 200);
+            cardInfo.setUID(newUid, sizeof(newUid));    // another card, so the pages are cleared
+            for(uint16_t block = 0; block < mifare1kGeometry.blocks(); block++){
+                const auto data = (block == valueBlock) ? copy : std::array<uint8_t, cardGeometry::blockSize>{static_cast<uint8_t>(block)};
+                cardInfo.setPage(block, data.data());
+            }
+            if(!writer.append(cardInfo, readTime, readTime)){ hwlib::cout << "append failed" << hwlib::endl; break; }
+        }
+    }
+    const auto writeTime = hwlib::now_us() - start;
+
+    // scan: count the dumps with a high first byte in the value block
+    start = hwlib::now_us();
+    auto file = dumpFile(archive);
+    uint32_t high = 0, invalid = 0;
+    for(size_t i = 0; i < file.count(); i++){
+        const auto entry = file[i];
+        const uint8_t *block = entry.block(valueBlock);
+        if(!entry.valid() || block == nullptr){ invalid++; continue; }
+        if(block[0] >= 190){ high++; }
+    }
+    const auto scanTime = hwlib::now_us() - start;
+
+    hwlib::cout
+        << "archive of " << hwlib::dec << static_cast<int>(dumps) << " dumps" << hwlib::endl
+        << "    records in file:    " << static_cast<int>(file.count()) << hwlib::endl
+        << "    invalid:            " << static_cast<int>(invalid) << hwlib::endl
+        << "    high value block:   " << static_cast<int>(high) << " (expected " << static_cast<int>(dumps / 20) << ")" << hwlib::endl
+        << "    write per dump:     " << static_cast<int>(writeTime * 1000 / dumps) << " ns" << hwlib::endl
+        << "    scan per dump:      " << static_cast<int>(scanTime * 1000 / dumps) << " ns" << hwlib::endl;
+
+    unlink(archive);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief     Host example of Mifare Classic cards of every size, with 4 and 7 byte UIDs
+ *
+ * The emulated card is formatted as a Mini, a 1k and a 4k, with a 4 or a 7 byte UID. Every card is detected and
+ * read completely into a card object of its own size (mifareMini, mifare1k, mifare4k). The last block before the
+ * sector trailer of the last sector holds a marker, which must be read back from the right place in the card object.
+ *
+ * At last the size of the card objects is printed: a card object without memory only holds the UID.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const uint8_t shortUid[] = {0xDE, 0xAD, 0xBE, 0xEF};
+const uint8_t longUid[]  = {0x04, 0x5A, 0x31, 0x92, 0x6C, 0x48, 0x80};
+
+template<typename cardType>
+void readCard(const char* name, communication::pn532Emulator& emulator, nfc::NFC& nfc, const uint8_t* uid, uint8_t uidLength)
+{
+    auto cardInfo = cardType();
+    const auto& geometry = cardInfo.geometry();
+
+    // a marker in the last data block of the last sector
+    emulator.cards[0].format(uid, uidLength, geometry);
+    const uint16_t marked = geometry.trailerOf(geometry.sectors - 1) - 1;
+    for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ emulator.cards[0].memory[marked * cardGeometry::blockSize + i] = 0xA0 + i; }
+
+    emulator.resetStatistics();
+    nfc.detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+
+    nfc::cardKeys keys;
+    nfc::readOptions options;
+    nfc::sectorStatus status;
+    const auto result = nfc.mifareReadSectors(cardInfo, 1, keys, options, status);
+
+    const auto block = cardInfo.getPage(marked);
+    bool markerFound = true;
+    for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ markerFound &= block[i] == 0xA0 + i; }
+
+    const auto uidRead = cardInfo.getUID();
+    hwlib::cout << name << hwlib::endl << "    UID:            " << hwlib::hex;
+    for(uint8_t i = 0; i < cardInfo.getUIDsize(); i++){ hwlib::cout << hwlib::setw(2) << hwlib::setfill('0') << uidRead[i] << " "; }
+    hwlib::cout
+        << hwlib::endl
+        << "    sectors:        " << hwlib::dec << static_cast<int>(geometry.sectors) << hwlib::endl
+        << "    blocks:         " << static_cast<int>(geometry.blocks()) << hwlib::endl
+        << "    read status:    " << hwlib::hex << static_cast<int>(result) << hwlib::endl
+        << "    commands:       " << hwlib::dec << static_cast<int>(emulator.stats.commands) << hwlib::endl
+        << "    marker block " << static_cast<int>(marked) << ": " << (markerFound ? "ok" : "wrong") << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+
+    readCard<mifareMini>("Mifare Mini, 4 byte UID", emulator, chip, shortUid, sizeof(shortUid));
+    readCard<mifare1k>("Mifare Classic 1k, 4 byte UID", emulator, chip, shortUid, sizeof(shortUid));
+    readCard<mifare1k>("Mifare Classic 1k, 7 byte UID", emulator, chip, longUid, sizeof(longUid));
+    readCard<mifare4k>("Mifare Classic 4k, 7 byte UID", emulator, chip, longUid, sizeof(longUid));
+
+    hwlib::cout
+        << "size of the card objects" << hwlib::endl
+        << "    card:           " << hwlib::dec << static_cast<int>(sizeof(card)) << " bytes" << hwlib::endl
+        << "    mifareMini:     " << static_cast<int>(sizeof(mifareMini)) << " bytes" << hwlib::endl
+        << "    mifare1k:       " << static_cast<int>(sizeof(mifare1k)) << " bytes" << hwlib::endl
+        << "    mifare4k:       " << static_cast<int>(sizeof(mifare4k)) << " bytes" << hwlib::endl;
+}
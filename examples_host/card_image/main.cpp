@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief     Host example of the read-through card image
+ *
+ * A program that only needs a few blocks of a card is run twice:
+ *
+ *      - full read:    the card is read completely with mifareReadSectors() and the blocks are taken from the card object
+ *      - card image:   the blocks are taken from a cardImage, which only reads the blocks that are asked for
+ *
+ * Every block is asked for many times, only the first access of a block reads it from the card.
+ * After that a card with another UID is selected: the image forgets the blocks of the old card.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+#include "../../code/headers/cardImage.h"
+
+namespace {
+
+const int rounds = 100;
+const uint8_t blocksUsed[] = {4, 5, 6, 9, 60};     // three blocks of sector 1, one of sector 2 and one of sector 15
+
+const uint8_t firstUid[]  = {0xDE, 0xAD, 0xBE, 0xEF};
+const uint8_t secondUid[] = {0xCA, 0xFE, 0xBA, 0xBE};
+
+// every data byte holds the number of its block
+void fill(communication::pn532Emulator& emulator)
+{
+    for(uint16_t block = 1; block < mifare1kGeometry.blocks(); block++){
+        if(cardGeometry::isTrailer(block)){ continue; }
+        for(uint8_t i = 0; i < cardGeometry::blockSize; i++){ emulator.cards[0].memory[block * cardGeometry::blockSize + i] = block; }
+    }
+}
+
+void print(const char* name, communication::pn532Emulator& emulator, int correct, uint_fast64_t elapsed)
+{
+    hwlib::cout
+        << name << hwlib::endl
+        << "    commands:           " << hwlib::dec << static_cast<int>(emulator.stats.commands) << hwlib::endl
+        << "    authentications:    " << static_cast<int>(emulator.stats.authentications) << hwlib::endl
+        << "    correct blocks:     " << correct << " of " << static_cast<int>(rounds * sizeof(blocksUsed)) << hwlib::endl
+        << "    time:               " << static_cast<int>(elapsed) << " us" << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    emulator.cards[0].format(firstUid);
+    fill(emulator);
+
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    nfc::cardKeys keys;
+
+    // full read
+    {
+        auto cardInfo = mifare1k();
+        nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+        emulator.resetStatistics();
+        const auto start = hwlib::now_us();
+
+        nfc::readOptions options;
+        nfc::sectorStatus status;
+        nfc->mifareReadSectors(cardInfo, 1, keys, options, status);
+
+        int correct = 0;
+        for(int i = 0; i < rounds; i++){
+            for(const auto block : blocksUsed){ correct += cardInfo.getPage(block)[0] == block; }
+        }
+        print("full read", emulator, correct, hwlib::now_us() - start);
+    }
+
+    // card image
+    auto cardInfo = mifare1k();
+    auto image = nfc::cardImage(*nfc, cardInfo, keys);
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    emulator.resetStatistics();
+    const auto start = hwlib::now_us();
+
+    int correct = 0;
+    nfc::cardImage::block data;
+    for(int i = 0; i < rounds; i++){
+        for(const auto block : blocksUsed){
+            correct += image.getPage(block, data) == nfc::statusCode::pn532StatusOK && data[0] == block;
+        }
+    }
+    print("card image", emulator, correct, hwlib::now_us() - start);
+    hwlib::cout
+        << "    blocks read:        " << static_cast<int>(image.stats.reads) << hwlib::endl
+        << "    hits:               " << static_cast<int>(image.stats.hits) << hwlib::endl
+        << "    blocks in image:    " << static_cast<int>(cardInfo.pagesRead()) << hwlib::endl
+        << hwlib::endl;
+
+    // another card in the RF field
+    emulator.cards[0].format(secondUid);
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    const auto blocksLeft = cardInfo.pagesRead();
+    const auto status = image.getPage(0, data);
+    hwlib::cout
+        << "another card" << hwlib::endl
+        << "    blocks in image:    " << hwlib::dec << static_cast<int>(blocksLeft) << " after the selection" << hwlib::endl
+        << "    block 0:            status " << hwlib::hex << static_cast<int>(status) << ", UID " << data[0] << data[1] << data[2] << data[3] << hwlib::endl;
+}
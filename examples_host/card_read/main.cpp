@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief     Host benchmark of the sector read of a Mifare Classic card
+ *
+ * The key A of sector 5 of the emulated card is changed, so that sector can not be authenticated with the default keys.
+ *
+ *      - page by page:     every page is read on its own, the sector is authenticated before its first page
+ *                          and failed authentications are ignored (the behaviour of mifareReadCard before mifareReadSectors)
+ *      - all sectors:      every sector is authenticated once, a sector that fails is skipped
+ *      - skip trailers:    the same, without reading the sector trailers
+ *      - switch key:       a sector that fails with key A is tried again with key B
+ *      - subset:           only sectors 1 to 4 are read
+ *      - abort:            the read stops at the first sector that fails
+ *
+ * For every read the amount of commands, the time and the status of every sector are printed.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+void print(const char* name, communication::pn532Emulator& emulator, uint_fast64_t elapsed, const nfc::sectorStatus* status)
+{
+    hwlib::cout
+        << name << hwlib::endl
+        << "    commands:   " << hwlib::dec << static_cast<int>(emulator.stats.commands) << hwlib::endl
+        << "    time:       " << static_cast<int>(elapsed) << " us" << hwlib::endl;
+    if(status != nullptr){
+        hwlib::cout << "    status:    " << hwlib::hex;
+        for(uint8_t i = 0; i < mifare1kGeometry.sectors; i++){ hwlib::cout << " " << hwlib::setw(2) << hwlib::setfill('0') << static_cast<int>((*status)[i]); }
+        hwlib::cout << hwlib::endl;
+    }
+    hwlib::cout << hwlib::endl;
+}
+
+void readSectors(const char* name, communication::pn532Emulator& emulator, nfc::NFC& nfc, card& cardInfo, const nfc::readOptions& options)
+{
+    nfc::cardKeys keys;
+    nfc::sectorStatus status;
+
+    emulator.resetStatistics();
+    const auto start = hwlib::now_us();
+    nfc.mifareReadSectors(cardInfo, 1, keys, options, status);
+    print(name, emulator, hwlib::now_us() - start, &status);
+}
+
+} // namespace
+
+int main() {
+    namespace frames = nfc::pn532::frames;
+    using nfc::pn532::general::Mifare1kPageSize;
+
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    // sector 5 gets another key A
+    for(uint8_t i = 0; i < 6; i++){ emulator.cards[0].memory[(5 * 4 + 3) * Mifare1kPageSize + i] = 0xA0 + i; }
+
+    auto cardInfo = mifare1k();
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    nfc::cardKeys keys;
+
+    // page by page
+    emulator.resetStatistics();
+    auto start = hwlib::now_us();
+    for(uint8_t page = 0; page < 64; page++){
+        if(page % 4 == 0){
+            auto authenticate = frames::mifareAuthenticate;
+            authenticate.set(3, page + 3);
+            authenticate.set(4, keys.aKeys[page / 4], 6);
+            authenticate.set(10, cardInfo.authenticationUID(), 4);
+            nfc->sendCommandAndCheckAck(authenticate);
+        }
+        auto read = frames::mifareRead;
+        read.set(3, page);
+        nfc->sendCommandAndCheckAck(read);
+    }
+    print("page by page", emulator, hwlib::now_us() - start, nullptr);
+    nfc->sendCommandAndCheckAck(frames::InListPassiveTarget);
+
+    nfc::readOptions options;
+    readSectors("all sectors", emulator, *nfc, cardInfo, options);
+
+    options.skipTrailers = true;
+    readSectors("skip trailers", emulator, *nfc, cardInfo, options);
+
+    options.onAuthFailure = nfc::authFailurePolicy::switchKey;
+    readSectors("switch key", emulator, *nfc, cardInfo, options);
+
+    options.sectorMask = 0x001E;
+    readSectors("subset (sectors 1 - 4)", emulator, *nfc, cardInfo, options);
+
+    options.sectorMask = 0xFFFF;
+    options.onAuthFailure = nfc::authFailurePolicy::abort;
+    readSectors("abort", emulator, *nfc, cardInfo, options);
+}
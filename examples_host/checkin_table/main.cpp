@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @brief     Host example of a table of checked in cards that only stores the identity of the cards
+ *
+ * The train application keeps the cards that are checked in. A table of card objects without memory
+ * (cardIdentity) takes 20 bytes per card, where a table of mifare1k objects takes more than 1 KB per card.
+ *
+ * A few hundred passengers check in: the card is polled, the balance is read with mifareReadValue() and the identity
+ * of the card is stored. Then every passenger checks out: the card is looked up in the table and a card object is made
+ * from the identity for the mifareValueTransaction(). No memory of a card is stored at any point.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int passengers = 300;
+const uint8_t valueBlock = 0x05;
+const uint8_t trailerBlock = 0x07;
+const uint8_t* key = nfc::pn532::general::DefaultKey;
+const uint32_t startBalance = 2000;
+
+// the card of a passenger arrives in the RF field: a 4 byte UID and a value block with startBalance
+void arrive(communication::pn532Emulator& emulator, int passenger)
+{
+    const uint8_t uid[] = {0x42, static_cast<uint8_t>(passenger), static_cast<uint8_t>(passenger >> 8), 0x17};
+    auto &emulated = emulator.cards[0];
+    emulated.format(uid);
+
+    // value, inverted value, value, address, inverted address, address, inverted address
+    uint8_t *block = &emulated.memory[valueBlock * cardGeometry::blockSize];
+    for(uint8_t i = 0; i < 4; i++){
+        block[i]     = static_cast<uint8_t>(startBalance >> (8 * i));
+        block[4 + i] = static_cast<uint8_t>(~startBalance >> (8 * i));
+        block[8 + i] = static_cast<uint8_t>(startBalance >> (8 * i));
+    }
+    block[12] = block[14] = valueBlock;
+    block[13] = block[15] = static_cast<uint8_t>(~valueBlock);
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    nfc::autoPollOptions options;
+    options.pollCount = 1;
+    options.period = 1;
+
+    static std::array<cardIdentity, passengers> checkins;
+    int checkedIn = 0, balancesCached = 0;
+
+    const auto startCheckIn = hwlib::now_us();
+    for(int i = 0; i < passengers; i++){
+        arrive(emulator, i);
+        auto cardInfo = card();
+        uint32_t balance = 0;
+        if(!nfc->autoPoll(cardInfo, options)){ continue; }
+        if(nfc->mifareReadValue(cardInfo, cardInfo.getTargetNumber(), nfc::authenticateKeyA, valueBlock, trailerBlock, key, balance) != nfc::statusCode::pn532StatusOK){ continue; }
+
+        checkins[i] = cardInfo.getIdentity();
+        checkedIn++;
+        if(checkins[i].hasValue() && checkins[i].value == startBalance){ balancesCached++; }
+    }
+    const auto checkInTime = hwlib::now_us() - startCheckIn;
+
+    int found = 0, checkedOut = 0;
+    uint_fast64_t lookupTime = 0;
+    const auto startCheckOut = hwlib::now_us();
+    for(int i = passengers - 1; i >= 0; i--){
+        arrive(emulator, i);
+        auto cardInfo = card();
+        if(!nfc->autoPoll(cardInfo, options)){ continue; }
+
+        const auto startLookup = hwlib::now_us();
+        int index = -1;
+        for(int j = 0; j < passengers; j++){
+            if(checkins[j] == cardInfo.getIdentity()){ index = j; break; }
+        }
+        lookupTime += hwlib::now_us() - startLookup;
+        if(index != i){ continue; }
+        found++;
+
+        // the price is the index, so every balance after the check out is different
+        auto checkedInCard = card(checkins[index]);
+        uint32_t balance = 0;
+        if(nfc->mifareValueTransaction(checkedInCard, cardInfo.getTargetNumber(), nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, index, balance) == nfc::statusCode::pn532StatusOK
+           && balance == startBalance - index && checkedInCard.getIdentity().value == balance){
+            checkedOut++;
+        }
+        checkins[index] = cardIdentity();
+    }
+    const auto checkOutTime = hwlib::now_us() - startCheckOut;
+
+    hwlib::cout
+        << "size of a table entry" << hwlib::endl
+        << "    cardIdentity:   " << hwlib::dec << static_cast<int>(sizeof(cardIdentity)) << " bytes" << hwlib::endl
+        << "    card:           " << static_cast<int>(sizeof(card)) << " bytes" << hwlib::endl
+        << "    mifare1k:       " << static_cast<int>(sizeof(mifare1k)) << " bytes" << hwlib::endl
+        << hwlib::endl
+        << "table of " << passengers << " cards" << hwlib::endl
+        << "    cardIdentity:   " << static_cast<int>(sizeof(checkins)) << " bytes" << hwlib::endl
+        << "    mifare1k:       " << static_cast<int>(passengers * sizeof(mifare1k)) << " bytes" << hwlib::endl
+        << hwlib::endl
+        << "check in" << hwlib::endl
+        << "    checked in:             " << checkedIn << hwlib::endl
+        << "    balance in identity:    " << balancesCached << hwlib::endl
+        << "    time per check in:      " << static_cast<int>(checkInTime / passengers) << " us" << hwlib::endl
+        << hwlib::endl
+        << "check out" << hwlib::endl
+        << "    found in table:         " << found << hwlib::endl
+        << "    checked out:            " << checkedOut << hwlib::endl
+        << "    time per lookup:        " << static_cast<int>(lookupTime / passengers) << " us" << hwlib::endl
+        << "    time per check out:     " << static_cast<int>(checkOutTime / passengers) << " us" << hwlib::endl;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @brief     Host check and benchmark of the compile time command frames
+ *
+ * This file checks that every precomputed (and patched) command frame is equal to the frame setupSendCommand
+ * builds at runtime. After that, the time to build a frame is measured for both ways, and a page is written
+ * to the software pn532 emulator with the scatter-gather send path and read back.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 100'000;
+
+bool equal(const communication::segment* segments, size_t count, const uint8_t* commands, uint16_t size)
+{
+    auto expected = setupSendCommand(commands, size);
+    size_t index = 0;
+    for(size_t i = 0; i < count; i++){
+        for(size_t j = 0; j < segments[i].length; j++){
+            if(index >= expected.length || segments[i].data[j] != expected.finalbuffer[index]){ return false; }
+            index++;
+        }
+    }
+    return index == expected.length;
+}
+
+template<uint8_t n>
+void check(const char* name, const commandFrame<n>& frame, std::initializer_list<uint8_t> commands)
+{
+    const auto segment = frame.segment();
+    const bool ok = equal(&segment, 1, commands.begin(), commands.size());
+    hwlib::cout << (ok ? "    ok      " : "    FAILED  ") << name << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    namespace frames = nfc::pn532::frames;
+    namespace cmd = nfc::pn532::command;
+
+    // the frames are build by the compiler
+    static_assert(frames::GetFirmwareVersion.finalbuffer[6] == static_cast<uint8_t>(~(0xD4 + 0x02) + 1), "DCS is computed at compile time");
+
+    hwlib::cout << "precomputed frames" << hwlib::endl;
+    check("GetFirmwareVersion", frames::GetFirmwareVersion, {cmd::GetFirmwareVersion});
+    check("SAMConfiguration", frames::SAMConfiguration, {cmd::SAMConfiguration, cmd::SAMmode::Normal_mode});
+    check("RFField on", frames::RFFieldOn, {cmd::RFConfiguration, cmd::RFItem::RFField, 0x01});
+    check("RFField off", frames::RFFieldOff, {cmd::RFConfiguration, cmd::RFItem::RFField, 0x00});
+    check("InListPassiveTarget", frames::InListPassiveTarget, {cmd::InListPassiveTarget, 0x01, cmd::TypeA_ISO_IEC14443});
+
+    hwlib::cout << "patched frames" << hwlib::endl;
+    auto sam = frames::SAMConfiguration;
+    sam.set(1, cmd::SAMmode::Virtual_mode);
+    check("SAMConfiguration virtual mode", sam, {cmd::SAMConfiguration, cmd::SAMmode::Virtual_mode});
+
+    const uint8_t key[] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+    const uint8_t uid[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    auto authenticate = frames::mifareAuthenticate;
+    authenticate.set(2, nfc::authenticateKeyB);
+    authenticate.set(3, 0x07);
+    authenticate.set(4, key, 6);
+    authenticate.set(10, uid, 4);
+    check("mifareAuthenticate", authenticate, {cmd::InDataExchange, 0x01, nfc::authenticateKeyB, 0x07,
+        key[0], key[1], key[2], key[3], key[4], key[5], uid[0], uid[1], uid[2], uid[3]});
+
+    uint8_t data[16];
+    for(uint8_t i = 0; i < 16; i++){ data[i] = 0x10 * i + i; }
+    auto write = frames::mifareWrite;
+    write.set(3, 0x01);
+    communication::segment segments[3];
+    write.segments(data, segments);
+    uint8_t writeCommands[20] = {cmd::InDataExchange, 0x01, nfc::Write16Bytes, 0x01};
+    for(uint8_t i = 0; i < 16; i++){ writeCommands[4 + i] = data[i]; }
+    hwlib::cout << (equal(segments, 3, writeCommands, 20) ? "    ok      " : "    FAILED  ") << "mifareWrite (scatter-gather)" << hwlib::endl;
+
+    // time to build a write frame
+    uint8_t sink = 0;
+    auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        writeCommands[3] = static_cast<uint8_t>(i);
+        auto command = setupSendCommand(writeCommands, sizeof(writeCommands));
+        sink += command.finalbuffer[command.length - 1];
+    }
+    const auto runtime = hwlib::now_us() - start;
+
+    start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        auto frame = frames::mifareWrite;
+        frame.set(3, static_cast<uint8_t>(i));
+        frame.segments(data, segments);
+        sink += *segments[2].data;
+    }
+    const auto compiletime = hwlib::now_us() - start;
+
+    hwlib::cout << hwlib::endl
+        << "build a write frame (" << rounds << " times)" << hwlib::endl
+        << "    setupSendCommand:   " << static_cast<int>(runtime) << " us" << hwlib::endl
+        << "    commandFrame:       " << static_cast<int>(compiletime) << " us" << hwlib::endl
+        << "    (" << sink << ")" << hwlib::endl << hwlib::endl;
+
+    // write and read back a page over the emulator
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    auto cardInfo = mifare1k();
+    nfc->detectCard(cardInfo, 1, cmd::TypeA_ISO_IEC14443);
+    nfc->mifareAuthenticate(cardInfo, 1, nfc::authenticateKeyA, 3, nfc::pn532::general::DefaultKey);
+    nfc->mifareWritePage(cardInfo, 1, 1, reinterpret_cast<const char*>(data));
+    nfc->mifareReadPage(cardInfo, 1, 1);
+
+    const auto page = cardInfo.getPage(1);
+    bool same = true;
+    for(uint8_t i = 0; i < 16; i++){ same = same && page[i] == data[i]; }
+    hwlib::cout << (same ? "write and read back ok" : "write and read back FAILED") << hwlib::endl;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief     Host example of the checksum check and the NACK retransmission of damaged responses
+ *
+ * Check outs (mifareValueTransaction, decrement by 1) are done over and over again. Every fifth check out one
+ * response is damaged on the bus: a bit of its data is flipped, like noise on a long bit-banged bus does.
+ * The driver sees the wrong DCS and asks the chip for the response again with a NACK, so the command is not
+ * executed again. The balance must go down by exactly one per check out, and the amount of authentications and
+ * commands per check out must be the same as without damage.
+ *
+ * At last every response is damaged, which makes the command fail with pn532StatusChecksumError.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 50;
+const uint8_t valueBlock = 0x05;
+const uint8_t trailerBlock = 0x07;
+const uint8_t* key = nfc::pn532::general::DefaultKey;
+
+void checkOuts(const char* name, communication::pn532Emulator& emulator, nfc::PN532_chip& chip, card& cardInfo, bool damage)
+{
+    nfc::NFC *nfc = &chip;
+    uint32_t before = 0, after = 0;
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 0, before);
+
+    emulator.resetStatistics();
+    chip.resetLinkStatistics();
+    int failed = 0;
+    for(int i = 0; i < rounds; i++){
+        if(damage && i % 5 == 0){ emulator.damageResponses = 1; }
+        failed += nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 1, after) != nfc::pn532StatusOK;
+    }
+    const auto& link = chip.getLinkStatistics();
+    const auto commands = emulator.stats.commands;
+    const auto authentications = emulator.stats.authentications;
+
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 0, after);
+    hwlib::cout
+        << name << hwlib::endl
+        << "    balance:                        " << hwlib::dec << static_cast<int>(before) << " -> " << static_cast<int>(after)
+        << " (" << static_cast<int>(before - after) << " check outs)" << hwlib::endl
+        << "    failed check outs:              " << failed << hwlib::endl
+        << "    commands per check out:         " << static_cast<int>(commands / rounds) << hwlib::endl
+        << "    authentications:                " << static_cast<int>(authentications) << hwlib::endl
+        << "    checksum errors:                " << static_cast<int>(link.checksumErrors) << hwlib::endl
+        << "    retransmissions (NACK):         " << static_cast<int>(link.retransmits) << hwlib::endl
+        << "    unrecovered:                    " << static_cast<int>(link.unrecovered) << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    auto cardInfo = mifare1k();
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    nfc->mifareMakeValueBlock(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key);
+    uint32_t balance = 0;
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Incrementation, 1000, balance);
+    hwlib::cout << hwlib::endl;
+
+    checkOuts("clean bus", emulator, chip, cardInfo, false);
+    checkOuts("every fifth check out one damaged response", emulator, chip, cardInfo, true);
+
+    hwlib::cout << "every response damaged" << hwlib::endl;
+    chip.resetLinkStatistics();
+    emulator.damageResponses = 100;
+    const auto firmware = nfc->getFirmwareVersion();
+    emulator.damageResponses = 0;
+    hwlib::cout << "    status:                         " << hwlib::hex << static_cast<int>(firmware[0]) << hwlib::endl
+                << "    retransmissions (NACK):         " << hwlib::dec << static_cast<int>(chip.getLinkStatistics().retransmits) << hwlib::endl
+                << "    unrecovered:                    " << static_cast<int>(chip.getLinkStatistics().unrecovered) << hwlib::endl;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief     Host example of the negotiated HSU baudrate switch of the pn532 driver
+ *
+ * This file runs the pn532 driver over hwuart::PosixUart against the software pn532 emulator behind a
+ * pseudo-terminal (pn532EmulatorPty), which takes the time a frame needs at the baudrate of the link.
+ *
+ * The link starts at 115200 baud. For every baudrate setSerialBaudrate() does the complete switch
+ * (command, ACK of the host, switch of both sides, communication line test) and a page is read over and over again.
+ * At last the emulated chip refuses a switch, which shows the fallback to the old baudrate.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532EmulatorPty.h"
+#include "../../code/headers/posix_uart.h"
+
+namespace {
+
+const int rounds = 20;
+
+const nfc::baudRate baudrates[] = {
+    nfc::_9k6Baud, nfc::_19k2Baud, nfc::_38k4Baud, nfc::_57k6Baud, nfc::_115k2Baud,
+    nfc::_230k4Baud, nfc::_460k8Baud, nfc::_921k6Baud, nfc::_1m2kBaud
+};
+
+void readPages(nfc::NFC *nfc, card& cardinfo)
+{
+    int failed = 0;
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        failed += nfc->mifareReadPage(cardinfo, 1, 4) != nfc::pn532StatusOK;
+    }
+    const auto elapsed = hwlib::now_us() - start;
+
+    hwlib::cout << "    time per page read: " << hwlib::dec << static_cast<int>(elapsed / rounds) << " us" << hwlib::endl
+                << "    failed reads:       " << failed << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    namespace cmd = nfc::pn532::command;
+
+    auto emulator = communication::pn532Emulator();
+    auto pty = communication::pn532EmulatorPty(emulator);
+    pty.start();
+
+    auto serial = hwuart::PosixUart(pty.slaveName(), 115200);
+    if(!serial.isOpen()){ return 1; }
+    auto bus = communication::uart(serial);
+    auto ready = communication::uartReady(serial);
+
+    // over HSU the irq pin is not connected
+    auto chip = nfc::PN532_chip(bus, hwlib::pin_in_dummy, ready);
+    nfc::NFC *nfc = &chip;
+    auto cardinfo = mifare1k();
+
+    if(!nfc->detectCard(cardinfo, 1, cmd::TypeA_ISO_IEC14443)
+       || nfc->mifareAuthenticate(cardinfo, 1, nfc::authenticateKeyA, 4, nfc::pn532::general::DefaultKey) != nfc::pn532StatusOK){
+        hwlib::cout << "no card" << hwlib::endl;
+        return 1;
+    }
+
+    for(const auto br : baudrates){
+        const auto start = hwlib::now_us();
+        const auto status = nfc->setSerialBaudrate(br);
+        const auto elapsed = hwlib::now_us() - start;
+
+        hwlib::cout << hwlib::dec << static_cast<int>(nfc::baudRateValue(br)) << " baud" << hwlib::endl
+                    << "    switch:             " << static_cast<int>(elapsed) << " us, status " << hwlib::hex << status << hwlib::endl
+                    << "    host / chip:        " << hwlib::dec << static_cast<int>(serial.getBaudrate()) << " / "
+                    << static_cast<int>(emulator.serialBaudrate) << hwlib::endl;
+        readPages(nfc, cardinfo);
+        hwlib::cout << hwlib::endl;
+    }
+
+    // the chip answers, but keeps its baudrate: the driver has to go back to the old one
+    emulator.failBaudrateSwitch = true;
+    const auto status = nfc->setSerialBaudrate(nfc::_115k2Baud);
+    hwlib::cout << "refused switch to 115200 baud" << hwlib::endl
+                << "    status:             " << hwlib::hex << status
+                << (status == nfc::pn532StatusBaudrateFallback ? " (fallback)" : "") << hwlib::endl
+                << "    host / chip:        " << hwlib::dec << static_cast<int>(serial.getBaudrate()) << " / "
+                << static_cast<int>(emulator.serialBaudrate) << hwlib::endl;
+    readPages(nfc, cardinfo);
+
+    pty.stop();
+}
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @brief     Host benchmark of the bit-banged i2c bus implementations of hwlib
+ *
+ * This file writes and reads a block of bytes over hwlib::i2c_bus_bit_banged_scl_sda (virtual pin calls,
+ * a fixed wait_us(1) half period) and over hwlib::i2c_bus_bit_banged_scl_sda_static (concrete pin types,
+ * compile-time half period). The pins are in-memory pins that count every call, so the cost of the
+ * implementations can be compared per transferred byte.
+ *
+ * At last the slave holds scl low, which the static bus survives because of its clock stretch timeout.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "hwlib.hpp"
+
+namespace {
+
+const size_t blockSize = 1'000;
+const uint8_t address = 0x24;
+
+/// \brief
+/// In-memory open collector pin that counts its calls and the edges on the line
+class countingPin : public hwlib::pin_oc
+{
+private:
+    bool level = true;
+    bool external = true;
+
+public:
+    uint_fast32_t writes    = 0;
+    uint_fast32_t edges     = 0;
+    uint_fast32_t flushes   = 0;
+    uint_fast32_t reads     = 0;
+
+    bool read() override { ++reads; return level && external; }
+    void refresh() override {}
+
+    void write(bool x) override { ++writes; edges += (x != level); level = x; }
+    void flush() override { ++flushes; }
+
+    /// \brief
+    /// Release (true) or pull down (false) the line from the slave side
+    void set(bool x){ external = x; }
+
+    void reset(){ writes = edges = flushes = reads = 0; }
+};
+
+void report(const char* name, hwlib::i2c_bus& bus, countingPin& scl, countingPin& sda)
+{
+    uint8_t data[blockSize];
+    for(size_t i = 0; i < blockSize; i++){ data[i] = i * 7; }
+    scl.reset();
+    sda.reset();
+
+    const auto start = hwlib::now_us();
+    bus.write(address).write(data, blockSize);
+    bus.read(address).read(data, blockSize);
+    const auto elapsed = hwlib::now_us() - start;
+
+    const auto bytes = 2 * blockSize;
+    const auto calls = scl.writes + scl.flushes + scl.reads + sda.writes + sda.flushes + sda.reads;
+    hwlib::cout << name << hwlib::endl
+                << "    pin calls per byte:   " << hwlib::dec << static_cast<int>(calls / bytes) << hwlib::endl
+                << "    scl edges per byte:   " << static_cast<int>(scl.edges / bytes) << hwlib::endl
+                << "    sda edges per byte:   " << static_cast<int>(sda.edges / bytes) << hwlib::endl
+                << "    time per byte:        " << static_cast<int>(elapsed * 1000 / bytes) << " ns" << hwlib::endl
+                << "    scl clock:            " << static_cast<int>((scl.edges / 2) * 1000 / (elapsed ? elapsed : 1)) << " kHz" << hwlib::endl
+                << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto scl = countingPin();
+    auto sda = countingPin();
+
+    auto classic = hwlib::i2c_bus_bit_banged_scl_sda(scl, sda);
+    report("i2c_bus_bit_banged_scl_sda", classic, scl, sda);
+
+    auto standard = hwlib::i2c_bus_bit_banged_scl_sda_static<countingPin, countingPin, 5'000>(scl, sda);
+    report("i2c_bus_bit_banged_scl_sda_static, 5000 ns half period", standard, scl, sda);
+
+    auto fast = hwlib::i2c_bus_bit_banged_scl_sda_static<countingPin, countingPin, 0>(scl, sda);
+    report("i2c_bus_bit_banged_scl_sda_static, no wait", fast, scl, sda);
+
+    // a slave that never releases scl: every bit waits the stretch timeout, instead of forever
+    auto stretched = hwlib::i2c_bus_bit_banged_scl_sda_static<countingPin, countingPin, 0, 10>(scl, sda);
+    hwlib::i2c_bus &bus = stretched;
+    scl.set(false);
+    const auto start = hwlib::now_us();
+    bus.write(address).write(0x00);
+    scl.set(true);
+    hwlib::cout << "scl held low by the slave" << hwlib::endl
+                << "    stretch timeouts:     " << hwlib::dec << static_cast<int>(stretched.stretch_timeouts()) << hwlib::endl
+                << "    transaction time:     " << static_cast<int>(hwlib::now_us() - start) << " us" << hwlib::endl;
+}
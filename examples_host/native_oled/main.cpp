@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief     Host run of the complete nfc stack on the native Linux target of hwlib
+ *
+ * This file runs the pn532 driver, the oled decorator and the terminal rendering on a Linux host.
+ * The oled is an in-memory window of the native target that prints itself on every flush,
+ * the pn532 is the software emulator.
+ *
+ *      - the precision of the sleeping waits and the busy waits
+ *      - detecting a card and reading a page through the oled decorator, with the display output
+ *      - the time the rendering of one screen takes
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Oled.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 20;
+
+template<typename wait>
+void waitPrecision(const char* name, wait w)
+{
+    int_fast32_t worst = 0;
+    for(const int_fast32_t us : {10, 100, 500, 2000}){
+        const auto start = hwlib::now_us();
+        w(us);
+        const int_fast32_t late = static_cast<int_fast32_t>(hwlib::now_us() - start) - us;
+        if(late > worst){ worst = late; }
+    }
+    hwlib::cout << "    " << name << " worst lateness: " << hwlib::dec << static_cast<int>(worst) << " us" << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    namespace cmd = nfc::pn532::command;
+
+    hwlib::cout << "wait precision" << hwlib::endl;
+    waitPrecision("wait_us:     ", [](int_fast32_t us){ hwlib::wait_us(us); });
+    waitPrecision("wait_us_busy:", [](int_fast32_t us){ hwlib::wait_us_busy(us); });
+    hwlib::cout << hwlib::endl;
+
+    auto oled    = hwlib::target::window(128, 64);
+    auto font    = hwlib::font_default_8x8();
+    auto display = hwlib::terminal_from(oled, font);
+
+    auto emulator = communication::pn532Emulator();
+    auto chip     = nfc::PN532_chip(emulator, emulator.irq);
+    auto nfcOled  = nfc::NfcOled(chip, display, emulator);
+    nfc::NFC *nfc = &nfcOled;
+
+    oled.print = true;
+    auto cardinfo = mifare1k();
+    nfc->detectCard(cardinfo, 1, cmd::TypeA_ISO_IEC14443);
+    oled.print = false;
+
+    // rendering of one screen
+    oled.writes = 0;
+    oled.flushes = 0;
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        display << "\f\v" << "Card found" << "\n" << "Round " << hwlib::dec << i << hwlib::flush;
+    }
+    const auto elapsed = hwlib::now_us() - start;
+
+    hwlib::cout << hwlib::endl
+                << "render a screen" << hwlib::endl
+                << "    time per screen:    " << hwlib::dec << static_cast<int>(elapsed / rounds) << " us" << hwlib::endl
+                << "    pixels per screen:  " << static_cast<int>(oled.writes / rounds) << hwlib::endl
+                << "    flushes:            " << static_cast<int>(oled.flushes) << hwlib::endl;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file
+ * @brief     Host benchmark of the power state tracking of the pn532 driver
+ *
+ * A wake up of the emulator takes 2 ms, the same as the wake up pulse of the spi protocol.
+ *
+ *      - back to back commands with a wake up before every command (idle timeout 0, the old behaviour)
+ *      - back to back commands with power state tracking
+ *      - power down, after which the next command wakes the chip once
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 50;
+
+void benchmark(const char* name, communication::pn532Emulator& emulator, nfc::PN532_chip& chip)
+{
+    nfc::NFC *nfc = &chip;
+    emulator.resetStatistics();
+
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        nfc->RFField(true);
+    }
+    const auto elapsed = hwlib::now_us() - start;
+
+    hwlib::cout
+        << name << hwlib::endl
+        << "    time per command:   " << hwlib::dec << static_cast<int>(elapsed / rounds) << " us" << hwlib::endl
+        << "    wake ups:           " << static_cast<int>(emulator.stats.wakeUps) << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    namespace cmd = nfc::pn532::command;
+
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    chip.setIdleTimeout(0);
+    benchmark("wake up before every command", emulator, chip);
+
+    chip.setIdleTimeout(1000);
+    benchmark("power state tracking", emulator, chip);
+
+    hwlib::cout << "power down" << hwlib::endl;
+    emulator.resetStatistics();
+    const auto status = nfc->powerDown(cmd::wakeUpSource::I2C | cmd::wakeUpSource::SPI | cmd::wakeUpSource::HSU);
+    hwlib::cout << "    status:             " << hwlib::hex << static_cast<int>(status) << hwlib::endl
+                << "    powered down:       " << (chip.getPowerState() == nfc::powerState::poweredDown) << hwlib::endl;
+
+    const auto firmware = nfc->getFirmwareVersion();
+    nfc->getFirmwareVersion();
+    hwlib::cout << "    next command:       " << static_cast<int>(firmware[0]) << ", PN5" << firmware[1] << hwlib::endl
+                << "    wake ups:           " << hwlib::dec << static_cast<int>(emulator.stats.wakeUps) << hwlib::endl;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief     Host benchmark of several pn532 readers on one spi bus
+ *
+ * This file connects up to 8 software pn532 emulators to one emulated spi bus with a 1 MHz clock (pn532EmulatorSpi).
+ * Every reader has its own sel and irq pin and a card in its field. A tap is the work a gate does for a card:
+ * InListPassiveTarget, authenticate block 4 and read block 4.
+ *
+ *      - one after another:    the readers are used with the blocking functions, one tap after another
+ *      - reader pool:          every reader does its taps through the queue of an nfc::readerPool, so the bus is
+ *                              used for the other readers while one waits for its card
+ *
+ * For 1, 2, 4 and 8 readers the taps per second of both are printed.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532EmulatorSpi.h"
+#include "../../code/headers/readerPool.h"
+
+#include <optional>
+
+namespace {
+
+namespace frames = nfc::pn532::frames;
+
+const uint_fast64_t duration    = 1'000'000;    // time in us every measurement takes
+const uint8_t       block       = 4;
+const uint8_t       readerCounts[] = {1, 2, 4, 8};
+
+/// \brief
+/// The commands of one tap. The authentication frame gets the UID of the card that has been found
+struct tapFrames{
+    commandFrame<14>   authenticate = frames::mifareAuthenticate;
+    commandFrame<4>    read         = frames::mifareRead;
+
+    tapFrames(){ authenticate.set(3, block); read.set(3, block); }
+
+    /// \brief
+    /// Copies the UID out of an InListPassiveTarget response, returns false when no card has been found
+    bool setUid(const nfc::Result& result){
+        const auto *frame = result.response.finalBuffer;
+        if(result.status != nfc::pn532StatusOK || frame[3] != 0x4B || frame[4] == 0){ return false; }
+        for(uint8_t i = 0; i < 4; i++){ authenticate.set(10 + i, frame[10 + i]); }
+        return true;
+    }
+
+    /// \brief
+    /// Returns whether an InDataExchange has been answered without error
+    static bool exchanged(const nfc::Result& result){
+        return result.status == nfc::pn532StatusOK && result.response.finalBuffer[4] == 0x00;
+    }
+};
+
+/// \brief
+/// Does taps on one reader of the pool: every finished command enqueues the next one
+class tapListener : public nfc::commandListener
+{
+private:
+    nfc::readerPool &pool;
+    uint8_t         reader = 0;
+    uint8_t         step = 0;
+    tapFrames       tap;
+
+public:
+    uint_fast32_t   taps = 0;
+    bool            stopping = false;
+
+    tapListener(nfc::readerPool &pool): pool(pool){}
+
+    void start(uint8_t number){ reader = number; step = 0; pool.enqueue(reader, frames::InListPassiveTarget, this); }
+
+    void finished(const nfc::Result& result) override
+    {
+        if(step == 0 && tap.setUid(result)){
+            step = 1;
+            pool.enqueue(reader, tap.authenticate, this);
+            return;
+        }
+        if(step == 1 && tapFrames::exchanged(result)){
+            step = 2;
+            pool.enqueue(reader, tap.read, this);
+            return;
+        }
+        if(step == 2 && tapFrames::exchanged(result)){ taps++; }
+
+        // the tap is done or has failed, the next card
+        step = 0;
+        if(!stopping){ pool.enqueue(reader, frames::InListPassiveTarget, this); }
+    }
+};
+
+/// \brief
+/// The readers of one measurement on one spi bus
+struct gate{
+    communication::pn532Emulator    emulators[nfc::readerPool::maxReaders];
+    communication::pn532EmulatorSpi bus;
+    std::optional<communication::spi>   protocols[nfc::readerPool::maxReaders];
+    std::optional<nfc::PN532_chip>      chips[nfc::readerPool::maxReaders];
+
+    gate(uint8_t count){
+        bus.byteTime = 8000;
+        for(uint8_t i = 0; i < count; i++){
+            auto &sel = bus.attach(emulators[i]);
+            protocols[i].emplace(bus, sel, emulators[i].irq);
+            chips[i].emplace(*protocols[i], emulators[i].irq);
+        }
+    }
+};
+
+uint_fast32_t oneAfterAnother(uint8_t count)
+{
+    gate readers(count);
+    tapFrames taps[nfc::readerPool::maxReaders];
+    uint_fast32_t done = 0;
+
+    const auto end = hwlib::now_us() + duration;
+    while(hwlib::now_us() < end){
+        for(uint8_t i = 0; i < count; i++){
+            nfc::NFC *nfc = &*readers.chips[i];
+            if(!taps[i].setUid(nfc->sendCommandAndCheckAck(frames::InListPassiveTarget))){ continue; }
+            if(!tapFrames::exchanged(nfc->sendCommandAndCheckAck(taps[i].authenticate))){ continue; }
+            done += tapFrames::exchanged(nfc->sendCommandAndCheckAck(taps[i].read));
+        }
+    }
+    return done;
+}
+
+uint_fast32_t pooled(uint8_t count)
+{
+    gate readers(count);
+    nfc::readerPool pool;
+    std::optional<tapListener> listeners[nfc::readerPool::maxReaders];
+
+    for(uint8_t i = 0; i < count; i++){
+        listeners[i].emplace(pool);
+        listeners[i]->start(pool.addReader(*readers.chips[i]));
+    }
+
+    const auto end = hwlib::now_us() + duration;
+    while(hwlib::now_us() < end){ pool.step(); }
+
+    // let the commands that are in flight finish
+    for(uint8_t i = 0; i < count; i++){ listeners[i]->stopping = true; }
+    pool.run();
+
+    uint_fast32_t done = 0;
+    for(uint8_t i = 0; i < count; i++){ done += listeners[i]->taps; }
+    return done;
+}
+
+} // namespace
+
+int main() {
+    hwlib::cout << "readers   one after another   reader pool    (taps per second)" << hwlib::endl;
+    for(const auto count : readerCounts){
+        const auto sequential = oneAfterAnother(count);
+        const auto pool = pooled(count);
+        hwlib::cout << hwlib::dec << hwlib::setw(7) << count
+                    << hwlib::setw(20) << static_cast<int>(sequential * 1'000'000 / duration)
+                    << hwlib::setw(15) << static_cast<int>(pool * 1'000'000 / duration) << hwlib::endl;
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief     Host benchmark of the different ready strategies of the pn532 driver
+ *
+ * The emulator answers every command after the time a real pn532 needs (ackDelay + responseDelay).
+ *
+ * The same set of commands is executed with three different ready strategies:
+ *      - irq polling every 10 ms       (the behaviour of the driver before the ready strategies were added)
+ *      - tight irq polling
+ *      - status polling over the bus   (spi status read / i2c ready bit)
+ *
+ * For every strategy the average time per command is printed, together with the time the emulated chip
+ * needs to answer and the amount of bus status reads per command.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 50;
+
+void benchmark(const char* name, communication::pn532Emulator& emulator, communication::readyStrategy& ready)
+{
+    auto chip = nfc::PN532_chip(emulator, emulator.irq, ready);
+    nfc::NFC *nfc = &chip;
+    emulator.resetStatistics();
+
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        nfc->getFirmwareVersion();
+        nfc->SAMConfiguration(nfc::pn532::command::SAMmode::Normal_mode);
+        nfc->RFField(true);
+    }
+    const auto elapsed = hwlib::now_us() - start;
+
+    hwlib::cout
+        << name << hwlib::endl
+        << "    time per command:        " << hwlib::dec << static_cast<int>(elapsed / emulator.stats.commands) << " us" << hwlib::endl
+        << "    chip response time:      " << static_cast<int>(emulator.ackDelay + emulator.responseDelay) << " us" << hwlib::endl
+        << "    status reads per command: " << static_cast<int>(emulator.stats.statusReads / emulator.stats.commands) << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+
+    auto legacy = communication::irqReady(emulator.irq, 10'000);
+    auto irq    = communication::irqReady(emulator.irq);
+    auto status = communication::statusReady(emulator);
+
+    benchmark("irq polling every 10 ms", emulator, legacy);
+    benchmark("tight irq polling", emulator, irq);
+    benchmark("status polling over the bus", emulator, status);
+}
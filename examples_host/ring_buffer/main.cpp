@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief     Host stress test and benchmark of the uart ringbuffer (hwuart::buffer)
+ *
+ * A producer thread plays the rx interrupt: it pushes a stream of pn532 frames (with preamble, postamble and
+ * a sequence number) into the buffer in chunks of random size. A consumer thread plays the main loop and takes
+ * the frames out with popFrame(). Every frame is checked on its checksums and sequence number.
+ *
+ *      - lossless: the producer retries when the buffer is full, every frame must arrive
+ *      - lossy:    the producer sends bursts that do not fit and drops what does not fit, like an interrupt
+ *                  that cannot wait. The consumer must skip the damaged frames and find the start of the next one
+ *      - throughput of byte-at-a-time push_back / pop against bulk push / pop on spans
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/hardware_uart.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+const uint32_t frames = 20'000;
+
+using ringbuffer = hwuart::buffer<512>;
+
+// small xorshift generator, so both threads can make reproducible random numbers
+struct randomGenerator{
+    uint32_t state;
+    uint32_t next(){ state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+// preamble, start code, LEN, LCS, TFI, sequence number, payload, DCS, postamble
+size_t makeFrame(uint32_t sequence, randomGenerator& random, uint8_t *out)
+{
+    const uint8_t payload = 4 + random.next() % 200;
+    const uint8_t len = payload + 1;
+    size_t n = 0;
+    out[n++] = 0x00; out[n++] = 0x00; out[n++] = 0xFF;
+    out[n++] = len;
+    out[n++] = ~len + 1;
+    uint8_t sum = out[n++] = 0xD5;
+    for(uint8_t i = 0; i < payload; i++){
+        const uint8_t byte = (i < 4) ? (sequence >> (8 * i)) & 0xFF : random.next() & 0xFF;
+        out[n++] = byte;
+        sum += byte;
+    }
+    out[n++] = ~sum + 1;
+    out[n++] = 0x00;
+    return n;
+}
+
+struct result{
+    uint32_t received = 0;
+    uint32_t broken   = 0;      // frames with a wrong DCS
+};
+
+result stress(bool lossless, ringbuffer& buffer)
+{
+    std::atomic<bool> done{false};
+    result r;
+
+    std::thread producer([&]{
+        randomGenerator random{12345};
+        uint8_t frame[300];
+        for(uint32_t sequence = 0; sequence < frames; sequence++){
+            const size_t length = makeFrame(sequence, random, frame);
+            size_t sent = 0;
+            while(sent < length){
+                const size_t chunk = 1 + random.next() % 64;
+                const size_t amount = (length - sent < chunk) ? length - sent : chunk;
+                if(lossless){
+                    // write straight into the free space, and wait when there is none
+                    const auto free = buffer.writable();
+                    const size_t fits = (amount < free.length) ? amount : free.length;
+                    for(size_t i = 0; i < fits; i++){ free.data[i] = frame[sent + i]; }
+                    buffer.commit(fits);
+                    sent += fits;
+                    if(fits == 0){ std::this_thread::yield(); }
+                }else{
+                    buffer.push(&frame[sent], amount);
+                    sent += amount;
+                }
+            }
+
+            // bursts of 8 frames, more than the buffer can hold
+            if(!lossless && sequence % 8 == 7){ std::this_thread::yield(); }
+        }
+        done = true;
+    });
+
+    std::thread consumer([&]{
+        uint8_t frame[300];
+        uint32_t expected = 0;
+        while(true){
+            const bool last = done;
+            const size_t length = buffer.popFrame(frame, sizeof(frame));
+            if(length == 0){
+                if(last){ break; }
+                std::this_thread::yield();
+                continue;
+            }
+            uint8_t sum = 0;
+            for(size_t i = 4; i < length; i++){ sum += frame[i]; }
+            if(sum != 0){ r.broken++; continue; }
+
+            const uint32_t sequence = frame[5] | (frame[6] << 8) | (frame[7] << 16) | (static_cast<uint32_t>(frame[8]) << 24);
+            if(sequence < expected){ r.broken++; continue; }
+            expected = sequence + 1;
+            r.received++;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    return r;
+}
+
+void report(const char* name, const result& r, const ringbuffer& buffer)
+{
+    hwlib::cout << name << hwlib::endl
+                << "    frames received:    " << hwlib::dec << static_cast<int>(r.received) << " of " << static_cast<int>(frames) << hwlib::endl
+                << "    broken frames:      " << static_cast<int>(r.broken) << hwlib::endl
+                << "    lost frames:        " << static_cast<int>(frames - r.received) << hwlib::endl
+                << "    dropped bytes:      " << static_cast<int>(buffer.dropped()) << hwlib::endl
+                << "    overruns:           " << static_cast<int>(buffer.overruns()) << hwlib::endl
+                << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto lossless = ringbuffer();
+    report("lossless producer", stress(true, lossless), lossless);
+
+    auto lossy = ringbuffer();
+    report("lossy producer", stress(false, lossy), lossy);
+
+    // single threaded throughput: 256 bytes in, 256 bytes out
+    const int rounds = 100'000;
+    auto buffer = ringbuffer();
+    uint8_t data[256];
+    for(int i = 0; i < 256; i++){ data[i] = i; }
+    uint32_t sink = 0;
+
+    auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        for(const auto byte : data){ buffer.push_back(byte); }
+        for(size_t j = 0; j < sizeof(data); j++){ sink += buffer.pop(); }
+    }
+    const auto single = hwlib::now_us() - start;
+
+    start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        buffer.push(data, sizeof(data));
+        sink += buffer.pop(data, sizeof(data));
+    }
+    const auto bulk = hwlib::now_us() - start;
+
+    const auto megabytes = rounds * sizeof(data) / 1'000'000;
+    hwlib::cout << "throughput (" << static_cast<int>(megabytes) << " MB)" << hwlib::endl
+                << "    push_back / pop:    " << static_cast<int>(single / 1000) << " ms" << hwlib::endl
+                << "    bulk push / pop:    " << static_cast<int>(bulk / 1000) << " ms" << hwlib::endl
+                << "    (" << static_cast<int>(sink & 0xFF) << ")" << hwlib::endl;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @brief     Host benchmark of the bit-banged spi bus implementations of hwlib
+ *
+ * This file writes and reads a block of bytes over hwlib::spi_bus_bit_banged_sclk_mosi_miso (virtual pin calls,
+ * a fixed wait_us(1) half period, both directions for every bit) and over
+ * hwlib::spi_bus_bit_banged_sclk_mosi_miso_static (concrete pin types, compile-time half period and bit order,
+ * write-only and read-only paths).
+ *
+ * The pins record every write in a trace. The trace is decoded again (mosi is sampled at the rising edge of sclk),
+ * which checks the bit order, and its length gives the pin operations per byte.
+ * A simulated slave shifts a known pattern out on miso, which checks the read direction.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "hwlib.hpp"
+
+namespace {
+
+const size_t blockSize = 1'000;
+
+/// \brief
+/// Recorded pin writes
+struct pinTrace{
+    struct event{
+        uint8_t pin;
+        bool    level;
+    };
+
+    static const size_t capacity = 64 * 1024;
+    event   events[capacity];
+    size_t  count = 0;
+    uint_fast32_t reads = 0;
+
+    void record(uint8_t pin, bool level){ if(count < capacity){ events[count++] = {pin, level}; } }
+    void clear(){ count = 0; reads = 0; }
+};
+
+pinTrace trace;
+
+enum tracedPins : uint8_t { sclkPin, mosiPin };
+
+/// \brief
+/// Slave that shifts bytes out on miso, one bit per falling edge of sclk
+struct spiSlave{
+    const uint8_t  *data = nullptr;
+    size_t          bit  = 0;
+    bool            lsbFirst = true;
+
+    bool current() const {
+        const uint8_t byte = data[(bit / 8) % blockSize];
+        const uint8_t index = bit % 8;
+        return (byte >> (lsbFirst ? index : 7 - index)) & 0x01;
+    }
+};
+
+spiSlave slave;
+
+/// \brief
+/// Output pin that records its writes
+template<uint8_t id>
+class tracedPin : public hwlib::pin_out
+{
+private:
+    bool level = false;
+
+public:
+    void write(bool x) override {
+        if(id == sclkPin && level && !x){ slave.bit++; }
+        level = x;
+        trace.record(id, x);
+    }
+    void flush() override {}
+};
+
+/// \brief
+/// Input pin that reads the bit the slave shifts out
+class slavePin : public hwlib::pin_in
+{
+public:
+    bool read() override { trace.reads++; return slave.current(); }
+    void refresh() override {}
+};
+
+/// \brief
+/// Decodes the bytes on mosi out of the trace
+size_t decode(bool lsbFirst, uint8_t *out, size_t n)
+{
+    bool mosi = false;
+    size_t bits = 0;
+    for(size_t i = 0; i < trace.count && bits < 8 * n; i++){
+        const auto &e = trace.events[i];
+        if(e.pin == mosiPin){ mosi = e.level; continue; }
+        if(!e.level){ continue; }
+
+        // rising edge of sclk
+        uint8_t &byte = out[bits / 8];
+        const uint8_t index = bits % 8;
+        if(index == 0){ byte = 0; }
+        byte |= mosi << (lsbFirst ? index : 7 - index);
+        bits++;
+    }
+    return bits / 8;
+}
+
+void report(const char* name, hwlib::spi_bus& bus, bool lsbFirst)
+{
+    uint8_t out[blockSize];
+    uint8_t in[blockSize];
+    uint8_t decoded[blockSize];
+    for(size_t i = 0; i < blockSize; i++){ out[i] = i * 7 + 3; }
+
+    slave.data = out;
+    slave.bit = 0;
+    slave.lsbFirst = lsbFirst;
+
+    auto sel = hwlib::pin_out_dummy;
+    auto transaction = bus.transaction(sel);
+
+    // write only
+    trace.clear();
+    auto start = hwlib::now_us();
+    transaction.write(blockSize, out);
+    const auto writeTime = hwlib::now_us() - start;
+    const auto writeEvents = trace.count + trace.reads;
+    const bool writeOk = decode(lsbFirst, decoded, blockSize) == blockSize
+                         && [&]{ for(size_t i = 0; i < blockSize; i++){ if(decoded[i] != out[i]){ return false; } } return true; }();
+
+    // read only
+    trace.clear();
+    slave.bit = 0;
+    start = hwlib::now_us();
+    transaction.read(blockSize, in);
+    const auto readTime = hwlib::now_us() - start;
+    const auto readEvents = trace.count + trace.reads;
+    bool readOk = true;
+    for(size_t i = 0; i < blockSize; i++){ readOk = readOk && in[i] == out[i]; }
+
+    // both directions
+    trace.clear();
+    slave.bit = 0;
+    start = hwlib::now_us();
+    transaction.write_and_read(blockSize, out, in);
+    const auto bothTime = hwlib::now_us() - start;
+    const auto bothEvents = trace.count + trace.reads;
+    transaction.endTransaction();
+
+    hwlib::cout << name << hwlib::endl
+                << "                          write   read    both" << hwlib::endl
+                << "    pin operations/byte:  " << hwlib::dec
+                << hwlib::setw(8) << static_cast<int>(writeEvents / blockSize)
+                << hwlib::setw(8) << static_cast<int>(readEvents / blockSize)
+                << hwlib::setw(8) << static_cast<int>(bothEvents / blockSize) << hwlib::endl
+                << "    ns per byte:          "
+                << hwlib::setw(8) << static_cast<int>(writeTime * 1000 / blockSize)
+                << hwlib::setw(8) << static_cast<int>(readTime * 1000 / blockSize)
+                << hwlib::setw(8) << static_cast<int>(bothTime * 1000 / blockSize) << hwlib::endl
+                << "    data correct:         "
+                << hwlib::setw(8) << (writeOk ? "yes" : "no")
+                << hwlib::setw(8) << (readOk ? "yes" : "no") << hwlib::endl
+                << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto sclk = tracedPin<sclkPin>();
+    auto mosi = tracedPin<mosiPin>();
+    auto miso = slavePin();
+
+    using hwlib::spi_bit_order;
+    using sclkType = tracedPin<sclkPin>;
+    using mosiType = tracedPin<mosiPin>;
+
+    auto classic = hwlib::spi_bus_bit_banged_sclk_mosi_miso(sclk, mosi, miso);
+    report("spi_bus_bit_banged_sclk_mosi_miso", classic, true);
+
+    auto same = hwlib::spi_bus_bit_banged_sclk_mosi_miso_static<sclkType, mosiType, slavePin, 1'000>(sclk, mosi, miso);
+    report("spi_bus_bit_banged_sclk_mosi_miso_static, 1000 ns, lsb first", same, true);
+
+    auto fast = hwlib::spi_bus_bit_banged_sclk_mosi_miso_static<sclkType, mosiType, slavePin, 0>(sclk, mosi, miso);
+    report("spi_bus_bit_banged_sclk_mosi_miso_static, no wait, lsb first", fast, true);
+
+    auto msb = hwlib::spi_bus_bit_banged_sclk_mosi_miso_static<sclkType, mosiType, slavePin, 0, spi_bit_order::msb_first>(sclk, mosi, miso);
+    report("spi_bus_bit_banged_sclk_mosi_miso_static, no wait, msb first", msb, false);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief     Host benchmark of the bus overhead per command of the spi protocol
+ *
+ * This file runs the pn532 driver over communication::spi. The software pn532 emulator is a slave of an emulated
+ * spi bus (pn532EmulatorSpi), which counts every call on the bus and on the sel pin, so the overhead of a
+ * command can be compared between:
+ *      - the old spi protocol, which builds a new spi transaction (and writes sel) for the 0x01 / 0x03 prefix,
+ *        for every segment and for every continued read, and starts one more to raise sel
+ *      - communication::spi, which sends the prefix and all segments in one transaction, continues a read without
+ *        writing sel and only raises sel at the end
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532EmulatorSpi.h"
+
+namespace {
+
+const int rounds = 20;
+
+/// \brief
+/// The spi protocol as it was: a new transaction for the prefix, for every segment and for every continued read
+class legacySpi : public communication::spi
+{
+public:
+    using communication::spi::spi;
+
+    void sendData(const uint8_t *commandBuffer, size_t nBytes) override {
+        bus.transaction(sel).write(1);
+        bus.transaction(sel).write(nBytes, commandBuffer);
+    }
+
+    void sendData(const communication::segment *segments, size_t count) override {
+        bus.transaction(sel).write(1);
+        for(size_t i = 0; i < count; i++){
+            bus.transaction(sel).write(segments[i].length, segments[i].data);
+        }
+    }
+
+    void receiveData(uint8_t *receiveBuffer, size_t nBytes) override {
+        bus.transaction(sel).write(3);
+        bus.transaction(sel).read(nBytes, receiveBuffer);
+    }
+
+    void receiveMore(uint8_t *receiveBuffer, size_t nBytes) override {
+        bus.transaction(sel).read(nBytes, receiveBuffer);
+    }
+
+    void endTransaction() override {
+        bus.transaction(sel).endTransaction();
+    }
+};
+
+void benchmark(const char* name, communication::spi& protocol, communication::pn532Emulator& emulator, communication::pn532EmulatorSpi& bus)
+{
+    namespace cmd = nfc::pn532::command;
+
+    auto chip = nfc::PN532_chip(protocol, emulator.irq);
+    nfc::NFC *nfc = &chip;
+    auto cardinfo = mifare1k();
+
+    bus.resetStatistics();
+
+    int commands = 0;
+    int failed = 0;
+    for(int i = 0; i < rounds; i++){
+        failed += nfc->getFirmwareVersion()[1] != 0x32;
+        failed += !nfc->detectCard(cardinfo, 1, cmd::TypeA_ISO_IEC14443);
+        failed += nfc->mifareAuthenticate(cardinfo, 1, nfc::authenticateKeyA, 4, nfc::pn532::general::DefaultKey) != nfc::pn532StatusOK;
+        failed += nfc->mifareReadPage(cardinfo, 1, 4) != nfc::pn532StatusOK;
+        commands += 4;
+    }
+
+    hwlib::cout
+        << name << hwlib::endl
+        << "    sel writes per command:       " << hwlib::dec << static_cast<int>(bus.stats.selWrites / commands) << hwlib::endl
+        << "    transactions per command:     " << static_cast<int>(bus.stats.transactions / commands) << hwlib::endl
+        << "    bus calls per command:        " << static_cast<int>(bus.stats.calls / commands) << hwlib::endl
+        << "    bus bytes per command:        " << static_cast<int>(bus.stats.bytes / commands) << hwlib::endl
+        << "    failed commands:              " << failed << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+
+    // only the overhead of the driver and the bus is measured
+    emulator.ackDelay = 0;
+    emulator.responseDelay = 0;
+    emulator.rfDelay = 0;
+
+    communication::pn532EmulatorSpi bus;
+    auto &sel = bus.attach(emulator);
+
+    auto legacy = legacySpi(bus, sel, emulator.irq);
+    benchmark("one transaction per prefix and segment", legacy, emulator, bus);
+
+    auto single = communication::spi(bus, sel, emulator.irq);
+    benchmark("one transaction per transfer", single, emulator, bus);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @brief     Host example of recording the bus traffic of a gate and replaying it
+ *
+ * This file records a session of slow taps against the software pn532 emulator with a traceRecorder: every card
+ * enters the field 30 ms after the previous tap. A tap is InListPassiveTarget, authenticate block 4 and read block 4.
+ * The trace is then played back to a new PN532_chip with a traceReplay:
+ *
+ *      - at full speed, many times: the time per command is the cpu time of the driver alone, without RF time
+ *      - at the original timing, once: the session takes as long as when it was recorded
+ *
+ * Both replays must read exactly the same UIDs and blocks as the recording, without mismatches.
+ * When a file name is given as argument, the trace is written to that file.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+#include "../../code/headers/protocolTrace.h"
+
+#include <cstdio>
+
+namespace {
+
+namespace frames = nfc::pn532::frames;
+
+const int       taps            = 10;
+const int       replays         = 1000;
+const uint8_t   block           = 4;
+const uint8_t   commandsPerTap  = 3;
+
+/// \brief
+/// The UID and the block that have been read by all taps of a session
+struct session{
+    uint8_t data[taps][20] = {};
+
+    bool operator==(const session& other) const {
+        for(int i = 0; i < taps; i++){
+            for(int j = 0; j < 20; j++){
+                if(data[i][j] != other.data[i][j]){ return false; }
+            }
+        }
+        return true;
+    }
+};
+
+/// \brief
+/// Does one tap and stores the UID and the block in out
+bool tap(nfc::NFC& nfc, uint8_t (&out)[20])
+{
+    auto list = nfc.sendCommandAndCheckAck(frames::InListPassiveTarget);
+    const auto *frame = list.response.finalBuffer;
+    if(list.status != nfc::pn532StatusOK || frame[4] == 0){ return false; }
+
+    auto authenticate = frames::mifareAuthenticate;
+    auto read = frames::mifareRead;
+    authenticate.set(3, block);
+    read.set(3, block);
+    for(uint8_t i = 0; i < 4; i++){
+        out[i] = frame[10 + i];
+        authenticate.set(10 + i, frame[10 + i]);
+    }
+
+    if(nfc.sendCommandAndCheckAck(authenticate).response.finalBuffer[4] != 0x00){ return false; }
+    auto data = nfc.sendCommandAndCheckAck(read);
+    for(uint8_t i = 0; i < 16; i++){ out[4 + i] = data.response.finalBuffer[5 + i]; }
+    return data.status == nfc::pn532StatusOK && data.response.finalBuffer[4] == 0x00;
+}
+
+/// \brief
+/// Does all taps of a session on a new chip, returns the amount of failed taps
+int run(communication::protocol& bus, hwlib::pin_in& irq, session& result, communication::pn532Emulator* emulator = nullptr)
+{
+    auto chip = nfc::PN532_chip(bus, irq);
+    int failed = 0;
+    for(int i = 0; i < taps; i++){
+        if(emulator != nullptr){ emulator->presentCardAfter(30'000); }
+        failed += !tap(chip, result.data[i]);
+    }
+    return failed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    static uint8_t trace[16 * 1024];
+
+    // recording
+    auto emulator = communication::pn532Emulator();
+    auto recorder = communication::traceRecorder(emulator, trace, sizeof(trace));
+    auto recorded = session();
+    auto start = hwlib::now_us();
+    const int failed = run(recorder, emulator.irq, recorded, &emulator);
+    const auto recordTime = hwlib::now_us() - start;
+
+    hwlib::cout
+        << "recording" << hwlib::endl
+        << "    session:                " << hwlib::dec << static_cast<int>(recordTime / 1000) << " ms, " << failed << " failed taps" << hwlib::endl
+        << "    trace:                  " << static_cast<int>(recorder.size()) << " bytes"
+        << (recorder.overflowed() ? ", overflowed" : "") << hwlib::endl
+        << hwlib::endl;
+
+    if(argc > 1){
+        auto file = std::fopen(argv[1], "wb");
+        if(file != nullptr){
+            std::fwrite(trace, 1, recorder.size(), file);
+            std::fclose(file);
+        }
+    }
+
+    // full speed
+    auto fast = communication::traceReplay(trace, recorder.size());
+    auto replayed = session();
+    bool identical = true;
+    int mismatches = 0;
+    start = hwlib::now_us();
+    for(int i = 0; i < replays; i++){
+        fast.rewind();
+        run(fast, fast.irq, replayed);
+        identical &= replayed == recorded && fast.finished();
+        mismatches += fast.stats.mismatches;
+    }
+    const auto fastTime = hwlib::now_us() - start;
+
+    hwlib::cout
+        << "replay at full speed (" << replays << " times)" << hwlib::endl
+        << "    time per tap:           " << static_cast<int>(fastTime * 1000 / (replays * taps)) << " ns" << hwlib::endl
+        << "    time per command:       " << static_cast<int>(fastTime * 1000 / (replays * taps * commandsPerTap)) << " ns" << hwlib::endl
+        << "    events per session:     " << static_cast<int>(fast.stats.events) << hwlib::endl
+        << "    mismatches:             " << mismatches << hwlib::endl
+        << "    same data as recorded:  " << (identical ? "yes" : "no") << hwlib::endl
+        << hwlib::endl;
+
+    // original timing
+    auto timed = communication::traceReplay(trace, recorder.size(), true);
+    replayed = session();
+    start = hwlib::now_us();
+    run(timed, timed.irq, replayed);
+    const auto timedTime = hwlib::now_us() - start;
+
+    hwlib::cout
+        << "replay at the original timing" << hwlib::endl
+        << "    session:                " << static_cast<int>(timedTime / 1000) << " ms" << hwlib::endl
+        << "    mismatches:             " << static_cast<int>(timed.stats.mismatches) << hwlib::endl
+        << "    same data as recorded:  " << ((replayed == recorded && timed.finished()) ? "yes" : "no") << hwlib::endl;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file
+ * @brief     Host benchmark of the detection of two cards that are in the rf field at the same time
+ *
+ * Two travellers hold their card against the gate at the same time.
+ *
+ *      - detectCard:   only one card is found, the tap of the second traveller is lost
+ *      - detectCards:  both cards are found with one InListPassiveTarget, and a block of both is read
+ *                      by using the target number of the card as cardNumber
+ *
+ * After that deselectCard and releaseCard are shown.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+void printUID(const card& cardinfo)
+{
+    const auto uid = cardinfo.getUID();
+    for(uint8_t i = 0; i < cardinfo.getUIDsize(); i++){ hwlib::cout << hwlib::hex << static_cast<int>(uid[i]) << " "; }
+}
+
+} // namespace
+
+int main() {
+    namespace cmd = nfc::pn532::command;
+    namespace general = nfc::pn532::general;
+
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    emulator.cards[1].present = true;
+    nfc->getFirmwareVersion();
+
+    // one card at a time
+    hwlib::cout << "detectCard" << hwlib::endl;
+    emulator.resetStatistics();
+    auto start = hwlib::now_us();
+    auto single = mifare1k();
+    const bool found = nfc->detectCard(single, 1, cmd::TypeA_ISO_IEC14443);
+    auto elapsed = hwlib::now_us() - start;
+    hwlib::cout << "    found:      " << found << hwlib::endl
+                << "    commands:   " << hwlib::dec << static_cast<int>(emulator.stats.commands) << hwlib::endl
+                << "    time:       " << static_cast<int>(elapsed) << " us" << hwlib::endl << hwlib::endl;
+
+    // both cards at once
+    hwlib::cout << "detectCards" << hwlib::endl;
+    emulator.resetStatistics();
+    start = hwlib::now_us();
+    mifare1k cards[2];
+    const auto count = nfc->detectCards(cards, 2, cmd::TypeA_ISO_IEC14443);
+    for(uint8_t i = 0; i < count; i++){
+        const auto tg = cards[i].getTargetNumber();
+        const auto status = nfc->mifareAuthenticate(cards[i], tg, nfc::authenticateKeyA, 1, general::DefaultKey);
+        if(status == nfc::pn532StatusOK){ nfc->mifareReadPage(cards[i], tg, 1); }
+    }
+    elapsed = hwlib::now_us() - start;
+    for(uint8_t i = 0; i < count; i++){
+        hwlib::cout << "    target " << hwlib::dec << static_cast<int>(cards[i].getTargetNumber()) << ":   ";
+        printUID(cards[i]);
+        hwlib::cout << hwlib::endl;
+    }
+    hwlib::cout << "    found:      " << hwlib::dec << static_cast<int>(count) << hwlib::endl
+                << "    commands:   " << static_cast<int>(emulator.stats.commands) << hwlib::endl
+                << "    time:       " << static_cast<int>(elapsed) << " us" << hwlib::endl << hwlib::endl;
+
+    // select, deselect and release
+    hwlib::cout << "select, deselect and release" << hwlib::endl;
+    hwlib::cout << "    select 2:          " << hwlib::hex << static_cast<int>(nfc->selectCard(2)) << hwlib::endl
+                << "    deselect all:      " << static_cast<int>(nfc->deselectCard(0)) << hwlib::endl
+                << "    select 1:          " << static_cast<int>(nfc->selectCard(1)) << hwlib::endl
+                << "    release 2:         " << static_cast<int>(nfc->releaseCard(2)) << hwlib::endl
+                << "    read released 2:   " << static_cast<int>(nfc->mifareReadPage(cards[1], 2, 1)) << hwlib::endl
+                << "    select released 2: " << static_cast<int>(nfc->selectCard(2)) << hwlib::endl;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief     Host benchmark of the HSU (uart) path of the pn532 driver over a pseudo-terminal
+ *
+ * This file runs the pn532 driver over hwuart::PosixUart. The other side of the pseudo-terminal is the
+ * software pn532 emulator in HSU mode (pn532EmulatorPty).
+ *
+ * A card is detected and a page is read, over and over again, with two ready strategies:
+ *      - spinning on rxReady() (statusReady without poll interval, the old behaviour of the uart)
+ *      - sleeping in poll() until the first byte of the frame arrives (uartReady)
+ *
+ * For both the time per command and the cpu time the driver uses per command are printed.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532EmulatorPty.h"
+#include "../../code/headers/posix_uart.h"
+
+#include <time.h>
+
+namespace {
+
+const int rounds = 20;
+
+uint_fast64_t cpuTimeUs()
+{
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<uint_fast64_t>(time.tv_sec) * 1'000'000 + time.tv_nsec / 1'000;
+}
+
+void benchmark(const char* name, communication::protocol& bus, communication::readyStrategy& ready)
+{
+    namespace cmd = nfc::pn532::command;
+
+    // over HSU the irq pin is not connected
+    auto chip = nfc::PN532_chip(bus, hwlib::pin_in_dummy, ready);
+    nfc::NFC *nfc = &chip;
+    auto cardinfo = mifare1k();
+
+    int commands = 0;
+    int failed = 0;
+    const auto cpuStart = cpuTimeUs();
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        failed += nfc->getFirmwareVersion()[1] != 0x32;
+        failed += !nfc->detectCard(cardinfo, 1, cmd::TypeA_ISO_IEC14443);
+        failed += nfc->mifareAuthenticate(cardinfo, 1, nfc::authenticateKeyA, 4, nfc::pn532::general::DefaultKey) != nfc::pn532StatusOK;
+        failed += nfc->mifareReadPage(cardinfo, 1, 4) != nfc::pn532StatusOK;
+        commands += 4;
+    }
+    const auto elapsed = hwlib::now_us() - start;
+    const auto cpu = cpuTimeUs() - cpuStart;
+
+    hwlib::cout
+        << name << hwlib::endl
+        << "    time per command:   " << hwlib::dec << static_cast<int>(elapsed / commands) << " us" << hwlib::endl
+        << "    cpu per command:    " << static_cast<int>(cpu / commands) << " us" << hwlib::endl
+        << "    failed commands:    " << failed << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto pty = communication::pn532EmulatorPty(emulator);
+    pty.start();
+
+    auto serial = hwuart::PosixUart(pty.slaveName(), 115200);
+    if(!serial.isOpen()){ return 1; }
+    auto bus = communication::uart(serial);
+
+    auto spinning = communication::statusReady(bus, 0);
+    auto sleeping = communication::uartReady(serial);
+
+    benchmark("spinning on rxReady()", bus, spinning);
+    benchmark("sleeping in poll()", bus, sleeping);
+
+    pty.stop();
+    hwlib::cout << "emulator: " << hwlib::dec << static_cast<int>(emulator.stats.commands) << " commands, "
+                << static_cast<int>(emulator.stats.wakeUps) << " wake ups" << hwlib::endl;
+}
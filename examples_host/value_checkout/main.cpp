@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief     Host benchmark of the Mifare authentication session cache and the value transaction
+ *
+ * A check out of the train application is done over and over again: the card is selected, the price is
+ * decremented from the value block, the value is transferred and the new balance is read back.
+ *
+ *      - without cache:    the session of the card is cleared before every call (the behaviour before the cache)
+ *      - with cache:       the sector is authenticated once per check out
+ *      - transaction:      the check out is done with one mifareValueTransaction()
+ *
+ * After that it is shown that the session is ended by a new selection of the card and by the authentication of another sector,
+ * that the value block keeps its value when the transfer of a transaction does not reach the card, and that a transfer
+ * of which only the answer is lost is seen as done.
+ *
+ * @author    Nathan Houwaart
+ * @license   See LICENSE
+ */
+
+#include "../../code/headers/pn532.h"
+#include "../../code/headers/pn532Emulator.h"
+
+namespace {
+
+const int rounds = 20;
+const uint8_t valueBlock = 0x05;
+const uint8_t trailerBlock = 0x07;
+const uint8_t* key = nfc::pn532::general::DefaultKey;
+
+void checkOut(nfc::NFC& nfc, card& cardInfo, bool clearSession)
+{
+    nfc.sendCommandAndCheckAck(nfc::pn532::frames::InListPassiveTarget);
+    if(clearSession){ cardInfo.clearSession(); }
+    nfc.mifareDecrement(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, 1);
+    if(clearSession){ cardInfo.clearSession(); }
+    nfc.mifareTransfer(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key);
+    if(clearSession){ cardInfo.clearSession(); }
+    nfc.mifareAuthenticate(cardInfo, 1, nfc::authenticateKeyA, trailerBlock, key);
+    nfc.mifareReadPage(cardInfo, 1, valueBlock);
+}
+
+void checkOutTransaction(nfc::NFC& nfc, card& cardInfo, bool)
+{
+    nfc.sendCommandAndCheckAck(nfc::pn532::frames::InListPassiveTarget);
+    uint32_t balance = 0;
+    nfc.mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 1, balance);
+}
+
+void benchmark(const char* name, communication::pn532Emulator& emulator, nfc::NFC& nfc, card& cardInfo, bool clearSession,
+               void (*function)(nfc::NFC&, card&, bool) = checkOut)
+{
+    emulator.resetStatistics();
+    const auto start = hwlib::now_us();
+    for(int i = 0; i < rounds; i++){
+        function(nfc, cardInfo, clearSession);
+    }
+    const auto elapsed = hwlib::now_us() - start;
+
+    hwlib::cout
+        << name << hwlib::endl
+        << "    time per check out:             " << hwlib::dec << static_cast<int>(elapsed / rounds) << " us" << hwlib::endl
+        << "    authentications per check out:  " << static_cast<int>(emulator.stats.authentications / rounds) << hwlib::endl
+        << "    commands per check out:         " << static_cast<int>(emulator.stats.commands / rounds) << hwlib::endl
+        << hwlib::endl;
+}
+
+} // namespace
+
+int main() {
+    auto emulator = communication::pn532Emulator();
+    auto chip = nfc::PN532_chip(emulator, emulator.irq);
+    nfc::NFC *nfc = &chip;
+
+    auto cardInfo = mifare1k();
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    nfc->mifareMakeValueBlock(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key);
+    hwlib::cout << hwlib::endl;
+
+    benchmark("without cache", emulator, *nfc, cardInfo, true);
+    benchmark("with cache", emulator, *nfc, cardInfo, false);
+    benchmark("transaction", emulator, *nfc, cardInfo, false, checkOutTransaction);
+
+    hwlib::cout << "session end" << hwlib::endl;
+    emulator.resetStatistics();
+    nfc->detectCard(cardInfo, 1, nfc::pn532::command::TypeA_ISO_IEC14443);
+    nfc->mifareTransfer(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key);
+    hwlib::cout << "    after a new selection:  " << static_cast<int>(emulator.stats.authentications) << " authentication" << hwlib::endl;
+
+    emulator.resetStatistics();
+    nfc->mifareAuthenticate(cardInfo, 1, nfc::authenticateKeyA, 15, key);
+    nfc->mifareTransfer(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key);
+    hwlib::cout << "    after another sector:   " << static_cast<int>(emulator.stats.authentications) << " authentications" << hwlib::endl;
+
+    hwlib::cout << hwlib::endl << "failing transfer" << hwlib::endl;
+    uint32_t before = 0, restored = 0, after = 0;
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 0, before);
+    emulator.failTransfer = true;
+    const auto status = nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 5, restored);
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 0, after);
+    hwlib::cout << "    status:                 " << hwlib::hex << static_cast<int>(status)
+                << ((status == nfc::statusCode::pn532StatusValueRestored) ? " (restored)" : "") << hwlib::endl
+                << "    balance before:         " << hwlib::dec << static_cast<int>(before) << hwlib::endl
+                << "    balance restored:       " << static_cast<int>(restored) << hwlib::endl
+                << "    balance after:          " << static_cast<int>(after) << hwlib::endl;
+
+    hwlib::cout << hwlib::endl << "lost answer of the transfer" << hwlib::endl;
+    uint32_t charged = 0;
+    emulator.loseTransferAnswer = true;
+    const auto lost = nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 5, charged);
+    nfc->mifareValueTransaction(cardInfo, 1, nfc::authenticateKeyA, valueBlock, trailerBlock, key, nfc::Decrementation, 0, after);
+    hwlib::cout << "    status:                 " << hwlib::hex << static_cast<int>(lost) << hwlib::endl
+                << "    balance charged:        " << hwlib::dec << static_cast<int>(charged) << hwlib::endl
+                << "    balance after:          " << static_cast<int>(after) << hwlib::endl;
+}
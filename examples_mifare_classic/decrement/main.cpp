@@ -99,7 +99,7 @@ int main() {
 
     for(;;){
 	hwlib::cout << "Present card" << hwlib::endl;
-        auto cardinfo = card();
+        auto cardinfo = mifare1k();
         while(!nfc->detectCard(cardinfo, 0x01, cardType)){}
 
         
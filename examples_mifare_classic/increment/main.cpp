@@ -96,7 +96,7 @@ int main() {
 
     for(;;){
         hwlib::cout << "Present card" << hwlib::endl;
-        auto cardinfo = card();
+        auto cardinfo = mifare1k();
         while(!nfc->detectCard(cardinfo, cardnumber, cardType)){}
 
         nfc->mifareAuthenticate(cardinfo, cardnumber, athenticateAorB, sector, sectorKey);
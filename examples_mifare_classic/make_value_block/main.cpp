@@ -106,7 +106,7 @@ int main() {
 
     for(;;){
         hwlib::cout << "Present card" << hwlib::endl;
-        auto cardinfo = card();
+        auto cardinfo = mifare1k();
         while(!nfc->detectCard(cardinfo, cardnumber, cardType)){}
 
         auto result = nfc->mifareMakeValueBlock(cardinfo, cardnumber, athenticateAorB, valueBlockPage, sector, sectorKey);
@@ -19,20 +19,21 @@
  * setMaxRetries(0xFF) command is used.
  * 
  * After a card has entered the pn532's rf field, the pn532 will try to read the full content of the card. It is doing so by authenticating
- * every sector trailer block with the key specified in the struct cardKeys in declerations.h
+ * every sector trailer block once with the key specified in the struct cardKeys in declerations.h
  * 
  * Possible error causes:
  *      - The key is wrong for that specific vector
  *      - The access rights of the cards are set so that you can only autenticate with key A or B
  *      - The pn532 gave a timeout error
  *      - The pn532 has received a NACK (Not ACKnowleged) frame
- *      - If one sector throws an authentication error, the rest of the card cannot be read. It needs to be reinitialised by the reader
+ *      - If one sector throws an authentication error, the card halts. The reader selects it again and goes on with the next sector
  *      - The card is removed from the pn532's rf field before completing the entire read
  * 
  * The error cause can be deducted by comapring the given error code with the errors declared in: declarations.h
  * 
- * After a full read ( succesfull, partial or not succesfull ), the complete Cardbuffer will be printed out in the terminal with the data
- * that the pn532 has extracted form the card. Sectors that have not been read properly, will contain all 0's (0x00)
+ * After a full read ( succesfull, partial or not succesfull ), the status of every sector and the complete Cardbuffer will be printed
+ * out in the terminal with the data that the pn532 has extracted form the card. Sectors that have not been read properly, will contain
+ * all 0's (0x00)
  * 
  * @author    Nathan Houwaart
  * @license   See LICENSE
@@ -95,13 +96,25 @@ int main() {
     for(;;){
         hwlib::cout << "Present card" << hwlib::endl;
         // construct an empty card class with a reset ( all 0x00's) buffer
-        auto cardinfo = card();
+        auto cardinfo = mifare1k();
 
         // Wait for a nfc card to be detected by the pn532
         while(!nfc->detectCard(cardinfo, cardnumber, cardType)){}
 
-        // If a card has been detected, try to read the entire card
-        nfc->mifareReadCard(cardinfo, cardnumber, nfc::mifareCommands::authenticateKeyA, card1Keys);
+        // If a card has been detected, try to read the entire card. Sectors that can't be authenticated
+        // with key A are tried with key B
+        nfc::readOptions options;
+        options.onAuthFailure = nfc::authFailurePolicy::switchKey;
+        nfc::sectorStatus status;
+        nfc->mifareReadSectors(cardinfo, cardnumber, card1Keys, options, status);
+
+        for(int sector = 0; sector < 16; sector++){
+            hwlib::cout << hwlib::endl << "sector " << hwlib::dec << sector << ": status " << hwlib::hex << static_cast<int>(status[sector]) << hwlib::endl;
+            for(int page = sector * 4; page < sector * 4 + 4; page++){
+                cardinfo.readPage(page);
+            }
+        }
+        hwlib::cout << "reading complete" << hwlib::endl << hwlib::endl;
 
         hwlib::wait_ms(5000);
     }
@@ -101,7 +101,7 @@ int main() {
 
     for(;;){
         hwlib::cout << "Present card" << hwlib::endl;
-        auto cardinfo = card();
+        auto cardinfo = mifare1k();
         while(!nfc->detectCard(cardinfo, cardnumber, cardType)){}
 
         auto authenticate = nfc->mifareAuthenticate(cardinfo, cardnumber, athenticateAorB, sector, sectorKey);